@@ -9,8 +9,12 @@ import time
 import os
 import sys
 import json
+import math
+import statistics
 import platform
 import re
+import threading
+from concurrent.futures import ThreadPoolExecutor, FIRST_COMPLETED, wait
 from pathlib import Path
 from typing import Dict, List, Optional, Tuple
 
@@ -40,10 +44,245 @@ except ImportError:
     PSUTIL_AVAILABLE = False
 
 
+def _incomplete_beta(a: float, b: float, x: float) -> float:
+    """Regularized incomplete beta I_x(a, b), by continued fraction (Lentz)"""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    if x > (a + 1.0) / (a + b + 2.0):
+        return 1.0 - _incomplete_beta(b, a, 1.0 - x)
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+                     + a * math.log(x) + b * math.log(1.0 - x)) / a
+    tiny = 1e-300
+    c, d = 1.0, 1.0 - (a + b) * x / (a + 1.0)
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    result = d
+    for m in range(1, 300):
+        for numerator in (m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m)),
+                          -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))):
+            d = 1.0 + numerator * d
+            d = 1.0 / (d if abs(d) > tiny else tiny)
+            c = 1.0 + numerator / c
+            c = c if abs(c) > tiny else tiny
+            result *= c * d
+        if abs(c * d - 1.0) < 1e-12:
+            break
+    return front * result
+
+
+def welch_slowdown_p(baseline: Tuple[float, float, int], current: Tuple[float, float, int]) -> float:
+    """One-sided Welch t-test p-value that `current` is slower than `baseline`.
+    
+    Each side is (mean rate, standard deviation, trials).
+    """
+    (mean_b, sd_b, n_b), (mean_c, sd_c, n_c) = baseline, current
+    var_b = sd_b * sd_b / n_b
+    var_c = sd_c * sd_c / n_c
+    if var_b + var_c == 0.0:
+        return 0.0 if mean_c < mean_b else 1.0
+    t = (mean_b - mean_c) / math.sqrt(var_b + var_c)
+    # Welch–Satterthwaite degrees of freedom
+    denominator = ((var_b * var_b / (n_b - 1) if n_b > 1 else 0.0)
+                   + (var_c * var_c / (n_c - 1) if n_c > 1 else 0.0))
+    df = (var_b + var_c) ** 2 / denominator if denominator > 0 else 1e6
+    df = max(1.0, min(df, 1e6))
+    tail = 0.5 * _incomplete_beta(df / 2, 0.5, df / (df + t * t))
+    return tail if t > 0 else 1.0 - tail
+
+
+class ResultStore:
+    """Append-only JSONL history of results, one line per kernel and run.
+    
+    Lines are keyed by host, CPU model, benchmark, kernel, ISA and thread
+    count, and also carry the kernel release, microcode and BIOS versions so
+    a regression can be matched to what changed on the node.
+    """
+    
+    KEY_FIELDS = ("host", "cpu_model", "benchmark", "kernel", "isa", "threads")
+    
+    # Baseline = the last few stored runs of the same key
+    BASELINE_RUNS = 5
+    
+    # One-sided significance level of the slowdown test
+    ALPHA = 0.01
+    
+    def __init__(self, path: Optional[str] = None):
+        self.path = Path(path) if path else self.default_path()
+    
+    @staticmethod
+    def default_path() -> Path:
+        """Same directory as the GPU tuning cache: $SISU_CACHE_DIR, else
+        $XDG_CACHE_HOME/sisu-flops, else ~/.cache/sisu-flops"""
+        if os.environ.get("SISU_CACHE_DIR"):
+            base = Path(os.environ["SISU_CACHE_DIR"])
+        elif os.environ.get("XDG_CACHE_HOME"):
+            base = Path(os.environ["XDG_CACHE_HOME"]) / "sisu-flops"
+        else:
+            base = Path.home() / ".cache" / "sisu-flops"
+        return base / "results.jsonl"
+    
+    @staticmethod
+    def environment(cpu_model: str) -> Dict:
+        """Identity of this node plus the versions an update would change"""
+        env = {
+            "host": platform.node(),
+            "cpu_model": cpu_model,
+            "kernel_release": platform.release(),
+            "microcode": None,
+            "bios": None
+        }
+        try:
+            with open('/proc/cpuinfo', 'r') as f:
+                for line in f:
+                    if line.startswith('microcode'):
+                        env["microcode"] = line.split(':')[1].strip()
+                        break
+        except OSError:
+            pass
+        try:
+            env["bios"] = Path('/sys/class/dmi/id/bios_version').read_text().strip()
+        except OSError:
+            pass
+        return env
+    
+    @staticmethod
+    def entries(results_data: List[Dict], env: Dict, threads: int) -> List[Dict]:
+        """One store line per record, or per headline for scraped benchmarks"""
+        stamp = time.strftime("%Y-%m-%dT%H:%M:%S%z")
+        lines = []
+        for result in results_data:
+            if result.get("system"):
+                continue
+            rows = []
+            for record in result["records"]:
+                if record["mflops"] <= 0:
+                    continue
+                rows.append({
+                    "kernel": record["kernel"],
+                    "isa": record["isa"],
+                    "threads": record["threads"],
+                    "unit": "mflops",
+                    "value": record["mflops"],
+                    "cv": record["stats"]["cv"],
+                    "trials": record["trials"]
+                })
+            if not result["records"]:
+                stats = result["stats"]
+                rows.append({
+                    "kernel": "headline",
+                    "isa": "-",
+                    "threads": threads,
+                    "unit": "gbps" if result["gbps"] else "mflops",
+                    "value": result["gbps"] or result["mflops"],
+                    "cv": stats["cv_percent"] / 100 if stats else None,
+                    "trials": stats["trials"] if stats else None
+                })
+            for row in rows:
+                line = {"timestamp": stamp, "benchmark": result["name"]}
+                line.update(env)
+                line.update(row)
+                lines.append(line)
+        return lines
+    
+    def load(self) -> List[Dict]:
+        if not self.path.exists():
+            return []
+        lines = []
+        with open(self.path, "r") as f:
+            for text in f:
+                try:
+                    lines.append(json.loads(text))
+                except ValueError:
+                    continue  # a torn line from an interrupted write
+        return lines
+    
+    def append(self, lines: List[Dict]):
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        with open(self.path, "a") as f:
+            for line in lines:
+                f.write(json.dumps(line, sort_keys=True) + "\n")
+    
+    @classmethod
+    def key(cls, line: Dict) -> Tuple:
+        return tuple(line.get(field) for field in cls.KEY_FIELDS) + (line.get("unit"),)
+    
+    def compare(self, current: List[Dict], threshold: float) -> List[Dict]:
+        """Each current line against its baseline.
+        
+        A line regresses when it is at least `threshold` (a fraction) slower
+        than the baseline and the Welch test rejects equal rates at ALPHA.
+        Each of the last BASELINE_RUNS stored runs is one sample of the
+        baseline, so its spread is the run-to-run spread. A single stored
+        run falls back to its own trial statistics. Lines without trial
+        statistics (scraped headlines) are judged on the threshold alone.
+        """
+        history = {}
+        for line in self.load():
+            history.setdefault(self.key(line), []).append(line)
+        
+        verdicts = []
+        for line in current:
+            runs = history.get(self.key(line), [])[-self.BASELINE_RUNS:]
+            verdict = {"line": line, "baseline": None, "change": None, "p": None, "status": "new"}
+            verdicts.append(verdict)
+            if not runs:
+                continue
+            
+            values = [run["value"] for run in runs]
+            baseline_value = sorted(values)[len(values) // 2]
+            change = line["value"] / baseline_value - 1.0 if baseline_value > 0 else 0.0
+            verdict.update(baseline=baseline_value, change=change, previous=runs[-1])
+            
+            p = None
+            if len(runs) > 1:
+                baseline = (sum(values) / len(values), statistics.stdev(values), len(values))
+            elif runs[0].get("cv") is not None:
+                baseline = (runs[0]["value"], runs[0]["value"] * runs[0]["cv"], runs[0].get("trials") or 1)
+            else:
+                baseline = None
+            if line["cv"] is not None and baseline is not None:
+                p = welch_slowdown_p(baseline, (line["value"], line["value"] * line["cv"], line["trials"] or 1))
+                # Reported for the direction of the change
+                p = p if change <= 0 else 1.0 - p
+            verdict["p"] = p
+            
+            significant = p is None or p < self.ALPHA
+            if change <= -threshold and significant:
+                verdict["status"] = "regressed"
+            elif change >= threshold and significant:
+                verdict["status"] = "faster"
+            else:
+                verdict["status"] = "ok"
+        return verdicts
+
+
 class BenchmarkRunner:
-    def __init__(self):
+    # Binaries that emit structured records with --json; the rest are scraped
+    STRUCTURED_BENCHMARKS = {"basic", "vectorized", "memory", "dgemm", "spmv", "gpu"}
+    
+    # What each benchmark occupies while it runs: CPU cores ("all" = every
+    # core) and GPUs. The GPU benchmark needs one host core to feed the queue
+    # and read profiling events; its kernel times come from the device timer.
+    RESOURCE_CLAIMS = {
+        "basic": {"cores": 1, "gpu": 0},
+        "vectorized": {"cores": "all", "gpu": 0},
+        "memory": {"cores": "all", "gpu": 0},
+        "dgemm": {"cores": "all", "gpu": 0},
+        "spmv": {"cores": "all", "gpu": 0},
+        "gpu": {"cores": 1, "gpu": 1},
+    }
+    
+    # Started together in --schedule corun as a whole-system load test
+    CORUN_GROUP = ("vectorized", "gpu")
+    
+    SCHEDULES = ("serial", "parallel", "corun")
+    
+    def __init__(self, target_time: Optional[float] = None, schedule: str = "parallel"):
         self.console = Console() if RICH_AVAILABLE else None
         self.results = {}
+        self.target_time = target_time  # seconds per trial, passed as --time
+        self.schedule = schedule
         self.capabilities = self._detect_capabilities()
         
     def _detect_capabilities(self) -> Dict:
@@ -102,6 +341,9 @@ class BenchmarkRunner:
         benchmark_files = [
             ("basic", "basic_benchmark"),
             ("vectorized", "vectorized_benchmark"), 
+            ("memory", "memory_benchmark"),
+            ("dgemm", "dgemm_benchmark"),
+            ("spmv", "spmv_benchmark"),
             ("gpu", "gpu_benchmark")
         ]
         
@@ -156,8 +398,20 @@ class BenchmarkRunner:
     def _run_benchmark(self, benchmark_name: str, executable_path: str) -> Optional[Dict]:
         """Run a benchmark and parse its output"""
         try:
+            command = [executable_path]
+            timeout = 120
+            # The latency ladder builds and chases buffers of up to several GiB
+            if benchmark_name == "memory":
+                timeout = 600
+            if benchmark_name in self.STRUCTURED_BENCHMARKS:
+                command.append("--json")
+                if self.target_time:
+                    command += ["--time", str(self.target_time)]
+                    # Up to 10 trials of each of the (at most 7) tests, plus calibration
+                    timeout = max(timeout, 120 + self.target_time * 100)
+            
             start_time = time.time()
-            result = subprocess.run([executable_path], capture_output=True, text=True, timeout=120)
+            result = subprocess.run(command, capture_output=True, text=True, timeout=timeout)
             end_time = time.time()
             
             if result.returncode != 0:
@@ -167,20 +421,56 @@ class BenchmarkRunner:
                     "duration": end_time - start_time
                 }
             
+            if benchmark_name in self.STRUCTURED_BENCHMARKS:
+                parsed = self._parse_records(result.stdout, result.stderr, end_time - start_time)
+                if parsed:
+                    return parsed
+            
             # Parse output for MFLOPS values
             mflops_values = []
             gflops_values = []
+            bandwidth_gbps, latency_ns = self._scrape_memory_summary(result.stdout)
+            dgemm_gflops = None
+            trial_stats = []  # (mflops, stats) for each test that reports trial statistics
+            pending_stats = None
             
             for line in result.stdout.split('\n'):
+                # Trial statistics precede the MFLOPS line of the same test
+                stats_match = re.search(
+                    r'Time stats:\s*n=(\d+)\s+min=([\d.]+)\s+median=([\d.]+)\s+mean=([\d.]+)'
+                    r'\s+stddev=([\d.]+)\s+p95=([\d.]+)\s+cv=([\d.]+)%', line)
+                if stats_match:
+                    pending_stats = {
+                        "trials": int(stats_match.group(1)),
+                        "min": float(stats_match.group(2)),
+                        "median": float(stats_match.group(3)),
+                        "mean": float(stats_match.group(4)),
+                        "stddev": float(stats_match.group(5)),
+                        "p95": float(stats_match.group(6)),
+                        "cv_percent": float(stats_match.group(7))
+                    }
+                
                 # Look for MFLOPS values
                 mflops_match = re.search(r'MFLOPS:\s*([\d.]+)', line)
                 if mflops_match:
                     mflops_values.append(float(mflops_match.group(1)))
+                    if pending_stats:
+                        trial_stats.append((mflops_values[-1], pending_stats))
+                        pending_stats = None
                 
                 # Look for GFLOPS values  
                 gflops_match = re.search(r'([\d.]+)\s*GFLOPS', line)
                 if gflops_match:
                     gflops_values.append(float(gflops_match.group(1)))
+                
+                # DGEMM also prints its reference peak; the headline is its own best
+                dgemm_match = re.search(r'Best DGEMM:\s*([\d.]+)\s*GFLOPS', line)
+                if dgemm_match:
+                    dgemm_gflops = float(dgemm_match.group(1))
+            
+            if dgemm_gflops is not None:
+                mflops_values = [dgemm_gflops * 1000]
+                gflops_values = [dgemm_gflops]
             
             return {
                 "success": True,
@@ -189,14 +479,17 @@ class BenchmarkRunner:
                 "gflops_values": gflops_values,
                 "max_mflops": max(mflops_values) if mflops_values else 0,
                 "max_gflops": max(gflops_values) if gflops_values else max(mflops_values)/1000 if mflops_values else 0,
+                "bandwidth_gbps": bandwidth_gbps,
+                "latency_ns": latency_ns,
+                "trial_stats": max(trial_stats, key=lambda t: t[0])[1] if trial_stats else None,
                 "duration": end_time - start_time
             }
             
-        except subprocess.TimeoutExpired:
+        except subprocess.TimeoutExpired as e:
             return {
                 "success": False,
-                "error": "Benchmark timed out after 120 seconds",
-                "duration": 120
+                "error": f"Benchmark timed out after {e.timeout:.0f} seconds",
+                "duration": e.timeout
             }
         except Exception as e:
             return {
@@ -205,6 +498,55 @@ class BenchmarkRunner:
                 "duration": 0
             }
     
+    @staticmethod
+    def _scrape_memory_summary(text: str):
+        """Sustained (DRAM triad) bandwidth and the load-to-use latency of the
+        largest chase buffer from the memory benchmark's summary, or None"""
+        bandwidth_match = re.search(r'Sustained bandwidth:\s*([\d.]+)\s*GB/s', text)
+        latency_match = re.search(r'DRAM latency:\s*([\d.]+)\s*ns', text)
+        return (float(bandwidth_match.group(1)) if bandwidth_match else None,
+                float(latency_match.group(1)) if latency_match else None)
+    
+    @classmethod
+    def _parse_records(cls, stdout: str, stderr: str, duration: float) -> Optional[Dict]:
+        """Results from a binary's --json document; None if it did not emit one"""
+        try:
+            document = json.loads(stdout)
+        except ValueError:
+            return None
+        records = document.get("records") or []
+        if not records:
+            return None
+        
+        # The fastest test is the headline, as with the scraped output
+        headline = max(records, key=lambda r: r["mflops"])
+        stats = headline["stats"]
+        mflops_values = [r["mflops"] for r in records]
+        # Bandwidth and latency are not FLOP records; they stay in the summary
+        bandwidth_gbps, latency_ns = cls._scrape_memory_summary(stderr)
+        
+        return {
+            "success": True,
+            "output": stderr,  # human-readable text moves to stderr in --json mode
+            "records": records,
+            "mflops_values": mflops_values,
+            "gflops_values": [m / 1000 for m in mflops_values],
+            "max_mflops": headline["mflops"],
+            "max_gflops": headline["mflops"] / 1000,
+            "bandwidth_gbps": bandwidth_gbps,
+            "latency_ns": latency_ns,
+            "trial_stats": {
+                "trials": headline["trials"],
+                "min": stats["min"],
+                "median": stats["median"],
+                "mean": stats["mean"],
+                "stddev": stats["stddev"],
+                "p95": stats["p95"],
+                "cv_percent": stats["cv"] * 100
+            },
+            "duration": duration
+        }
+    
     def _print_header(self):
         """Print beautiful header"""
         if RICH_AVAILABLE:
@@ -274,7 +616,10 @@ class BenchmarkRunner:
             
             descriptions = {
                 "basic": "Single-threaded scalar operations",
-                "vectorized": "Multi-threaded + AVX2 vectorization",
+                "vectorized": "Multi-threaded + SIMD (runtime ISA dispatch)",
+                "memory": "STREAM bandwidth L1..DRAM + roofline",
+                "dgemm": "Cache-blocked SIMD DGEMM, % of peak",
+                "spmv": "CSR / SELL-C-σ SpMV, gather / scatter",
                 "gpu": "GPU/OpenCL compute (if available)"
             }
             
@@ -293,7 +638,10 @@ class BenchmarkRunner:
             print("\n=== Available Benchmarks ===")
             descriptions = {
                 "basic": "Single-threaded scalar operations",
-                "vectorized": "Multi-threaded + AVX2 vectorization", 
+                "vectorized": "Multi-threaded + SIMD (runtime ISA dispatch)", 
+                "memory": "STREAM bandwidth L1..DRAM + roofline",
+                "dgemm": "Cache-blocked SIMD DGEMM, % of peak",
+                "spmv": "CSR / SELL-C-σ SpMV, gather / scatter",
                 "gpu": "GPU/OpenCL compute (if available)"
             }
             
@@ -307,8 +655,14 @@ class BenchmarkRunner:
                 
                 print(f"  {name.title()}: {status} - {descriptions.get(name, '')}")
     
-    def run_benchmarks(self, verbose: bool = False):
-        """Run all available benchmarks with beautiful output"""
+    def run_benchmarks(self, verbose: bool = False, json_output: Optional[str] = None,
+                       store: Optional[ResultStore] = None, save: bool = False,
+                       compare: bool = False, threshold: float = 0.05) -> int:
+        """Run all available benchmarks with beautiful output.
+        
+        Returns the exit status: 0, 1 if --compare found a regression, 2 if
+        nothing could be run or a benchmark failed.
+        """
         self._print_header()
         self._print_system_info()
         self._print_benchmark_status()
@@ -325,7 +679,7 @@ class BenchmarkRunner:
             else:
                 print("\n❌ No benchmarks available to run!")
                 print("Run 'make' to build benchmarks first.")
-            return
+            return 2
         
         # Results table
         if RICH_AVAILABLE:
@@ -333,41 +687,273 @@ class BenchmarkRunner:
         else:
             print(f"\n🏃 Running {len(available_benchmarks)} benchmark(s)...\n")
         
-        results_data = []
+        start_time = time.time()
+        results_data = self._run_scheduled(available_benchmarks, verbose)
+        wall_time = time.time() - start_time
         
-        for benchmark_name, benchmark_info in available_benchmarks:
-            if RICH_AVAILABLE:
-                with self.console.status(f"[bold green]Running {benchmark_name} benchmark...", spinner="dots"):
-                    result = self._run_benchmark(benchmark_name, benchmark_info["path"])
+        total_duration = sum(r["duration"] for r in results_data if not r.get("system"))
+        message = f"Wall time: {wall_time:.1f}s for {total_duration:.1f}s of benchmarks ({self.schedule} schedule)"
+        if RICH_AVAILABLE:
+            self.console.print(f"\n[dim]{message}[/dim]")
+        else:
+            print(f"\n{message}")
+        
+        # Display results
+        self._display_results(results_data)
+        
+        if json_output:
+            self._write_json_output(json_output, results_data)
+        
+        # Display detailed output if verbose
+        if verbose:
+            self._display_detailed_output()
+        
+        status = 0 if all(r["success"] for r in self.results.values()) else 2
+        if store and (save or compare):
+            env = ResultStore.environment(self.capabilities["cpu_info"]["model"])
+            lines = ResultStore.entries(results_data, env, self.capabilities["cpu_info"]["threads"])
+            if compare:
+                verdicts = store.compare(lines, threshold)
+                self._display_comparison(verdicts, env, threshold, store.path)
+                if status == 0 and any(v["status"] == "regressed" for v in verdicts):
+                    status = 1
+            # After the comparison, so a run is never its own baseline
+            if save:
+                store.append(lines)
+                self._print_line(f"✓ Saved {len(lines)} result(s) to {store.path}", "green")
+        return status
+    
+    def _display_comparison(self, verdicts: List[Dict], env: Dict, threshold: float, path: Path):
+        """Regression table against the stored baseline, worst change first"""
+        ranked = sorted(verdicts, key=lambda v: v["change"] if v["change"] is not None else float("inf"))
+        styles = {"regressed": "bold red", "faster": "green", "ok": "white", "new": "dim"}
+        title = f"Baseline comparison (slowdown ≥ {threshold * 100:.0f}%, p < {ResultStore.ALPHA})"
+        
+        def cells(verdict):
+            line = verdict["line"]
+            unit = "GB/s" if line["unit"] == "gbps" else "MFLOPS"
+            baseline = f"{verdict['baseline']:.1f} {unit}" if verdict["baseline"] is not None else "-"
+            change = f"{verdict['change'] * 100:+.1f}%" if verdict["change"] is not None else "-"
+            p = f"{verdict['p']:.2g}" if verdict["p"] is not None else "-"
+            return [line["benchmark"], line["kernel"], line["isa"], str(line["threads"]),
+                    baseline, f"{line['value']:.1f} {unit}", change, p]
+        
+        if RICH_AVAILABLE:
+            table = Table(title=title, box=box.ROUNDED)
+            for column in ("Benchmark", "Kernel", "ISA", "Threads", "Baseline", "Current", "Change", "p"):
+                table.add_column(column)
+            table.add_column("Status")
+            for verdict in ranked:
+                table.add_row(*cells(verdict), Text(verdict["status"], style=styles[verdict["status"]]))
+            self.console.print(table)
+        else:
+            print(f"\n=== {title} ===")
+            print(f"{'Benchmark':<20} {'Kernel':<16} {'ISA':<10} {'Thr':>4} {'Baseline':>18} "
+                  f"{'Current':>18} {'Change':>8} {'p':>8}  Status")
+            for verdict in ranked:
+                row = cells(verdict)
+                print(f"{row[0]:<20} {row[1]:<16} {row[2]:<10} {row[3]:>4} {row[4]:>18} "
+                      f"{row[5]:>18} {row[6]:>8} {row[7]:>8}  {verdict['status']}")
+        
+        regressed = [v for v in verdicts if v["status"] == "regressed"]
+        if not regressed:
+            if all(v["status"] == "new" for v in verdicts):
+                self._print_line(f"⚠ No baseline for this node in {path}; "
+                                 f"run with --save to record one", "yellow")
             else:
-                print(f"Running {benchmark_name} benchmark...")
-                result = self._run_benchmark(benchmark_name, benchmark_info["path"])
+                self._print_line("✓ No significant regressions", "green")
+            return
+        
+        # What changed on the node since the baseline was recorded
+        previous = regressed[0]["previous"]
+        changed = [f"{field} {previous.get(field)} → {env[field]}"
+                   for field in ("kernel_release", "microcode", "bios") if previous.get(field) != env[field]]
+        self._print_line(f"✗ {len(regressed)} regression(s) against the baseline"
+                         + (f" ({', '.join(changed)})" if changed else ""), "red")
+    
+    @staticmethod
+    def _available_cores() -> int:
+        """CPUs this process may run on: the affinity mask where the OS has one, else every CPU"""
+        if hasattr(os, "sched_getaffinity"):
+            return len(os.sched_getaffinity(0)) or 1
+        return os.cpu_count() or 1
+    
+    def _schedule_tasks(self, available_benchmarks: List[Tuple[str, Dict]]) -> List[Dict]:
+        """Group the benchmarks into tasks, each with the resources it holds while running"""
+        cores = self._available_cores()
+        names = [name for name, _ in available_benchmarks]
+        corun = (self.schedule == "corun" and all(name in names for name in self.CORUN_GROUP))
+        
+        tasks = []
+        for name, info in available_benchmarks:
+            if corun and name in self.CORUN_GROUP:
+                if name != self.CORUN_GROUP[0]:
+                    continue
+                members = [(n, i) for n, i in available_benchmarks if n in self.CORUN_GROUP]
+                tasks.append({"members": members, "cores": cores, "gpu": 1, "corun": True})
+                continue
+            claim = self.RESOURCE_CLAIMS.get(name, {"cores": "all", "gpu": 1})
+            if self.schedule == "serial":
+                claim = {"cores": "all", "gpu": 1}
+            tasks.append({
+                "members": [(name, info)],
+                "cores": cores if claim["cores"] == "all" else min(claim["cores"], cores),
+                "gpu": claim["gpu"],
+                "corun": False
+            })
+        return tasks
+    
+    def _run_scheduled(self, available_benchmarks: List[Tuple[str, Dict]], verbose: bool) -> List[Dict]:
+        """Run the benchmarks, starting each task as soon as its resources are free.
+        
+        Tasks are considered in suite order, but a later task whose claim fits
+        starts ahead of an earlier one that is still waiting (backfill), so the
+        single-core and GPU tests overlap while the all-core tests run alone.
+        """
+        tasks = self._schedule_tasks(available_benchmarks)
+        total_cores = self._available_cores()
+        for task in tasks:
+            task["cores"] = min(task["cores"], total_cores)
+        free = {"cores": total_cores, "gpu": 1}
+        status = {name: "queued" for name, _ in available_benchmarks}
+        results_data = []
+        lock = threading.Lock()
+        
+        def run_task(task):
+            members = task["members"]
+            if len(members) == 1:
+                name, info = members[0]
+                with lock:
+                    status[name] = "running"
+                return [(name, self._run_benchmark(name, info["path"]))]
             
-            if result["success"]:
-                results_data.append({
-                    "name": benchmark_name,
+            # Co-run: every member starts at the same time
+            with ThreadPoolExecutor(max_workers=len(members)) as group:
+                with lock:
+                    for name, _ in members:
+                        status[name] = "running"
+                futures = [(name, group.submit(self._run_benchmark, name, info["path"])) for name, info in members]
+                return [(name, future.result()) for name, future in futures]
+        
+        def collect(task, outcomes):
+            corun_gflops = 0.0
+            corun_duration = 0.0
+            for name, result in outcomes:
+                self.results[name] = result
+                if not result["success"]:
+                    status[name] = "failed"
+                    self._print_line(f"✗ {name} failed: {result['error']}", "red")
+                    continue
+                status[name] = "done"
+                entry = {
+                    "name": f"{name} (co-run)" if task["corun"] else name,
                     "mflops": result["max_mflops"],
                     "gflops": result["max_gflops"],
+                    "gbps": result["bandwidth_gbps"],
+                    "latency_ns": result.get("latency_ns"),
+                    "stats": result["trial_stats"],
+                    "records": result.get("records", []),
                     "duration": result["duration"],
                     "details": result["mflops_values"]
+                }
+                results_data.append(entry)
+                corun_gflops += entry["gflops"]
+                corun_duration = max(corun_duration, entry["duration"])
+                if verbose or not RICH_AVAILABLE:
+                    self._print_line(f"✓ {name} completed in {result['duration']:.2f}s: "
+                                     f"{self._format_performance(entry)}", "green")
+            
+            # Whole-system throughput of the co-run group
+            if task["corun"] and all(outcome[1]["success"] for outcome in outcomes):
+                results_data.append({
+                    "name": "system",
+                    "system": True,
+                    "mflops": corun_gflops * 1000,
+                    "gflops": corun_gflops,
+                    "gbps": None,
+                    "stats": None,
+                    "records": [],
+                    "duration": corun_duration,
+                    "details": []
                 })
-                
-                if verbose and RICH_AVAILABLE:
-                    self.console.print(f"[green]✓[/green] {benchmark_name} completed in {result['duration']:.2f}s")
-                elif verbose:
-                    print(f"✓ {benchmark_name} completed in {result['duration']:.2f}s")
-            else:
-                if RICH_AVAILABLE:
-                    self.console.print(f"[red]✗[/red] {benchmark_name} failed: {result['error']}")
-                else:
-                    print(f"✗ {benchmark_name} failed: {result['error']}")
         
-        # Display results
-        self._display_results(results_data)
+        def fits(task):
+            return task["cores"] <= free["cores"] and task["gpu"] <= free["gpu"]
         
-        # Display detailed output if verbose
-        if verbose:
-            self._display_detailed_output()
+        pending = list(tasks)
+        running = {}
+        live = Live(self._progress_table(status, results_data), console=self.console,
+                    refresh_per_second=4) if RICH_AVAILABLE else None
+        if live:
+            live.start()
+        try:
+            with ThreadPoolExecutor(max_workers=len(tasks)) as pool:
+                while pending or running:
+                    for task in list(pending):
+                        if fits(task):
+                            pending.remove(task)
+                            free["cores"] -= task["cores"]
+                            free["gpu"] -= task["gpu"]
+                            running[pool.submit(run_task, task)] = task
+                    if live:
+                        live.update(self._progress_table(status, results_data))
+                    
+                    done, _ = wait(running.keys(), return_when=FIRST_COMPLETED)
+                    for future in done:
+                        task = running.pop(future)
+                        free["cores"] += task["cores"]
+                        free["gpu"] += task["gpu"]
+                        with lock:
+                            collect(task, future.result())
+                    if live:
+                        live.update(self._progress_table(status, results_data))
+        finally:
+            if live:
+                live.stop()
+        
+        # Suite order, whatever the completion order
+        order = [name for name, _ in available_benchmarks]
+        results_data.sort(key=lambda r: (order.index(r["name"].split(" ")[0]) if not r.get("system") else len(order)))
+        return results_data
+    
+    def _print_line(self, message: str, color: str):
+        if RICH_AVAILABLE:
+            self.console.print(f"[{color}]{message[0]}[/{color}]{message[1:]}")
+        else:
+            print(message)
+    
+    @staticmethod
+    def _format_performance(result: Dict) -> str:
+        if result.get("gbps") and result.get("latency_ns"):
+            return f"{result['gbps']:.2f} GB/s, DRAM {result['latency_ns']:.0f} ns"
+        if result.get("gbps"):
+            return f"{result['gbps']:.2f} GB/s"
+        if result["gflops"] >= 1.0:
+            return f"{result['gflops']:.2f} GFLOPS"
+        return f"{result['mflops']:.0f} MFLOPS"
+    
+    def _progress_table(self, status: Dict[str, str], results_data: List[Dict]) -> "Table":
+        """Live view: one row per benchmark, filled in as results arrive"""
+        styles = {"queued": "dim", "running": "yellow", "done": "green", "failed": "red"}
+        table = Table(title=f"Running ({self.schedule} schedule)", box=box.ROUNDED)
+        table.add_column("Benchmark", style="cyan", width=20)
+        table.add_column("Status", width=10)
+        table.add_column("Performance", width=24)
+        table.add_column("Duration", style="dim", width=10)
+        by_name = {r["name"].split(" ")[0]: r for r in results_data if not r.get("system")}
+        for name, state in status.items():
+            result = by_name.get(name)
+            table.add_row(name.title(), Text(state, style=styles[state]),
+                          self._format_performance(result) if result else "",
+                          f"{result['duration']:.1f}s" if result else "")
+        return table
+    
+    @staticmethod
+    def _format_stability(stats: Optional[Dict]) -> str:
+        """Run-to-run spread of the headline test, e.g. '±1.2% (n=5)'"""
+        if not stats:
+            return "-"
+        return f"±{stats['cv_percent']:.1f}% (n={stats['trials']})"
     
     def _display_results(self, results_data: List[Dict]):
         """Display benchmark results in a beautiful table"""
@@ -378,44 +964,58 @@ class BenchmarkRunner:
             # Create results table
             table = Table(title="🏆 Benchmark Results", box=box.HEAVY_EDGE)
             table.add_column("Benchmark", style="cyan", width=20)
-            table.add_column("Performance", style="white", width=20)
+            table.add_column("Performance", style="white", width=24)
             table.add_column("Relative", style="yellow", width=15)
+            table.add_column("Stability", style="magenta", width=16)
             table.add_column("Duration", style="dim", width=10)
             
             # Find baseline (basic benchmark) for relative comparison
+            # Bandwidth-only benchmarks are listed but not ranked by FLOPS
+            flops_results = [r for r in results_data if not r.get("gbps")]
             baseline_mflops = None
-            for result in results_data:
+            for result in flops_results:
                 if result["name"] == "basic":
                     baseline_mflops = result["mflops"]
                     break
-            if not baseline_mflops and results_data:
-                baseline_mflops = min(r["mflops"] for r in results_data)
+            if not baseline_mflops and flops_results:
+                baseline_mflops = min(r["mflops"] for r in flops_results)
             
             # Add rows
             for result in results_data:
                 name = result["name"].title()
                 
-                if result["gflops"] >= 1.0:
+                if result.get("gbps"):
+                    perf = self._format_performance(result)
+                    perf_style = "bold blue"
+                elif result["gflops"] >= 1.0:
                     perf = f"{result['gflops']:.2f} GFLOPS"
                     perf_style = "bold green"
                 else:
                     perf = f"{result['mflops']:.0f} MFLOPS"
                     perf_style = "green" if result["mflops"] > 1000 else "yellow"
                 
-                relative = f"{result['mflops']/baseline_mflops:.1f}x" if baseline_mflops else "N/A"
+                if result.get("gbps"):
+                    relative = "-"
+                else:
+                    relative = f"{result['mflops']/baseline_mflops:.1f}x" if baseline_mflops else "N/A"
+                stability = self._format_stability(result.get("stats"))
                 duration = f"{result['duration']:.1f}s"
                 
                 table.add_row(
                     name,
                     Text(perf, style=perf_style),
                     relative,
+                    stability,
                     duration
                 )
             
             self.console.print(table)
             
+            if not flops_results:
+                return
+            
             # Summary stats
-            max_result = max(results_data, key=lambda x: x["mflops"])
+            max_result = max(flops_results, key=lambda x: x["mflops"])
             total_gflops = max_result["gflops"]
             
             summary = Panel(
@@ -430,35 +1030,69 @@ class BenchmarkRunner:
         else:
             # Fallback text output
             print("\n=== Benchmark Results ===")
-            print(f"{'Benchmark':<20} {'Performance':<20} {'Relative':<15} {'Duration':<10}")
-            print("-" * 65)
+            print(f"{'Benchmark':<20} {'Performance':<24} {'Relative':<15} {'Stability':<16} {'Duration':<10}")
+            print("-" * 86)
             
+            # Bandwidth-only benchmarks are listed but not ranked by FLOPS
+            flops_results = [r for r in results_data if not r.get("gbps")]
             baseline_mflops = None
-            for result in results_data:
+            for result in flops_results:
                 if result["name"] == "basic":
                     baseline_mflops = result["mflops"]
                     break
-            if not baseline_mflops and results_data:
-                baseline_mflops = min(r["mflops"] for r in results_data)
+            if not baseline_mflops and flops_results:
+                baseline_mflops = min(r["mflops"] for r in flops_results)
             
             for result in results_data:
                 name = result["name"].title()
                 
-                if result["gflops"] >= 1.0:
+                if result.get("gbps"):
+                    perf = self._format_performance(result)
+                elif result["gflops"] >= 1.0:
                     perf = f"{result['gflops']:.2f} GFLOPS"
                 else:
                     perf = f"{result['mflops']:.0f} MFLOPS"
                 
-                relative = f"{result['mflops']/baseline_mflops:.1f}x" if baseline_mflops else "N/A"
+                if result.get("gbps"):
+                    relative = "-"
+                else:
+                    relative = f"{result['mflops']/baseline_mflops:.1f}x" if baseline_mflops else "N/A"
+                stability = self._format_stability(result.get("stats"))
                 duration = f"{result['duration']:.1f}s"
                 
-                print(f"{name:<20} {perf:<20} {relative:<15} {duration:<10}")
+                print(f"{name:<20} {perf:<24} {relative:<15} {stability:<16} {duration:<10}")
+            
+            if not flops_results:
+                return
             
             # Summary
-            max_result = max(results_data, key=lambda x: x["mflops"])
+            max_result = max(flops_results, key=lambda x: x["mflops"])
             print(f"\n🎯 Peak Performance: {max_result['gflops']:.2f} GFLOPS")
             print(f"💡 Best Configuration: {max_result['name'].title()}")
     
+    def _write_json_output(self, path: str, results_data: List[Dict]):
+        """Write every benchmark's records (or headline numbers) for metrics pipelines"""
+        document = {
+            "system": {
+                "cpu": self.capabilities["cpu_info"],
+                "platform": platform.platform()
+            },
+            "benchmarks": [
+                {
+                    "name": r["name"],
+                    "mflops": r["mflops"],
+                    "gbps": r["gbps"],
+                    "latency_ns": r.get("latency_ns"),
+                    "stats": r["stats"],
+                    "duration": r["duration"],
+                    "records": r["records"]
+                }
+                for r in results_data
+            ]
+        }
+        with open(path, "w") as f:
+            json.dump(document, f, indent=2)
+    
     def _display_detailed_output(self):
         """Display detailed benchmark output"""
         if RICH_AVAILABLE:
@@ -505,7 +1139,18 @@ def check_dependencies():
 @click.command() if CLICK_AVAILABLE else lambda f: f
 @click.option('--verbose', '-v', is_flag=True, help='Show detailed benchmark output')
 @click.option('--build', '-b', is_flag=True, help='Build benchmarks before running')
-def main(verbose: bool = False, build: bool = False):
+@click.option('--json-output', type=click.Path(), default=None, help='Write all results as JSON to this file')
+@click.option('--time', 'target_time', type=float, default=None, help='Target seconds per trial (calibrates operation counts)')
+@click.option('--schedule', type=click.Choice(BenchmarkRunner.SCHEDULES), default="parallel",
+              help='serial: one at a time; parallel: overlap tests that do not compete; corun: CPU+GPU load test')
+@click.option('--store', type=click.Path(), default=None,
+              help='Result history file (default: ~/.cache/sisu-flops/results.jsonl)')
+@click.option('--save', is_flag=True, help='Append this run to the result history')
+@click.option('--compare', is_flag=True, help='Compare against the stored baseline; exit 1 on a regression')
+@click.option('--threshold', type=float, default=5.0, help='Smallest slowdown, in percent, that --compare reports')
+def main(verbose: bool = False, build: bool = False, json_output: Optional[str] = None,
+         target_time: Optional[float] = None, schedule: str = "parallel", store: Optional[str] = None,
+         save: bool = False, compare: bool = False, threshold: float = 5.0):
     """Run comprehensive floating-point performance benchmarks"""
     
     # Change to script directory
@@ -516,14 +1161,16 @@ def main(verbose: bool = False, build: bool = False):
     
     if build:
         print("🔨 Building benchmarks...")
-        result = subprocess.run(["make", "all"], capture_output=True, text=True)
+        result = subprocess.run(["make", f"-j{os.cpu_count() or 1}", "all"], capture_output=True, text=True)
         if result.returncode != 0:
             print(f"❌ Build failed: {result.stderr}")
-            return
+            sys.exit(2)
         print("✅ Build successful!\n")
     
-    runner = BenchmarkRunner()
-    runner.run_benchmarks(verbose=verbose)
+    runner = BenchmarkRunner(target_time=target_time, schedule=schedule)
+    status = runner.run_benchmarks(verbose=verbose, json_output=json_output, store=ResultStore(store),
+                                   save=save, compare=compare, threshold=threshold / 100)
+    sys.exit(status)
 
 
 if __name__ == "__main__":
@@ -533,4 +1180,24 @@ if __name__ == "__main__":
         # Fallback without click
         verbose = "--verbose" in sys.argv or "-v" in sys.argv
         build = "--build" in sys.argv or "-b" in sys.argv
-        main(verbose, build)
+        json_output = None
+        if "--json-output" in sys.argv and sys.argv.index("--json-output") + 1 < len(sys.argv):
+            json_output = sys.argv[sys.argv.index("--json-output") + 1]
+        target_time = None
+        if "--time" in sys.argv and sys.argv.index("--time") + 1 < len(sys.argv):
+            target_time = float(sys.argv[sys.argv.index("--time") + 1])
+        schedule = "parallel"
+        if "--schedule" in sys.argv and sys.argv.index("--schedule") + 1 < len(sys.argv):
+            schedule = sys.argv[sys.argv.index("--schedule") + 1]
+            if schedule not in BenchmarkRunner.SCHEDULES:
+                print(f"Unknown --schedule '{schedule}' ({', '.join(BenchmarkRunner.SCHEDULES)})")
+                sys.exit(2)
+        store = None
+        if "--store" in sys.argv and sys.argv.index("--store") + 1 < len(sys.argv):
+            store = sys.argv[sys.argv.index("--store") + 1]
+        save = "--save" in sys.argv
+        compare = "--compare" in sys.argv
+        threshold = 5.0
+        if "--threshold" in sys.argv and sys.argv.index("--threshold") + 1 < len(sys.argv):
+            threshold = float(sys.argv[sys.argv.index("--threshold") + 1])
+        main(verbose, build, json_output, target_time, schedule, store, save, compare, threshold)
@@ -0,0 +1,432 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
+#include <omp.h>
+#include "affinity.h"
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+static affinity_plan_t plan;
+static volatile int plan_ready = 0;
+
+// Plan indices threads are bound to; narrowed by affinity_restrict_socket
+static int active[AFFINITY_MAX_CPUS];
+static int active_count = 0;
+
+// CPU the calling thread is currently bound to
+static __thread int bound_cpu = -1;
+
+static int read_topology(int cpu, const char *leaf, int fallback) {
+    char path[128];
+    int value;
+    
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, leaf);
+    FILE *f = fopen(path, "r");
+    if (!f) return fallback;
+    if (fscanf(f, "%d", &value) != 1) value = fallback;
+    fclose(f);
+    return value;
+}
+
+// NUMA node of `cpu`: libnuma when available, else the cpuN/nodeM sysfs link
+static int cpu_node(int cpu) {
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0) {
+        int node = numa_node_of_cpu(cpu);
+        if (node >= 0) return node;
+    }
+#endif
+    char path[128];
+    int node = 0;
+    
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL; ) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+// Placement sort keys; `rank` is the core's position within its socket
+typedef struct {
+    cpu_slot_t slot;
+    int rank;
+} ranked_slot_t;
+
+static int compare_compact(const void *a, const void *b) {
+    const cpu_slot_t *x = &((const ranked_slot_t *)a)->slot;
+    const cpu_slot_t *y = &((const ranked_slot_t *)b)->slot;
+    if (x->socket != y->socket) return x->socket - y->socket;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int compare_scatter(const void *a, const void *b) {
+    const ranked_slot_t *x = a;
+    const ranked_slot_t *y = b;
+    if (x->slot.smt != y->slot.smt) return x->slot.smt - y->slot.smt;
+    if (x->rank != y->rank) return x->rank - y->rank;
+    if (x->slot.socket != y->slot.socket) return x->slot.socket - y->slot.socket;
+    return x->slot.cpu - y->slot.cpu;
+}
+
+static int count_distinct(const ranked_slot_t *slots, int count, int node) {
+    int distinct = 0;
+    for (int i = 0; i < count; i++) {
+        int value = node ? slots[i].slot.node : slots[i].slot.socket;
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = (node ? slots[j].slot.node : slots[j].slot.socket) == value;
+        }
+        if (!seen) distinct++;
+    }
+    return distinct;
+}
+
+// Mark the CPUs of a sysfs cpu list ("0-7,16-19") in `set`
+static int read_cpulist(const char *path, cpu_set_t *set) {
+    char text[1024];
+    
+    CPU_ZERO(set);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fgets(text, sizeof(text), f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+    
+    for (char *p = text; *p; ) {
+        char *end;
+        long first = strtol(p, &end, 10), last = first;
+        if (end == p) break;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, set);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return 0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// CPUID leaf 0x1A on `cpu`, run there by briefly pinning the calling thread.
+// Core type in EAX[31:24]: 0x40 Core (P), 0x20 Atom (E).
+static int cpuid_core_type(int cpu) {
+    unsigned eax, ebx, ecx, edx;
+    cpu_set_t original, set;
+    int type = AFFINITY_CORE_ANY;
+    
+    if (pthread_getaffinity_np(pthread_self(), sizeof(original), &original) != 0) return type;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        __cpuid_count(0x1a, 0, eax, ebx, ecx, edx);
+        if ((eax >> 24) == 0x40) type = AFFINITY_CORE_PERFORMANCE;
+        else if ((eax >> 24) == 0x20) type = AFFINITY_CORE_EFFICIENCY;
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+    return type;
+}
+
+// CPUID.(7,0):EDX[15], the hybrid part flag
+static int cpuid_hybrid(void) {
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, NULL) < 0x1a) return 0;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (edx >> 15) & 1;
+}
+#endif
+
+// Core type of every slot. Intel hybrid kernels list the CPUs of the
+// cpu_core and cpu_atom PMUs; without them CPUID leaf 0x1A is asked on each
+// CPU, and elsewhere (Arm big.LITTLE) the highest cpu_capacity marks the
+// performance cores. Returns the source used, "" when all cores are alike.
+static const char *detect_core_types(ranked_slot_t *slots, int count) {
+    cpu_set_t core, atom;
+    
+    for (int i = 0; i < count; i++) slots[i].slot.core_type = AFFINITY_CORE_ANY;
+    
+    if (read_cpulist("/sys/devices/cpu_core/cpus", &core) == 0 &&
+        read_cpulist("/sys/devices/cpu_atom/cpus", &atom) == 0) {
+        for (int i = 0; i < count; i++) {
+            int cpu = slots[i].slot.cpu;
+            slots[i].slot.core_type = CPU_ISSET(cpu, &core) ? AFFINITY_CORE_PERFORMANCE
+                                    : CPU_ISSET(cpu, &atom) ? AFFINITY_CORE_EFFICIENCY : AFFINITY_CORE_ANY;
+        }
+        return "cpu_core/cpu_atom PMU";
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpuid_hybrid()) {
+        for (int i = 0; i < count; i++) slots[i].slot.core_type = cpuid_core_type(slots[i].slot.cpu);
+        return "CPUID 0x1A";
+    }
+#endif
+
+    int capacity[AFFINITY_MAX_CPUS];
+    int max_capacity = 0, min_capacity = 0;
+    for (int i = 0; i < count; i++) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", slots[i].slot.cpu);
+        FILE *f = fopen(path, "r");
+        capacity[i] = 0;
+        if (f) {
+            if (fscanf(f, "%d", &capacity[i]) != 1) capacity[i] = 0;
+            fclose(f);
+        }
+        if (capacity[i] <= 0) return "";
+        if (i == 0 || capacity[i] > max_capacity) max_capacity = capacity[i];
+        if (i == 0 || capacity[i] < min_capacity) min_capacity = capacity[i];
+    }
+    if (count == 0 || min_capacity == max_capacity) return "";
+    for (int i = 0; i < count; i++) {
+        slots[i].slot.core_type = capacity[i] == max_capacity ? AFFINITY_CORE_PERFORMANCE : AFFINITY_CORE_EFFICIENCY;
+    }
+    return "cpu_capacity";
+}
+
+static affinity_policy_t parse_policy(const char *name) {
+    // Respect an explicit OpenMP placement unless a policy is forced
+    if (!name || !*name) {
+        return getenv("OMP_PLACES") || getenv("OMP_PROC_BIND") ? AFFINITY_NONE : AFFINITY_COMPACT;
+    }
+    if (strcasecmp(name, "compact") == 0) return AFFINITY_COMPACT;
+    if (strcasecmp(name, "scatter") == 0) return AFFINITY_SCATTER;
+    if (strcasecmp(name, "cores") == 0) return AFFINITY_CORES;
+    if (strcasecmp(name, "none") == 0) return AFFINITY_NONE;
+    
+    fprintf(stderr, "Unknown SISU_AFFINITY '%s' (compact, scatter, cores, none), using compact\n", name);
+    return AFFINITY_COMPACT;
+}
+
+static void build_plan(void) {
+    static ranked_slot_t slots[AFFINITY_MAX_CPUS];
+    const char *smt = getenv("SISU_SMT");
+    cpu_set_t allowed;
+    int count = 0;
+    
+    plan.policy = parse_policy(getenv("SISU_AFFINITY"));
+    plan.smt = !(smt && (strcasecmp(smt, "off") == 0 || strcmp(smt, "0") == 0));
+    if (plan.policy == AFFINITY_CORES) plan.smt = 0;
+    
+    // Only CPUs this process may run on (taskset, cgroups)
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &allowed);
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE && count < AFFINITY_MAX_CPUS; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        slots[count].slot.cpu = cpu;
+        slots[count].slot.socket = read_topology(cpu, "physical_package_id", 0);
+        slots[count].slot.core = read_topology(cpu, "core_id", cpu);
+        slots[count].slot.node = cpu_node(cpu);
+        count++;
+    }
+    plan.core_type_source = detect_core_types(slots, count);
+    
+    // Compact order, numbering SMT siblings and each socket's cores
+    qsort(slots, count, sizeof(slots[0]), compare_compact);
+    for (int i = 0, rank = -1; i < count; i++) {
+        int same_core = i > 0 && slots[i].slot.socket == slots[i - 1].slot.socket &&
+                        slots[i].slot.core == slots[i - 1].slot.core;
+        int same_socket = i > 0 && slots[i].slot.socket == slots[i - 1].slot.socket;
+        slots[i].slot.smt = same_core ? slots[i - 1].slot.smt + 1 : 0;
+        rank = same_core ? rank : (same_socket ? rank + 1 : 0);
+        slots[i].rank = rank;
+    }
+    if (plan.policy == AFFINITY_SCATTER) {
+        qsort(slots, count, sizeof(slots[0]), compare_scatter);
+    }
+    
+    plan.count = 0;
+    for (int i = 0; i < count; i++) {
+        if (!plan.smt && slots[i].slot.smt > 0) continue;
+        slots[plan.count] = slots[i];
+        plan.slots[plan.count++] = slots[i].slot;
+    }
+    plan.sockets = count_distinct(slots, plan.count, 0);
+    plan.nodes = count_distinct(slots, plan.count, 1);
+    
+    int performance = 0, efficiency = 0;
+    for (int i = 0; i < plan.count; i++) {
+        performance += plan.slots[i].core_type == AFFINITY_CORE_PERFORMANCE;
+        efficiency += plan.slots[i].core_type == AFFINITY_CORE_EFFICIENCY;
+    }
+    plan.hybrid = performance > 0 && efficiency > 0;
+    
+    active_count = plan.count;
+    for (int i = 0; i < plan.count; i++) active[i] = i;
+}
+
+const affinity_plan_t *affinity_plan(void) {
+    if (!plan_ready) {
+        #pragma omp critical (affinity_plan)
+        {
+            if (!plan_ready) {
+                build_plan();
+                plan_ready = 1;
+            }
+        }
+    }
+    return &plan;
+}
+
+const char *affinity_policy_name(affinity_policy_t policy) {
+    switch (policy) {
+    case AFFINITY_COMPACT: return "compact";
+    case AFFINITY_SCATTER: return "scatter";
+    case AFFINITY_CORES: return "cores";
+    default: return "none";
+    }
+}
+
+int affinity_default_threads(void) {
+    const affinity_plan_t *p = affinity_plan();
+    return p->count > 0 ? p->count : 1;
+}
+
+void affinity_bind_thread(int thread_id) {
+    const affinity_plan_t *p = affinity_plan();
+    if (p->policy == AFFINITY_NONE || active_count == 0) return;
+    
+    int cpu = p->slots[active[thread_id % active_count]].cpu;
+    if (cpu == bound_cpu) return;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        bound_cpu = cpu;
+    }
+}
+
+int affinity_restrict_socket(int socket) {
+    const affinity_plan_t *p = affinity_plan();
+    
+    active_count = 0;
+    for (int i = 0; i < p->count; i++) {
+        if (socket < 0 || p->slots[i].socket == socket) active[active_count++] = i;
+    }
+    return active_count;
+}
+
+int affinity_restrict_core_type(affinity_core_type_t type) {
+    const affinity_plan_t *p = affinity_plan();
+    
+    active_count = 0;
+    for (int i = 0; i < p->count; i++) {
+        if (type == AFFINITY_CORE_ANY || p->slots[i].core_type == (int)type) active[active_count++] = i;
+    }
+    return active_count;
+}
+
+int affinity_restrict_range(int first, int count) {
+    const affinity_plan_t *p = affinity_plan();
+    
+    active_count = 0;
+    for (int i = 0; i < count && i < p->count; i++) {
+        active[active_count++] = (first + i) % p->count;
+    }
+    return active_count;
+}
+
+const char *affinity_core_type_name(affinity_core_type_t type) {
+    switch (type) {
+    case AFFINITY_CORE_PERFORMANCE: return "P";
+    case AFFINITY_CORE_EFFICIENCY: return "E";
+    default: return "any";
+    }
+}
+
+static const cpu_slot_t *find_slot(const affinity_plan_t *p, int cpu) {
+    for (int i = 0; i < p->count; i++) {
+        if (p->slots[i].cpu == cpu) return &p->slots[i];
+    }
+    return NULL;
+}
+
+// "<label>: 0:4 1:4" for the sockets (or nodes) the threads landed on
+static void print_counts(const char *label, const int *cpus, int num_threads, int node) {
+    const affinity_plan_t *p = affinity_plan();
+    int printed[AFFINITY_MAX_CPUS];
+    int num_printed = 0;
+    
+    printf("%s:", label);
+    for (int t = 0; t < num_threads; t++) {
+        const cpu_slot_t *slot = find_slot(p, cpus[t]);
+        int id = slot ? (node ? slot->node : slot->socket) : -1;
+        int seen = 0;
+        for (int i = 0; i < num_printed && !seen; i++) seen = printed[i] == id;
+        if (seen) continue;
+        printed[num_printed++] = id;
+        
+        int threads = 0;
+        for (int u = t; u < num_threads; u++) {
+            const cpu_slot_t *other = find_slot(p, cpus[u]);
+            threads += (other ? (node ? other->node : other->socket) : -1) == id;
+        }
+        if (id < 0) printf(" ?:%d", threads);
+        else printf(" %d:%d", id, threads);
+    }
+    printf("\n");
+}
+
+void affinity_print_map(int num_threads) {
+    const affinity_plan_t *p = affinity_plan();
+    static int cpus[AFFINITY_MAX_CPUS];
+    
+    const char *numa_source = "";
+
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0) numa_source = " (libnuma)";
+#endif
+    if (num_threads > AFFINITY_MAX_CPUS) num_threads = AFFINITY_MAX_CPUS;
+    omp_set_num_threads(num_threads);
+    
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        affinity_bind_thread(t);
+        if (t < AFFINITY_MAX_CPUS) cpus[t] = sched_getcpu();
+    }
+    
+    printf("Affinity: %s, SMT %s, %d CPUs on %d socket(s), %d NUMA node(s)%s\n",
+           affinity_policy_name(p->policy), p->smt ? "on" : "off", p->count, p->sockets, p->nodes,
+           numa_source);
+    printf("Thread map (thread->CPU):");
+    for (int t = 0; t < num_threads; t++) {
+        if (t > 0 && t % 16 == 0) printf("\n                         ");
+        printf(" %d->%d", t, cpus[t]);
+    }
+    printf("\n");
+    print_counts("Threads per socket", cpus, num_threads, 0);
+    print_counts("Threads per NUMA node", cpus, num_threads, 1);
+    
+    if (p->hybrid) {
+        int plan_types[3] = { 0 }, thread_types[3] = { 0 };
+        for (int i = 0; i < p->count; i++) plan_types[p->slots[i].core_type]++;
+        for (int t = 0; t < num_threads; t++) {
+            const cpu_slot_t *slot = find_slot(p, cpus[t]);
+            thread_types[slot ? slot->core_type : AFFINITY_CORE_ANY]++;
+        }
+        printf("Core types (%s): %d P-core CPUs, %d E-core CPUs\n", p->core_type_source,
+               plan_types[AFFINITY_CORE_PERFORMANCE], plan_types[AFFINITY_CORE_EFFICIENCY]);
+        printf("Threads per core type: P:%d E:%d", thread_types[AFFINITY_CORE_PERFORMANCE],
+               thread_types[AFFINITY_CORE_EFFICIENCY]);
+        if (thread_types[AFFINITY_CORE_ANY]) printf(" ?:%d", thread_types[AFFINITY_CORE_ANY]);
+        printf("\n");
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+// Upper bound on CPUs considered for placement
+#define AFFINITY_MAX_CPUS 1024
+
+// Thread placement policies (SISU_AFFINITY)
+typedef enum {
+    AFFINITY_NONE,      // leave placement to the OS / OMP_PLACES
+    AFFINITY_COMPACT,   // fill one socket, core by core, before the next
+    AFFINITY_SCATTER,   // round-robin across sockets, physical cores first
+    AFFINITY_CORES      // one thread per physical core (compact, SMT off)
+} affinity_policy_t;
+
+// Core types of hybrid CPUs (Intel P/E-cores, Arm big.LITTLE)
+typedef enum {
+    AFFINITY_CORE_ANY,          // not hybrid, or the type is unknown
+    AFFINITY_CORE_PERFORMANCE,
+    AFFINITY_CORE_EFFICIENCY
+} affinity_core_type_t;
+
+// One logical CPU the process may run on
+typedef struct {
+    int cpu;        // OS CPU number
+    int socket;     // physical_package_id
+    int core;       // core_id within the socket
+    int smt;        // 0 for the first hardware thread of a core, 1 for its sibling, ...
+    int node;       // NUMA node
+    int core_type;  // affinity_core_type_t
+} cpu_slot_t;
+
+// CPUs in placement order: OpenMP thread i is bound to slots[i % count]
+typedef struct {
+    affinity_policy_t policy;
+    int smt;        // SMT siblings used (SISU_SMT, default on)
+    int count;
+    int sockets;
+    int nodes;
+    int hybrid;                 // both core types present
+    const char *core_type_source;   // "cpu_core/cpu_atom PMU", "CPUID 0x1A", "cpu_capacity" or ""
+    cpu_slot_t slots[AFFINITY_MAX_CPUS];
+} affinity_plan_t;
+
+// Placement plan, built on first use from the allowed CPU set, sysfs
+// topology and libnuma (when built with it). SISU_AFFINITY selects
+// compact|scatter|cores|none; the default is compact, or none when
+// OMP_PLACES / OMP_PROC_BIND is set. SISU_SMT=off drops SMT siblings.
+// Core types come from the hybrid PMU cpu lists, CPUID leaf 0x1A or the
+// sysfs cpu_capacity, in that order.
+const affinity_plan_t *affinity_plan(void);
+
+const char *affinity_policy_name(affinity_policy_t policy);
+
+// Thread count the multithreaded tests should use: the CPUs in the plan
+int affinity_default_threads(void);
+
+// Bind the calling thread to the CPU for OpenMP thread `thread_id`. Call at
+// the top of every parallel region; it is a no-op once the thread is bound.
+void affinity_bind_thread(int thread_id);
+
+// Restrict placement to one socket (-1 for all). Returns the CPUs available.
+int affinity_restrict_socket(int socket);
+
+// Restrict placement to one core type (AFFINITY_CORE_ANY for all). Returns
+// the CPUs available.
+int affinity_restrict_core_type(affinity_core_type_t type);
+
+// Restrict placement to `count` consecutive slots of the plan from `first`
+// (wrapping), so ranks sharing a node get disjoint CPUs. Returns the CPUs
+// available.
+int affinity_restrict_range(int first, int count);
+
+// "P" / "E" / "any"
+const char *affinity_core_type_name(affinity_core_type_t type);
+
+// Run `num_threads` bound threads and print where each actually ran, plus a
+// per-socket / per-node count
+void affinity_print_map(int num_threads);
+
+#endif
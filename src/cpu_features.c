@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+static unsigned long long read_xcr0(void) {
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+void detect_cpu_features(cpu_features_t *features) {
+    memset(features, 0, sizeof(*features));
+    
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    int ymm_enabled = 0;
+    int zmm_enabled = 0;
+    
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return;
+    }
+    
+    features->sse2 = (edx >> 26) & 1;
+    
+    // OSXSAVE: the OS manages extended state, so XCR0 can be queried
+    if ((ecx >> 27) & 1) {
+        unsigned long long xcr0 = read_xcr0();
+        ymm_enabled = (xcr0 & 0x06) == 0x06;   // SSE + AVX state
+        zmm_enabled = (xcr0 & 0xe6) == 0xe6;   // + opmask, ZMM_Hi256, Hi16_ZMM
+    }
+    
+    features->avx = ((ecx >> 28) & 1) && ymm_enabled;
+    features->fma = ((ecx >> 12) & 1) && ymm_enabled;
+    
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        features->avx2 = ((ebx >> 5) & 1) && ymm_enabled;
+        features->avx512f = ((ebx >> 16) & 1) && zmm_enabled;
+    }
+#elif defined(__aarch64__) && defined(__linux__)
+    features->neon = (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#elif defined(__aarch64__)
+    features->neon = 1;  // Advanced SIMD is mandatory on ARMv8-A
+#endif
+}
+
+// Size in bytes of the level-`level` data/unified cache of cpu0, or 0
+static long sysfs_cache_size(int level) {
+    char path[128];
+    
+    for (int index = 0; index < 8; index++) {
+        int cache_level = 0;
+        char type[32] = "";
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        FILE *f = fopen(path, "r");
+        if (!f) break;
+        if (fscanf(f, "%d", &cache_level) != 1) cache_level = 0;
+        fclose(f);
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        f = fopen(path, "r");
+        if (!f) continue;
+        if (fscanf(f, "%31s", type) != 1) type[0] = '\0';
+        fclose(f);
+        
+        if (cache_level != level || strcmp(type, "Instruction") == 0) continue;
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        f = fopen(path, "r");
+        if (!f) continue;
+        long value = 0;
+        char unit = 'B';
+        int fields = fscanf(f, "%ld%c", &value, &unit);
+        fclose(f);
+        if (fields < 1) continue;
+        
+        if (unit == 'K') value *= 1024L;
+        else if (unit == 'M') value *= 1024L * 1024L;
+        return value;
+    }
+    return 0;
+}
+
+void detect_cache_sizes(cache_info_t *caches) {
+    caches->l1d = sysfs_cache_size(1);
+    caches->l2 = sysfs_cache_size(2);
+    caches->l3 = sysfs_cache_size(3);
+    
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    if (caches->l1d <= 0) caches->l1d = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (caches->l2 <= 0) caches->l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (caches->l3 <= 0) caches->l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    
+    if (caches->l1d <= 0) caches->l1d = 32L * 1024L;
+    if (caches->l2 <= 0) caches->l2 = 1024L * 1024L;
+    if (caches->l3 <= 0) caches->l3 = 8L * 1024L * 1024L;
+}
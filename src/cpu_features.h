@@ -0,0 +1,28 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// SIMD features usable by this process: the CPU must implement them and, for
+// AVX/AVX-512, the OS must save the wider register state (XCR0).
+typedef struct {
+    int sse2;
+    int avx;
+    int avx2;
+    int fma;
+    int avx512f;
+    int neon;
+} cpu_features_t;
+
+// Data cache capacities in bytes, as seen by one core (L3 is usually shared)
+typedef struct {
+    long l1d;
+    long l2;
+    long l3;
+} cache_info_t;
+
+// Fill `features` from CPUID/XGETBV on x86 or HWCAP on ARM
+void detect_cpu_features(cpu_features_t *features);
+
+// Fill `caches` from sysfs, then sysconf, then conservative defaults
+void detect_cache_sizes(cache_info_t *caches);
+
+#endif
@@ -0,0 +1,385 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "timing.h"
+#include "daemon.h"
+
+#define DAEMON_DEFAULT_INTERVAL_SECONDS 60.0
+#define DAEMON_MIN_INTERVAL_SECONDS 1.0
+
+// /probe requests closer than this to the last probe return its results
+#define DAEMON_MIN_PROBE_GAP_SECONDS 1.0
+
+// One request at a time: a client gets this long to send its headers
+#define DAEMON_REQUEST_TIMEOUT_MS 2000
+#define DAEMON_REQUEST_BYTES 4096
+
+#define DAEMON_MAX_SERIES 512
+
+// Metric families in /metrics order; names not listed are untyped gauges
+static const struct {
+    const char *name;
+    const char *type;
+    const char *help;
+} families[] = {
+    { "sisu_gflops", "gauge", "Median GFLOPS of the latest probe" },
+    { "sisu_gbps", "gauge", "Median bandwidth of the latest probe in GB/s" },
+    { "sisu_gflops_per_watt", "gauge", "GFLOPS per watt of the latest probe" },
+    { "sisu_trial_seconds", "gauge", "Trial time quantiles of the latest probe" },
+    { "sisu_trial_cv", "gauge", "Coefficient of variation of the latest probe's trials" },
+    { "sisu_trials", "gauge", "Trials in the latest probe" },
+    { "sisu_probes_total", "counter", "Probes run since start-up" },
+    { "sisu_probe_failures_total", "counter", "Probes in which a kernel failed" },
+    { "sisu_probe_duration_seconds", "gauge", "Wall time of the latest probe" },
+    { "sisu_probe_timestamp_seconds", "gauge", "Unix time at the end of the latest probe" },
+};
+#define NUM_FAMILIES (int)(sizeof(families) / sizeof(families[0]))
+
+typedef struct {
+    char name[64];
+    char labels[320];
+    double value;
+} series_t;
+
+static series_t series[DAEMON_MAX_SERIES];
+static int num_series = 0;
+
+static struct {
+    const char *benchmark;
+    daemon_probe_fn probe;
+    void *context;
+    double interval;
+    double next_probe;
+    double last_probe_end;
+    long probes;
+    long failures;
+} state;
+
+static volatile sig_atomic_t stopping = 0;
+
+static void handle_signal(int signal_number) {
+    (void)signal_number;
+    stopping = 1;
+}
+
+// Label value with \, " and newline escaped as the text format requires
+static void escape_label(const char *value, char *out, size_t size) {
+    size_t n = 0;
+    for (const char *p = value; *p && n + 3 < size; p++) {
+        if (*p == '\\' || *p == '"') out[n++] = '\\';
+        if (*p == '\n') {
+            out[n++] = '\\';
+            out[n++] = 'n';
+            continue;
+        }
+        out[n++] = *p;
+    }
+    out[n] = '\0';
+}
+
+static void set_series(const char *name, const char *labels, double value) {
+    for (int i = 0; i < num_series; i++) {
+        if (strcmp(series[i].name, name) == 0 && strcmp(series[i].labels, labels) == 0) {
+            series[i].value = value;
+            return;
+        }
+    }
+    if (num_series >= DAEMON_MAX_SERIES) return;
+    series_t *s = &series[num_series++];
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    snprintf(s->labels, sizeof(s->labels), "%s", labels);
+    s->value = value;
+}
+
+static void kernel_labels(const char *kernel, const char *isa, int threads, char *labels, size_t size) {
+    char benchmark[64], escaped_kernel[64], escaped_isa[128];
+    escape_label(state.benchmark ? state.benchmark : "", benchmark, sizeof(benchmark));
+    escape_label(kernel, escaped_kernel, sizeof(escaped_kernel));
+    escape_label(isa, escaped_isa, sizeof(escaped_isa));
+    snprintf(labels, size, "benchmark=\"%s\",kernel=\"%s\",isa=\"%s\",threads=\"%d\"", benchmark, escaped_kernel,
+             escaped_isa, threads);
+}
+
+void daemon_publish_gauge(const char *kernel, const char *isa, int threads, const char *name, double value) {
+    char labels[300], metric[64];
+    kernel_labels(kernel, isa, threads, labels, sizeof(labels));
+    snprintf(metric, sizeof(metric), "sisu_%.50s", name);
+    set_series(metric, labels, value);
+}
+
+void daemon_publish(const char *kernel, const char *isa, int threads, const char *unit, double rate,
+                    const trial_stats_t *stats) {
+    static const struct {
+        const char *quantile;
+        size_t offset;
+    } quantiles[] = {
+        { "0", offsetof(trial_stats_t, min) },
+        { "0.5", offsetof(trial_stats_t, median) },
+        { "0.95", offsetof(trial_stats_t, p95) },
+        { "1", offsetof(trial_stats_t, max) },
+    };
+    char labels[300], quantile_labels[320];
+    
+    kernel_labels(kernel, isa, threads, labels, sizeof(labels));
+    daemon_publish_gauge(kernel, isa, threads, unit, rate);
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+        snprintf(quantile_labels, sizeof(quantile_labels), "%s,quantile=\"%s\"", labels, quantiles[q].quantile);
+        set_series("sisu_trial_seconds", quantile_labels,
+                   *(const double *)((const char *)stats + quantiles[q].offset));
+    }
+    set_series("sisu_trial_cv", labels, stats->cv);
+    set_series("sisu_trials", labels, stats->count);
+    
+    printf("   %s (%s, %d threads): %.2f %s, median %.6f s, cv %.2f%%, %d trials\n", kernel, isa, threads, rate,
+           strcmp(unit, "gbps") == 0 ? "GB/s" : "GFLOPS", stats->median, stats->cv * 100.0, stats->count);
+}
+
+static void print_family(FILE *out, const char *name, const char *type, const char *help) {
+    if (help) fprintf(out, "# HELP %s %s\n", name, help);
+    fprintf(out, "# TYPE %s %s\n", name, type);
+    for (int i = 0; i < num_series; i++) {
+        if (strcmp(series[i].name, name) != 0) continue;
+        if (series[i].labels[0]) fprintf(out, "%s{%s} %.9g\n", name, series[i].labels, series[i].value);
+        else fprintf(out, "%s %.9g\n", name, series[i].value);
+    }
+}
+
+// Prometheus text exposition format 0.0.4; the caller frees the buffer
+static char *render_metrics(size_t *length) {
+    char *text = NULL;
+    FILE *out = open_memstream(&text, length);
+    if (!out) return NULL;
+    
+    for (int f = 0; f < NUM_FAMILIES; f++) {
+        int present = 0;
+        for (int i = 0; i < num_series && !present; i++) present = strcmp(series[i].name, families[f].name) == 0;
+        if (present) print_family(out, families[f].name, families[f].type, families[f].help);
+    }
+    
+    // Other gauges, each family once in first-published order
+    for (int i = 0; i < num_series; i++) {
+        int known = 0;
+        for (int f = 0; f < NUM_FAMILIES && !known; f++) known = strcmp(series[i].name, families[f].name) == 0;
+        for (int j = 0; j < i && !known; j++) known = strcmp(series[i].name, series[j].name) == 0;
+        if (!known) print_family(out, series[i].name, "gauge", NULL);
+    }
+    fclose(out);
+    return text;
+}
+
+static void run_probe(void) {
+    struct timespec now;
+    char labels[80], benchmark[64];
+    
+    printf("Probe %ld:\n", state.probes + 1);
+    double start_time = get_time();
+    int status = state.probe(state.context);
+    double end_time = get_time();
+    
+    state.probes++;
+    if (status != 0) state.failures++;
+    state.last_probe_end = end_time;
+    state.next_probe = end_time + state.interval;
+    
+    clock_gettime(CLOCK_REALTIME, &now);
+    escape_label(state.benchmark, benchmark, sizeof(benchmark));
+    snprintf(labels, sizeof(labels), "benchmark=\"%s\"", benchmark);
+    set_series("sisu_probes_total", labels, state.probes);
+    set_series("sisu_probe_failures_total", labels, state.failures);
+    set_series("sisu_probe_duration_seconds", labels, end_time - start_time);
+    set_series("sisu_probe_timestamp_seconds", labels, now.tv_sec + now.tv_nsec * 1e-9);
+    
+    printf("   %.2f s%s\n", end_time - start_time, status != 0 ? ", a kernel failed" : "");
+    fflush(stdout);
+}
+
+static void send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return;
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+static void respond(int fd, const char *status, const char *content_type, const char *body, size_t length,
+                    int head) {
+    char header[256];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                     status, content_type, length);
+    send_all(fd, header, (size_t)n);
+    if (!head) send_all(fd, body, length);
+}
+
+// Read the request line and headers (the body, if any, is ignored)
+static int read_request(int fd, char *request, size_t size) {
+    size_t length = 0;
+    double deadline = get_time() + DAEMON_REQUEST_TIMEOUT_MS / 1000.0;
+    
+    while (length + 1 < size) {
+        int remaining_ms = (int)((deadline - get_time()) * 1000.0);
+        struct pollfd p = { fd, POLLIN, 0 };
+        if (remaining_ms <= 0 || poll(&p, 1, remaining_ms) <= 0) return -1;
+        ssize_t received = recv(fd, request + length, size - 1 - length, 0);
+        if (received <= 0) return -1;
+        length += (size_t)received;
+        request[length] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) return 0;
+    }
+    return 0;   // headers longer than the buffer: the request line is enough
+}
+
+static void handle_client(int fd) {
+    static const char index_page[] = "Sisu FLOPS benchmark daemon\n/metrics  latest probe results\n"
+                                     "POST /probe  probe now, then the metrics\n";
+    static const char text_type[] = "text/plain; charset=utf-8";
+    static const char metrics_type[] = "text/plain; version=0.0.4; charset=utf-8";
+    char request[DAEMON_REQUEST_BYTES], method[8], path[256];
+    
+    if (read_request(fd, request, sizeof(request)) != 0) return;
+    if (sscanf(request, "%7s %255s", method, path) != 2) {
+        respond(fd, "400 Bad Request", text_type, "Bad request\n", 12, 0);
+        return;
+    }
+    path[strcspn(path, "?")] = '\0';
+    int head = strcmp(method, "HEAD") == 0;
+    if (!head && strcmp(method, "GET") != 0 && strcmp(method, "POST") != 0) {
+        respond(fd, "405 Method Not Allowed", text_type, "Method not allowed\n", 19, 0);
+        return;
+    }
+    
+    if (strcmp(path, "/") == 0) {
+        respond(fd, "200 OK", text_type, index_page, sizeof(index_page) - 1, head);
+        return;
+    }
+    if (strcmp(path, "/metrics") != 0 && strcmp(path, "/probe") != 0) {
+        respond(fd, "404 Not Found", text_type, "Not found\n", 10, head);
+        return;
+    }
+    // A probe loads every core, so a crawler's or browser's GET must not
+    // start one: only POST does, and POST is for nothing else
+    int probe = strcmp(path, "/probe") == 0;
+    if (probe != (strcmp(method, "POST") == 0)) {
+        respond(fd, "405 Method Not Allowed", text_type, probe ? "Use POST /probe\n" : "Method not allowed\n",
+                probe ? 16 : 19, head);
+        return;
+    }
+    if (probe && get_time() - state.last_probe_end >= DAEMON_MIN_PROBE_GAP_SECONDS) {
+        run_probe();
+    }
+    
+    size_t length = 0;
+    char *metrics = render_metrics(&length);
+    if (!metrics) {
+        respond(fd, "500 Internal Server Error", text_type, "Out of memory\n", 14, head);
+        return;
+    }
+    respond(fd, "200 OK", metrics_type, metrics, length, head);
+    free(metrics);
+}
+
+// "[ADDRESS:]PORT", loopback only without an address; 0.0.0.0 listens on
+// every IPv4 interface
+static int parse_address(const char *text, struct sockaddr_in *address) {
+    char host[64] = "127.0.0.1";
+    const char *port_text = text;
+    const char *colon = strrchr(text, ':');
+    
+    if (colon) {
+        size_t length = (size_t)(colon - text);
+        if (length == 0 || length >= sizeof(host)) return -1;
+        memcpy(host, text, length);
+        host[length] = '\0';
+        port_text = colon + 1;
+    }
+    char *end;
+    long port = strtol(port_text, &end, 10);
+    if (end == port_text || *end != '\0' || port < 1 || port > 65535) return -1;
+    
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_port = htons((unsigned short)port);
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1 ? 0 : -1;
+}
+
+int daemon_requested(void) {
+    const char *setting = getenv("SISU_DAEMON");
+    return setting && setting[0] && strcasecmp(setting, "off") != 0 && strcmp(setting, "0") != 0;
+}
+
+int daemon_run(const char *benchmark, daemon_probe_fn probe, void *context) {
+    const char *setting = getenv("SISU_DAEMON");
+    const char *interval = getenv("SISU_DAEMON_INTERVAL");
+    struct sockaddr_in address;
+    
+    if (!setting || parse_address(setting, &address) != 0) {
+        printf("Invalid daemon address '%s' (expected [ADDRESS:]PORT)\n", setting ? setting : "");
+        return -1;
+    }
+    state.benchmark = benchmark;
+    state.probe = probe;
+    state.context = context;
+    state.interval = interval ? atof(interval) : DAEMON_DEFAULT_INTERVAL_SECONDS;
+    if (state.interval < DAEMON_MIN_INTERVAL_SECONDS) state.interval = DAEMON_MIN_INTERVAL_SECONDS;
+    
+    int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (listener < 0) {
+        printf("Daemon: socket failed: %s\n", strerror(errno));
+        return -1;
+    }
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        printf("Daemon: cannot listen on %s: %s\n", setting, strerror(errno));
+        close(listener);
+        return -1;
+    }
+    
+    // No SA_RESTART: a signal interrupts poll() and ends the loop
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &address.sin_addr, host, sizeof(host));
+    printf("Daemon: serving http://%s:%d/metrics, probe every %.0f s (SISU_DAEMON_INTERVAL) and on /probe\n\n",
+           host, ntohs(address.sin_port), state.interval);
+    
+    run_probe();
+    while (!stopping) {
+        double wait = state.next_probe - get_time();
+        if (wait <= 0.0) {
+            run_probe();
+            continue;
+        }
+        struct pollfd p = { listener, POLLIN, 0 };
+        int ready = poll(&p, 1, (int)(wait * 1000.0) + 1);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+        
+        int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        handle_client(client);
+        close(client);
+    }
+    
+    close(listener);
+    printf("Daemon: stopped after %ld probes\n", state.probes);
+    return 0;
+}
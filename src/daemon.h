@@ -0,0 +1,37 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "stats.h"
+
+// Resident mode (--daemon [ADDRESS:]PORT / SISU_DAEMON): the process stays
+// up, runs a probe at start-up, then every SISU_DAEMON_INTERVAL seconds
+// (default 60) or when /probe is requested, and serves the latest results
+// as Prometheus text on GET /metrics. Probes run on the calling thread
+// between requests, so the benchmark's thread pool and device contexts stay
+// warm and the metric store needs no locking. Without an ADDRESS it listens
+// on 127.0.0.1 only; give 0.0.0.0 (or an interface address) for remote
+// scrapes.
+//
+//     GET /metrics          latest probe results
+//     POST /probe           probe now (at most once a second), then /metrics
+
+// One probe over the benchmark's kernels, publishing with daemon_publish.
+// Returns 0, or -1 if a kernel failed.
+typedef int (*daemon_probe_fn)(void *context);
+
+// Whether --daemon / SISU_DAEMON asks for resident mode
+int daemon_requested(void);
+
+// Serve until SIGINT / SIGTERM. `benchmark` labels every series. Returns 0
+// on shutdown, -1 if the address is invalid or cannot be bound.
+int daemon_run(const char *benchmark, daemon_probe_fn probe, void *context);
+
+// Latest result of one kernel: sisu_<unit> ("gflops" or "gbps") plus the
+// trial statistics (sisu_trial_seconds{quantile}, sisu_trial_cv, sisu_trials)
+void daemon_publish(const char *kernel, const char *isa, int threads, const char *unit, double rate,
+                    const trial_stats_t *stats);
+
+// Any other gauge of the same kernel series (e.g. "gflops_per_watt")
+void daemon_publish_gauge(const char *kernel, const char *isa, int threads, const char *name, double value);
+
+#endif
@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>        // OpenMP
+#include <unistd.h>     // for sysconf
+#include "simd_kernels.h"  // per-ISA DGEMM micro-kernels
+#include "timing.h"        // monotonic clock, warm-up
+#include "affinity.h"      // thread pinning
+#include "options.h"       // --ops, --time, --threads, --kernels, --json
+#include "report.h"
+
+// Matrix sizes, one test each (--kernels dgemm_512,dgemm_1024)
+#define KERNEL_NAMES "dgemm_64,dgemm_128,dgemm_256,dgemm_512,dgemm_1024,dgemm_2048,dgemm_4096"
+#define FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS
+
+// Unless --ops / --time say otherwise, each trial repeats the multiply until
+// this many FLOPs have run
+#define MIN_FLOPS_PER_SIZE 2e9
+
+// Upper bound on the L3-level block width (columns of B packed at once)
+#define DGEMM_NC_MAX 4092
+
+// Entries of C checked against a naive dot product after each size
+#define VERIFY_SAMPLES 32
+
+// Cache blocking in the usual Goto/BLIS loop order: one KC x NR B micro-panel
+// stays in L1, the MC x KC A block in L2, the KC x NC B block in L3
+typedef struct {
+    long long mc;
+    long long kc;
+    long long nc;
+} dgemm_blocking_t;
+
+static long long round_down(long long value, long long multiple) {
+    long long rounded = (value / multiple) * multiple;
+    return rounded < multiple ? multiple : rounded;
+}
+
+static dgemm_blocking_t choose_blocking(const simd_kernels_t *simd, const cache_info_t *caches) {
+    dgemm_blocking_t blocking;
+    
+    blocking.kc = 256;
+    blocking.mc = round_down(caches->l2 / 2 / (blocking.kc * (long long)sizeof(double)), simd->dgemm_mr);
+    blocking.nc = round_down(caches->l3 / 2 / (blocking.kc * (long long)sizeof(double)), DGEMM_NR);
+    if (blocking.nc > DGEMM_NC_MAX) blocking.nc = DGEMM_NC_MAX;
+    
+    return blocking;
+}
+
+// Pack an mc x kc block of column-major A into MR-row panels, zero padded
+static void pack_a(int mr, long long mc, long long kc, const double *a, long long lda, double *packed) {
+    for (long long ir = 0; ir < mc; ir += mr) {
+        for (long long p = 0; p < kc; p++) {
+            for (int i = 0; i < mr; i++) {
+                *packed++ = (ir + i < mc) ? a[(ir + i) + p * lda] : 0.0;
+            }
+        }
+    }
+}
+
+// Pack columns [jr_begin, jr_end) (multiples of NR) of a kc x nc block of
+// column-major B into NR-column panels, zero padded
+static void pack_b_panels(long long jr_begin, long long jr_end, long long nc, long long kc,
+                          const double *b, long long ldb, double *packed) {
+    for (long long jr = jr_begin; jr < jr_end; jr += DGEMM_NR) {
+        double *panel = packed + (jr / DGEMM_NR) * kc * DGEMM_NR;
+        for (long long p = 0; p < kc; p++) {
+            for (int j = 0; j < DGEMM_NR; j++) {
+                *panel++ = (jr + j < nc) ? b[p + (jr + j) * ldb] : 0.0;
+            }
+        }
+    }
+}
+
+// C += A * B for n x n column-major matrices. Threads share each packed B
+// block and split its MC-row macro-tiles, packing their own A blocks.
+static void blocked_dgemm(const simd_kernels_t *simd, const dgemm_blocking_t *blocking, long long n,
+                          const double *a, const double *b, double *c, int num_threads) {
+    const int mr = simd->dgemm_mr;
+    long long nc_max = blocking->nc;
+    long long kc_max = blocking->kc;
+    
+    // Shrink MC for small problems so every thread gets a macro-tile
+    long long mc_max = (n + num_threads - 1) / num_threads;
+    mc_max = ((mc_max + mr - 1) / mr) * mr;
+    if (mc_max > blocking->mc) mc_max = blocking->mc;
+    
+    long long b_panels = (nc_max + DGEMM_NR - 1) / DGEMM_NR;
+    double *b_packed = aligned_alloc(64, b_panels * DGEMM_NR * kc_max * sizeof(double));
+    if (!b_packed) return;
+    
+    omp_set_num_threads(num_threads);
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        double *a_packed = aligned_alloc(64, mc_max * kc_max * sizeof(double));
+        double c_edge[64 * DGEMM_NR];  // partial tiles; dgemm_mr <= 64
+        
+        for (long long jc = 0; jc < n; jc += nc_max) {
+            long long nc = (n - jc < nc_max) ? n - jc : nc_max;
+            long long nc_panels = (nc + DGEMM_NR - 1) / DGEMM_NR;
+            
+            for (long long pc = 0; pc < n; pc += kc_max) {
+                long long kc = (n - pc < kc_max) ? n - pc : kc_max;
+                
+                // Pack B cooperatively; the implicit barrier publishes it
+                #pragma omp for schedule(static)
+                for (long long panel = 0; panel < nc_panels; panel++) {
+                    pack_b_panels(panel * DGEMM_NR, (panel + 1) * DGEMM_NR, nc, kc,
+                                  b + pc + jc * n, n, b_packed);
+                }
+                
+                #pragma omp for schedule(dynamic)
+                for (long long ic = 0; ic < n; ic += mc_max) {
+                    long long mc = (n - ic < mc_max) ? n - ic : mc_max;
+                    if (!a_packed) continue;
+                    
+                    pack_a(mr, mc, kc, a + ic + pc * n, n, a_packed);
+                    
+                    for (long long jr = 0; jr < nc; jr += DGEMM_NR) {
+                        const double *b_panel = b_packed + (jr / DGEMM_NR) * kc * DGEMM_NR;
+                        int nr_valid = (nc - jr < DGEMM_NR) ? (int)(nc - jr) : DGEMM_NR;
+                        
+                        for (long long ir = 0; ir < mc; ir += mr) {
+                            const double *a_panel = a_packed + (ir / mr) * kc * mr;
+                            double *c_tile = c + (ic + ir) + (jc + jr) * n;
+                            int mr_valid = (mc - ir < mr) ? (int)(mc - ir) : mr;
+                            
+                            if (mr_valid == mr && nr_valid == DGEMM_NR) {
+                                simd->dgemm_micro(kc, a_panel, b_panel, c_tile, n);
+                                continue;
+                            }
+                            
+                            // Edge tile: compute into a scratch tile, add the valid part
+                            memset(c_edge, 0, sizeof(double) * mr * DGEMM_NR);
+                            simd->dgemm_micro(kc, a_panel, b_panel, c_edge, mr);
+                            for (int j = 0; j < nr_valid; j++) {
+                                for (int i = 0; i < mr_valid; i++) {
+                                    c_tile[i + j * n] += c_edge[i + j * mr];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        
+        free(a_packed);
+    }
+    
+    free(b_packed);
+}
+
+// One trial of the timed loop: multiplies accumulating into C until
+// `flops` have run (a multiple of one multiply, for --time calibration)
+typedef struct {
+    const simd_kernels_t *simd;
+    const dgemm_blocking_t *blocking;
+    long long n;
+    const double *a;
+    const double *b;
+    double *c;
+    int num_threads;
+} dgemm_run_t;
+
+static double dgemm_calls(long long flops, void *context) {
+    const dgemm_run_t *run = context;
+    long long calls = flops / (2 * run->n * run->n * run->n);
+    double start_time = get_time();
+    for (long long r = 0; r < calls; r++) {
+        blocked_dgemm(run->simd, run->blocking, run->n, run->a, run->b, run->c, run->num_threads);
+    }
+    return get_time() - start_time;
+}
+
+// Largest relative error of sampled C entries against naive dot products
+static double verify_dgemm(long long n, const double *a, const double *b, const double *c) {
+    double max_error = 0.0;
+    unsigned int seed = 12345;
+    
+    for (int s = 0; s < VERIFY_SAMPLES; s++) {
+        seed = seed * 1103515245u + 12345u;
+        long long i = (seed >> 8) % n;
+        seed = seed * 1103515245u + 12345u;
+        long long j = (seed >> 8) % n;
+        
+        double expected = 0.0;
+        for (long long p = 0; p < n; p++) {
+            expected += a[i + p * n] * b[p + j * n];
+        }
+        double error = fabs(c[i + j * n] - expected) / (fabs(expected) > 1e-30 ? fabs(expected) : 1.0);
+        if (error > max_error) max_error = error;
+    }
+    
+    return max_error;
+}
+
+int main(int argc, char **argv) {
+    bench_options_t opts;
+    int status = options_parse(argc, argv, KERNEL_NAMES, FLAG_NAMES, &opts);
+    if (status) return status < 0;
+    report_begin("dgemm", opts.format);
+    
+    int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = opts.threads > 0 ? opts.threads : affinity_default_threads();
+    const long long sizes[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+    const int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    const simd_kernels_t *simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    if (!simd) {
+        printf("No supported SIMD instruction set found\n");
+        return 1;
+    }
+    
+    cache_info_t caches;
+    detect_cache_sizes(&caches);
+    dgemm_blocking_t blocking = choose_blocking(simd, &caches);
+    
+    // Reference peak: the multi-accumulator FMA kernel on all cores, median
+    // of warmed-up trials
+    long long peak_operations = 400000000LL;
+    trial_stats_t peak_stats;
+    measure_simd_peak(simd, peak_operations, num_threads, &peak_stats);
+    double peak_flops = kernel_flops(simd->peak_flops, peak_operations);
+    double peak_gflops = (peak_flops / peak_stats.median) / 1e9;
+    
+    printf("=== DGEMM Benchmark ===\n");
+    printf("Available cores: %d\n", num_cores);
+    printf("SIMD kernels: %s, micro-tile %dx%d\n", simd->name, simd->dgemm_mr, DGEMM_NR);
+    printf("Blocking: MC=%lld KC=%lld NC=%lld\n", blocking.mc, blocking.kc, blocking.nc);
+    affinity_print_map(num_threads);
+    printf("Peak (multi-accumulator FMA kernel): %.2f GFLOPS\n", peak_gflops);
+    print_trial_stats("   ", &peak_stats);
+    printf("\n");
+    
+    printf("%8s %8s %12s %12s %10s %7s %12s\n", "N", "Calls", "Time (s)", "GFLOPS", "% peak", "CV",
+           "Max rel err");
+    
+    double best_gflops = 0.0;
+    int failures = 0;
+    
+    for (int s = 0; s < num_sizes; s++) {
+        long long n = sizes[s];
+        size_t bytes = n * n * sizeof(double);
+        char name[32];
+        
+        snprintf(name, sizeof(name), "dgemm_%lld", n);
+        if (!options_kernel_selected(&opts, name)) continue;
+        double *a = aligned_alloc(64, bytes);
+        double *b = aligned_alloc(64, bytes);
+        double *c = aligned_alloc(64, bytes);
+        if (!a || !b || !c) {
+            printf("%8lld %12s\n", n, "alloc failed");
+            free(a);
+            free(b);
+            free(c);
+            continue;
+        }
+        
+        for (long long i = 0; i < n * n; i++) {
+            a[i] = 1.0 / (1 + i % 7);
+            b[i] = 1.0 / (2 + i % 5);
+        }
+        
+        long long flops = 2 * n * n * n;
+        long long fallback = (long long)(MIN_FLOPS_PER_SIZE / flops);
+        if (fallback < 1) fallback = 1;
+        dgemm_run_t run = { simd, &blocking, n, a, b, c, num_threads };
+        warmup_t warmup;
+        
+        memset(c, 0, bytes);
+        for (warmup_start(&warmup); warmup_running(&warmup); ) {
+            dgemm_calls(flops, &run);
+        }
+        long long calls = options_operations(&opts, dgemm_calls, &run, flops, fallback * flops) / flops;
+        
+        trial_set_t trials;
+        trial_stats_t stats;
+        for (trials_begin(&trials); trials_continue(&trials); ) {
+            trials_add(&trials, dgemm_calls(calls * flops, &run));
+        }
+        trials_summarize(&trials, &stats);
+        
+        // The trials accumulated into C; check one clean multiply
+        memset(c, 0, bytes);
+        dgemm_calls(flops, &run);
+        double error = verify_dgemm(n, a, b, c);
+        double gflops = ((double)flops * calls / stats.median) / 1e9;
+        if (error > 1e-10) failures++;
+        if (gflops > best_gflops) best_gflops = gflops;
+        
+        printf("%8lld %8lld %12.6f %12.2f %9.1f%% %6.2f%% %12.2e%s\n", n, calls, stats.median / calls, gflops,
+               100.0 * gflops / peak_gflops, 100.0 * stats.cv, error, error > 1e-10 ? "  FAILED" : "");
+        report_add(name, simd->name, num_threads, (double)calls, (double)flops * calls, &stats);
+        
+        free(a);
+        free(b);
+        free(c);
+    }
+    
+    // Summary
+    printf("\n=== DGEMM Summary ===\n");
+    printf("Best DGEMM: %.2f GFLOPS (%.1f%% of peak)\n", best_gflops, 100.0 * best_gflops / peak_gflops);
+    if (failures) printf("Verification FAILED for %d size(s)\n", failures);
+    report_finish();
+    
+    return failures != 0;
+}
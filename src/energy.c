@@ -0,0 +1,262 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "timing.h"
+#include "energy.h"
+
+// RAPL updates about once a millisecond; shorter windows are mostly noise
+#define ENERGY_MIN_SECONDS 0.01
+
+typedef enum {
+    DOMAIN_PACKAGE,     // whole socket
+    DOMAIN_PART,        // core / uncore / gpu, already inside a package
+    DOMAIN_DRAM,
+    DOMAIN_PLATFORM     // psys: the whole SoC / platform
+} domain_kind_t;
+
+typedef struct {
+    char name[32];
+    domain_kind_t kind;
+    char path[200];     // powercap energy_uj; empty for perf events
+    double range_uj;    // powercap counter wrap-around
+    int fd;             // perf event, -1 for powercap
+    double scale;       // joules per perf count
+    double start;       // reading at energy_start (uJ or counts)
+} domain_t;
+
+static domain_t domains[ENERGY_MAX_DOMAINS];
+static int num_domains = 0;
+static int probed = 0;
+static const char *source = "";
+static const char *unavailable_reason = "";
+static char reason_text[128];
+static double window_start = 0.0;
+
+static int read_double(const char *path, double *value) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fscanf(f, "%lf", value) == 1;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+static int read_line(const char *path, char *text, size_t size) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fgets(text, (int)size, f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+    text[strcspn(text, "\n")] = '\0';
+    return 0;
+}
+
+static domain_kind_t domain_kind(const char *name) {
+    if (strncmp(name, "package", 7) == 0) return DOMAIN_PACKAGE;
+    if (strncmp(name, "dram", 4) == 0) return DOMAIN_DRAM;
+    if (strncmp(name, "psys", 4) == 0) return DOMAIN_PLATFORM;
+    return DOMAIN_PART;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(((const domain_t *)a)->path, ((const domain_t *)b)->path);
+}
+
+// Zones intel-rapl:P (packages) and intel-rapl:P:S (their subzones); the
+// MMIO copy of the package counter is skipped. Returns the zones found,
+// readable or not.
+static int probe_powercap(void) {
+    DIR *dir = opendir("/sys/class/powercap");
+    int found = 0;
+    if (!dir) return 0;
+    
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL && num_domains < ENERGY_MAX_DOMAINS; ) {
+        char path[200], name[32];
+        int package, subzone;
+        double value;
+        if (strncmp(entry->d_name, "intel-rapl:", 11) != 0) continue;
+        if (sscanf(entry->d_name + 11, "%d:%d", &package, &subzone) < 1) continue;
+        found++;
+        
+        snprintf(path, sizeof(path), "/sys/class/powercap/%.32s/name", entry->d_name);
+        if (read_line(path, name, sizeof(name)) != 0) continue;
+        snprintf(path, sizeof(path), "/sys/class/powercap/%.32s/energy_uj", entry->d_name);
+        if (read_double(path, &value) != 0) continue;     // root-only on current kernels
+        
+        domain_t *d = &domains[num_domains++];
+        if (strchr(entry->d_name + 11, ':')) snprintf(d->name, sizeof(d->name), "%.20s-%d", name, package);
+        else snprintf(d->name, sizeof(d->name), "%.31s", name);
+        d->kind = domain_kind(d->name);
+        snprintf(d->path, sizeof(d->path), "%s", path);
+        snprintf(path, sizeof(path), "/sys/class/powercap/%.32s/max_energy_range_uj", entry->d_name);
+        if (read_double(path, &d->range_uj) != 0) d->range_uj = 0.0;
+        d->fd = -1;
+        d->scale = 1e-6;
+    }
+    closedir(dir);
+    
+    qsort(domains, num_domains, sizeof(domains[0]), compare_paths);
+    return found;
+}
+
+// The perf "power" PMU: one event per package CPU listed in its cpumask
+static void probe_perf(void) {
+    static const struct {
+        const char *event;
+        const char *name;
+    } events[] = {
+        { "energy-pkg", "package" }, { "energy-cores", "core" }, { "energy-gpu", "gpu" },
+        { "energy-ram", "dram" }, { "energy-psys", "psys" },
+    };
+    const char *pmu = "/sys/bus/event_source/devices/power";
+    char path[160], text[256];
+    double type;
+    int cpus[ENERGY_MAX_DOMAINS], num_cpus = 0;
+    
+    snprintf(path, sizeof(path), "%s/type", pmu);
+    if (read_double(path, &type) != 0) return;
+    snprintf(path, sizeof(path), "%s/cpumask", pmu);
+    if (read_line(path, text, sizeof(text)) != 0) return;
+    for (char *p = text; *p && num_cpus < ENERGY_MAX_DOMAINS; ) {
+        char *end;
+        long first = strtol(p, &end, 10), last = first;
+        if (end == p) break;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+        for (long cpu = first; cpu <= last && num_cpus < ENERGY_MAX_DOMAINS; cpu++) cpus[num_cpus++] = (int)cpu;
+        p = *end == ',' ? end + 1 : end;
+    }
+    
+    for (size_t e = 0; e < sizeof(events) / sizeof(events[0]); e++) {
+        unsigned config;
+        double scale;
+        snprintf(path, sizeof(path), "%s/events/%s", pmu, events[e].event);
+        if (read_line(path, text, sizeof(text)) != 0 || sscanf(text, "event=%x", &config) != 1) continue;
+        snprintf(path, sizeof(path), "%s/events/%s.scale", pmu, events[e].event);
+        if (read_double(path, &scale) != 0) continue;
+        
+        // psys covers the whole platform: count it once
+        int sockets = strcmp(events[e].name, "psys") == 0 ? 1 : num_cpus;
+        for (int s = 0; s < sockets && num_domains < ENERGY_MAX_DOMAINS; s++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = (uint32_t)type;
+            attr.config = config;
+            int fd = (int)syscall(SYS_perf_event_open, &attr, -1, cpus[s], -1, 0);
+            if (fd < 0) {
+                snprintf(reason_text, sizeof(reason_text), "unavailable (perf power PMU: %s)", strerror(errno));
+                unavailable_reason = reason_text;
+                continue;
+            }
+            
+            domain_t *d = &domains[num_domains++];
+            if (sockets == 1) {
+                snprintf(d->name, sizeof(d->name), "%s", events[e].name);
+            } else {
+                snprintf(d->name, sizeof(d->name), "%s-%d", events[e].name, s);
+            }
+            d->kind = domain_kind(d->name);
+            d->path[0] = '\0';
+            d->range_uj = 0.0;
+            d->fd = fd;
+            d->scale = scale;
+        }
+    }
+}
+
+static void probe(void) {
+    const char *setting = getenv("SISU_ENERGY");
+    
+    probed = 1;
+    if (setting && (strcasecmp(setting, "off") == 0 || strcmp(setting, "0") == 0)) {
+        unavailable_reason = "disabled (SISU_ENERGY=off)";
+        return;
+    }
+    
+    int zones = probe_powercap();
+    if (num_domains > 0) {
+        source = "RAPL via powercap";
+        return;
+    }
+    unavailable_reason = zones > 0 ? "unavailable (powercap energy_uj not readable, needs root)"
+                                   : "unavailable (no RAPL powercap zones or power PMU)";
+    probe_perf();
+    if (num_domains > 0) source = "RAPL via perf power PMU";
+}
+
+static double read_domain(const domain_t *d) {
+    if (d->fd >= 0) {
+        uint64_t count;
+        return read(d->fd, &count, sizeof(count)) == (ssize_t)sizeof(count) ? (double)count : d->start;
+    }
+    double value;
+    return read_double(d->path, &value) == 0 ? value : d->start;
+}
+
+int energy_domains(void) {
+    if (!probed) probe();
+    return num_domains;
+}
+
+const char *energy_domain_name(int domain) {
+    return domain >= 0 && domain < num_domains ? domains[domain].name : "";
+}
+
+void energy_start(void) {
+    if (!probed) probe();
+    for (int i = 0; i < num_domains; i++) domains[i].start = read_domain(&domains[i]);
+    window_start = get_time();
+}
+
+void energy_stop(energy_sample_t *sample) {
+    double packages = 0.0, dram = 0.0, platform = 0.0;
+    
+    memset(sample, 0, sizeof(*sample));
+    sample->seconds = get_time() - window_start;
+    for (int i = 0; i < num_domains; i++) {
+        domain_t *d = &domains[i];
+        double delta = read_domain(d) - d->start;
+        if (delta < 0.0) delta += d->range_uj;  // powercap counter wrapped
+        sample->joules[i] = delta * d->scale;
+        if (d->kind == DOMAIN_PACKAGE) packages += sample->joules[i];
+        else if (d->kind == DOMAIN_DRAM) dram += sample->joules[i];
+        else if (d->kind == DOMAIN_PLATFORM) platform += sample->joules[i];
+    }
+    sample->total = packages + dram > 0.0 ? packages + dram : platform;
+    sample->valid = num_domains > 0 && sample->seconds >= ENERGY_MIN_SECONDS && sample->total > 0.0;
+}
+
+void energy_print_status(void) {
+    if (!probed) probe();
+    if (num_domains == 0) {
+        printf("Energy: %s\n", unavailable_reason);
+        return;
+    }
+    printf("Energy: %s (", source);
+    for (int i = 0; i < num_domains; i++) printf("%s%s", i ? ", " : "", domains[i].name);
+    printf(")\n");
+}
+
+double energy_gflops_per_watt(const energy_sample_t *sample, double flops) {
+    // GFLOPS / W = GFLOP / J
+    return sample->valid ? flops / sample->total / 1e9 : 0.0;
+}
+
+void energy_print(const char *indent, const energy_sample_t *sample, double flops) {
+    if (!sample->valid) return;
+    
+    printf("%sEnergy: %.3f J over %.3f s, %.2f W (", indent, sample->total, sample->seconds,
+           sample->total / sample->seconds);
+    for (int i = 0; i < num_domains; i++) {
+        printf("%s%s %.2f W", i ? ", " : "", domains[i].name, sample->joules[i] / sample->seconds);
+    }
+    printf(")\n");
+    if (flops > 0.0) printf("%sEfficiency: %.3f GFLOPS/W\n", indent, energy_gflops_per_watt(sample, flops));
+}
@@ -0,0 +1,36 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+// CPU energy around timed regions from RAPL: the powercap sysfs counters
+// (intel-rapl, also used for AMD), else the perf "power" PMU, which reads
+// the same energy-status MSRs in the kernel. Both are usually root-only.
+// SISU_ENERGY=off disables the readings.
+
+#define ENERGY_MAX_DOMAINS 16
+
+// Energy of one start/stop window, per domain in energy_domain_name() order
+typedef struct {
+    int valid;
+    double seconds;
+    double joules[ENERGY_MAX_DOMAINS];
+    double total;       // packages + DRAM (platform domain if neither exists)
+} energy_sample_t;
+
+// Number of domains read (0 if RAPL is unavailable) and their names
+// ("package-0", "core", "dram", ...)
+int energy_domains(void);
+const char *energy_domain_name(int domain);
+
+void energy_start(void);
+void energy_stop(energy_sample_t *sample);
+
+// One header line: the energy source and its domains, or why there is none
+void energy_print_status(void);
+
+// Joules, average watts per domain and GFLOPS/W for `flops` retired in the window
+void energy_print(const char *indent, const energy_sample_t *sample, double flops);
+
+// GFLOPS per watt of the window's total energy, 0 without a valid reading
+double energy_gflops_per_watt(const energy_sample_t *sample, double flops);
+
+#endif
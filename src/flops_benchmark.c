@@ -1,44 +1,112 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
+#include "timing.h"
+#include "stats.h"
+#include "report.h"
+#include "options.h"
+#include "perf_counters.h"
+#include "verify.h"
 
-double get_time() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec / 1000000.0;
-}
+// Iterations per warm-up pass
+#define WARMUP_OPERATIONS 1000000LL
 
-int main() {
-    const long long operations = 100000000LL; // 100 million operations
-    volatile double a = 1.23456789;
-    volatile double b = 9.87654321;
-    volatile double result = 0.0;
-    
-    printf("Running floating-point benchmark...\n");
-    printf("Operations: %lld\n", operations);
+// Operations per trial without --ops / --time
+#define DEFAULT_OPERATIONS 50000000LL
+
+static volatile double a;
+static volatile double b;
+static volatile double result;
+static double steps;
+
+// Run the dependent multiply-add chain; returns elapsed seconds
+static double flops_loop(long long operations) {
+    a = 1.23456789;
+    b = 9.87654321;
+    result = chain_start(a, b);
+    double counted = 0.0;
     
     double start_time = get_time();
     
-    // Perform floating-point operations
     for (long long i = 0; i < operations; i++) {
         result = a * b + result;
-        a = result * 0.999999;
-        b = a + 1.000001;
+        a = result * CHAIN_MULTIPLIER;
+        b = a + CHAIN_ADDEND;
+        counted += 1.0;
+    }
+    
+    double elapsed = get_time() - start_time;
+    steps = counted;
+    return elapsed;
+}
+
+static double timed_loop(long long operations, void *context) {
+    (void)context;
+    return flops_loop(operations);
+}
+
+int main(int argc, char **argv) {
+    bench_options_t opts;
+    int status = options_parse(argc, argv, "scalar", OPTIONS_TRIAL_FLAGS ",perf", &opts);
+    if (status) return status < 0;
+    if (opts.threads > 1) {
+        fprintf(stderr, "basic_benchmark is single-threaded; use vectorized_benchmark --threads\n");
+        return 1;
     }
+    report_begin("basic", opts.format);
     
-    double end_time = get_time();
-    double elapsed = end_time - start_time;
+    printf("Running floating-point benchmark...\n");
+    printf("Timer: monotonic clock (%.0f ns resolution), %s at %.3f GHz, warm-up %.0f ms\n",
+           get_time_resolution() * 1e9, cycle_counter_name(), cycle_counter_hz() / 1e9,
+           warmup_seconds() * 1000.0);
+    perf_print_status();
+    
+    // Same loop, briefly, so clocks and caches settle before timing
+    warmup_t warmup;
+    for (warmup_start(&warmup); warmup_running(&warmup); ) {
+        flops_loop(WARMUP_OPERATIONS);
+    }
+    
+    const long long operations = options_operations(&opts, timed_loop, NULL, 1, DEFAULT_OPERATIONS);
+    printf("Operations per trial: %lld", operations);
+    if (opts.target_seconds > 0.0) printf(" (calibrated for %.3f s)", opts.target_seconds);
+    printf("\n");
+    
+    // Repeat until the trial times are stable (see stats.h)
+    trial_set_t trials;
+    trial_stats_t stats;
+    perf_sample_t perf;
+    perf_open(PERF_EVENTS_COMPUTE, 1);
+    perf_start();
+    unsigned long long cycles = read_cycles();
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, flops_loop(operations));
+    }
+    cycles = read_cycles() - cycles;
+    perf_stop(&perf);
+    perf_close();
+    trials_summarize(&trials, &stats);
+    double elapsed = stats.median;
+    double cycles_per_trial = (double)cycles / stats.count;
     
     // Each loop iteration performs 4 floating-point operations:
     // 1 multiplication, 1 addition, 1 multiplication, 1 addition
-    double total_flops = operations * 4.0;
+    double total_flops = kernel_flops(SCALAR_CHAIN_FLOPS, operations);
+    double expected = verify_chain_reference(operations, 1, 1);
+    int verified = verify_checksum(result, expected);
     double mflops = (total_flops / elapsed) / 1000000.0;
     
-    printf("Elapsed time: %.6f seconds\n", elapsed);
+    printf("Elapsed time: %.6f seconds (median of %d trials)\n", elapsed, stats.count);
+    print_trial_stats("", &stats);
+    printf("Reference cycles: %.0f per trial (%.2f FLOPs/cycle)\n", cycles_per_trial, total_flops / cycles_per_trial);
     printf("Total FLOPS: %.0f\n", total_flops);
     printf("MFLOPS: %.2f\n", mflops);
-    printf("Result (to prevent optimization): %f\n", result);
+    perf_print("", &perf, total_flops * stats.count);
+    verify_print("", result, expected, verified);
+    if (!verify_chain_steps("", steps, total_flops)) verified = 0;
+    
+    report_add("scalar", "scalar", 1, operations, total_flops, &stats);
+    report_set_checksum(result, expected, verified);
+    report_finish();
     
-    return 0;
+    return verified == 0;
 }
@@ -2,96 +2,436 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <errno.h>
+#include <strings.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <CL/cl.h>
+#include "timing.h"
+#include "stats.h"
+#include "report.h"
+#include "options.h"
+#include "energy.h"
+#include "daemon.h"
+#ifdef HAVE_HOST_KERNELS
+#include "simd_kernels.h"   // host peak kernel for the CPU+GPU co-run
+#include "affinity.h"
+#endif
 
-double get_time() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec / 1000000.0;
-}
-
+// Kernel template, specialized per build with -D REAL=<float|double|half>,
+// -D REALN=<vector type> and -D VEC_SUM=SUM<lanes>; USE_FP64 / USE_FP16
+// enable the extension the type needs
 const char *kernel_source = 
+"#ifdef USE_FP64\n"
+"#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+"#endif\n"
+"#ifdef USE_FP16\n"
+"#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n"
+"#endif\n"
+"\n"
 "__kernel void flops_kernel(__global float* results, const int operations_per_work_item) {\n"
 "    int gid = get_global_id(0);\n"
-"    float a = 1.23456f + gid * 0.001f;\n"
-"    float b = 9.87654f + gid * 0.001f;\n"
-"    float result = 0.0f;\n"
+"    REAL a = (REAL)(1.23456f + gid * 0.001f);\n"
+"    REAL b = (REAL)(9.87654f + gid * 0.001f);\n"
+"    REAL result = (REAL)0.0f;\n"
 "    \n"
 "    for (int i = 0; i < operations_per_work_item; i++) {\n"
 "        result = fma(a, b, result);  // fused multiply-add\n"
-"        a = result * 0.999999f;\n"
-"        b = a + 1.000001f;\n"
+"        a = result * (REAL)0.999999f;\n"
+"        b = a + (REAL)1.000001f;\n"
+"    }\n"
+"    \n"
+"    results[gid] = (float)result;\n"
+"}\n"
+"\n"
+"// Peak throughput: PEAK_ACCUMULATORS independent vector FMA chains per work\n"
+"// item hide the FMA latency. x = x * m + c converges to 1, so every type\n"
+"// (half included) stays finite.\n"
+"#define PEAK_ACCUMULATORS 8\n"
+"#define SPLAT(x) ((REALN)((REAL)(x)))\n"
+"#define SUM1(v) (v)\n"
+"#define SUM2(v) ((v).s0 + (v).s1)\n"
+"#define SUM4(v) SUM2((v).lo + (v).hi)\n"
+"#define SUM8(v) SUM4((v).lo + (v).hi)\n"
+"\n"
+"__kernel void peak_kernel(__global float* results, const int operations_per_work_item) {\n"
+"    int gid = get_global_id(0);\n"
+"    REALN x0 = SPLAT(gid * 1e-6f), x1 = x0 + SPLAT(0.1f), x2 = x0 + SPLAT(0.2f);\n"
+"    REALN x3 = x0 + SPLAT(0.3f), x4 = x0 + SPLAT(0.4f), x5 = x0 + SPLAT(0.5f);\n"
+"    REALN x6 = x0 + SPLAT(0.6f), x7 = x0 + SPLAT(0.7f);\n"
+"    const REALN m = SPLAT(0.999f);\n"
+"    const REALN c = SPLAT(0.001f);\n"
+"    \n"
+"    for (int i = 0; i < operations_per_work_item; i++) {\n"
+"        x0 = fma(x0, m, c); x1 = fma(x1, m, c);\n"
+"        x2 = fma(x2, m, c); x3 = fma(x3, m, c);\n"
+"        x4 = fma(x4, m, c); x5 = fma(x5, m, c);\n"
+"        x6 = fma(x6, m, c); x7 = fma(x7, m, c);\n"
 "    }\n"
 "    \n"
-"    results[gid] = result;\n"
+"    REALN sum = ((x0 + x1) + (x2 + x3)) + ((x4 + x5) + (x6 + x7));\n"
+"    results[gid] = (float)VEC_SUM(sum);\n"
 "}\n";
 
-int main() {
-    cl_platform_id platform;
+// Element types kernel_source is specialized for
+typedef struct {
+    const char *type;       // -D REAL
+    const char *label;
+    const char *extension;  // device extension the type needs, NULL: core
+    const char *define;     // enables the extension pragma
+} gpu_precision_t;
+
+enum { PRECISION_FP32, PRECISION_FP64, PRECISION_FP16, NUM_PRECISIONS };
+
+static const gpu_precision_t precisions[NUM_PRECISIONS] = {
+    { "float", "FP32", NULL, NULL },
+    { "double", "FP64", "cl_khr_fp64", "USE_FP64" },
+    { "half", "FP16", "cl_khr_fp16", "USE_FP16" },
+};
+
+// Specializations of kernel_source, in run order
+typedef struct {
+    const char *name;
+    const char *title;
+    const char *function;           // kernel in kernel_source
+    int precision;
+    int width;                      // REALN lanes, 1 = scalar
+    double flops_per_iteration;     // per work item
+} gpu_kernel_t;
+
+static const gpu_kernel_t gpu_kernels[] = {
+    // FMA + mul + add
+    { "flops_kernel", "Latency-bound FMA chain (float)", "flops_kernel", PRECISION_FP32, 1, 4.0 },
+    { "peak_float4", "Peak throughput (float4, 8 accumulators)", "peak_kernel", PRECISION_FP32, 4, 8 * 4 * 2.0 },
+    { "peak_float8", "Peak throughput (float8, 8 accumulators)", "peak_kernel", PRECISION_FP32, 8, 8 * 8 * 2.0 },
+    { "flops_double", "Latency-bound FMA chain (double)", "flops_kernel", PRECISION_FP64, 1, 4.0 },
+    { "peak_double4", "Peak throughput (double4, 8 accumulators)", "peak_kernel", PRECISION_FP64, 4, 8 * 4 * 2.0 },
+    { "flops_half", "Latency-bound FMA chain (half)", "flops_kernel", PRECISION_FP16, 1, 4.0 },
+    { "peak_half2", "Peak throughput (packed half2, 8 accumulators)", "peak_kernel", PRECISION_FP16, 2, 8 * 2 * 2.0 },
+    { "peak_half8", "Peak throughput (half8, 8 accumulators)", "peak_kernel", PRECISION_FP16, 8, 8 * 8 * 2.0 },
+};
+#define NUM_GPU_KERNELS (int)(sizeof(gpu_kernels) / sizeof(gpu_kernels[0]))
+
+// Launch geometry tuning (--tune on) sweeps the local size in steps of
+// CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE and the work-groups per
+// compute unit with this kernel, then the operations per work item
+#define TUNE_KERNEL 1                       // peak_float4
+#define TUNE_TRIALS 3
+#define TUNE_OPERATIONS 4096LL              // per work item in the geometry sweep
+#define TUNE_MAX_GROUPS_PER_CU 16
+#define TUNE_MIN_OPERATIONS 1024LL
+#define TUNE_MIN_LAUNCH_SECONDS 0.01        // keeps trials well above timer noise
+#define TUNE_MAX_LAUNCH_SECONDS 0.2
+#define TUNE_TOLERANCE 0.02                 // shortest launch within 2% of the best
+#define TUNE_CACHE_FILE "gpu_tuning.tsv"
+
+// Host-device transfer tests, run after the kernels
+typedef enum {
+    TRANSFER_H2D_PAGEABLE,      // clEnqueueWriteBuffer from malloc memory
+    TRANSFER_H2D_PINNED,        // ... from a mapped CL_MEM_ALLOC_HOST_PTR buffer
+    TRANSFER_H2D_MAP,           // map, memcpy, unmap (zero copy on shared memory)
+    TRANSFER_D2H_PAGEABLE,
+    TRANSFER_D2H_PINNED,
+    TRANSFER_D2H_MAP,
+    TRANSFER_D2D,               // clEnqueueCopyBuffer between device buffers, read + write bytes
+    NUM_TRANSFER_MODES
+} transfer_mode_t;
+
+static const char *transfer_names[NUM_TRANSFER_MODES] = {
+    "h2d_pageable", "h2d_pinned", "h2d_map", "d2h_pageable", "d2h_pinned", "d2h_map", "d2d",
+};
+
+#define GPU_KERNEL_NAMES "flops_kernel,peak_float4,peak_float8,flops_double,peak_double4," \
+                         "flops_half,peak_half2,peak_half8,transfer,latency,overlap"
+#define GPU_FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS ",tune,binary-cache,energy," \
+                       "daemon,daemon-interval,hetero"
+
+// Transfer sweep: 4 KiB to 64 MiB in steps of 4x, batched so each trial
+// moves at least TRANSFER_BATCH_BYTES
+#define TRANSFER_MIN_BYTES ((size_t)4 << 10)
+#define TRANSFER_MAX_BYTES ((size_t)64 << 20)
+#define TRANSFER_BATCH_BYTES ((size_t)64 << 20)
+
+// Small-transfer latency: LATENCY_BATCH blocking transfers of LATENCY_BYTES
+#define LATENCY_BYTES 4
+#define LATENCY_BATCH 100
+
+// Work items per compute unit and FMA-chain iterations per work item without
+// --threads / --ops / --time; peak kernels get the same FLOP budget
+#define DEFAULT_WORK_ITEMS_PER_CU 256
+#define DEFAULT_OPERATIONS_PER_WORK_ITEM 1000000LL
+
+// NVML and hwmon energy counters need windows of at least this long
+#define GPU_ENERGY_MIN_SECONDS 0.01
+
+// Daemon probes (--daemon) aim for trials this long unless --ops / --time
+// is given; the first probe calibrates, later ones reuse its count
+#define GPU_DAEMON_PROBE_SECONDS 0.05
+
+// Iterations per warm-up launch
+#define WARMUP_OPERATIONS_PER_WORK_ITEM 1000LL
+
+// Device enumeration limits
+#define MAX_GPU_PLATFORMS 8
+#define MAX_GPU_DEVICES 16
+
+// Fastest kernel of one precision on one device
+typedef struct {
+    int kernel;                         // gpu_kernels index, -1: none run
+    double mflops;
+    long long operations_per_work_item;
+    trial_stats_t stats;                // kernel seconds
+    double gflops_per_watt;             // 0: no energy reading
+} kernel_result_t;
+
+// One OpenCL device with its own context, profiling queue and result buffer
+typedef struct {
     cl_device_id device;
+    char name[256];
+    char platform[128];
+    char isa[64];                       // "opencl <device>" for records
+    int is_cpu;
+    cl_uint compute_units;
+    size_t max_work_group_size;
+    size_t timer_resolution;
+    cl_ulong max_alloc;                 // CL_DEVICE_MAX_MEM_ALLOC_SIZE
+    int supported[NUM_PRECISIONS];
     cl_context context;
     cl_command_queue queue;
-    cl_program program;
-    cl_kernel kernel;
     cl_mem buffer;
-    cl_int err;
+    size_t global_work_size;
+    size_t local_work_size;             // 0: chosen by the runtime
+    long long tuned_operations;         // per work item of TUNE_KERNEL, 0: not tuned
+    kernel_result_t best[NUM_PRECISIONS];
+    double transfer_gbps[NUM_TRANSFER_MODES];   // best over the size sweep
+    double latency_us[2];                       // H2D, D2H
+    int energy_source;                  // gpu_energy_source_t
+    void *nvml_device;
+    char energy_path[200];              // hwmon energy1_input
+    double energy_start;                // joules at gpu_energy_start, -1: unread
+    double energy_start_time;
+} gpu_device_t;
+
+// One NDRange launch, for timing and --time calibration
+typedef struct {
+    cl_command_queue queue;
+    cl_kernel kernel;
+    size_t global_work_size;
+    size_t local_work_size;     // 0: chosen by the runtime
+    double host_seconds;        // enqueue to completion of the last launch, host clock
+} launch_t;
+
+// Run `operations_per_work_item` iterations in every work item. Returns the
+// device execution time from the profiling event (queue submission and any
+// lazy compilation excluded), or a negative value if the launch failed.
+static double timed_launch(long long operations_per_work_item, void *context) {
+    launch_t *launch = context;
+    int operations = (int)operations_per_work_item;
+    cl_event event;
+    cl_ulong start_ns = 0, end_ns = 0;
+    
+    clSetKernelArg(launch->kernel, 1, sizeof(int), &operations);
     
-    // Get platform
-    err = clGetPlatformIDs(1, &platform, NULL);
+    double start_time = get_time();
+    
+    cl_int err = clEnqueueNDRangeKernel(launch->queue, launch->kernel, 1, NULL, &launch->global_work_size,
+                                        launch->local_work_size ? &launch->local_work_size : NULL,
+                                        0, NULL, &event);
     if (err != CL_SUCCESS) {
-        printf("Error getting OpenCL platform: %d\n", err);
-        return 1;
+        printf("Error executing kernel: %d\n", err);
+        return -1.0;
     }
     
-    // Get device (prefer GPU, fallback to CPU)
-    err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, NULL);
-    if (err != CL_SUCCESS) {
-        printf("No GPU found, trying CPU...\n");
-        err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, 1, &device, NULL);
-        if (err != CL_SUCCESS) {
-            printf("No OpenCL device found: %d\n", err);
-            return 1;
-        }
+    clWaitForEvents(1, &event); // Wait for completion
+    launch->host_seconds = get_time() - start_time;
+    
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start_ns), &start_ns, NULL);
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end_ns), &end_ns, NULL);
+    clReleaseEvent(event);
+    
+    return (end_ns - start_ns) * 1e-9;
+}
+
+// Whether `extension` appears in the device's CL_DEVICE_EXTENSIONS list
+static int device_has_extension(cl_device_id device, const char *extension) {
+    size_t size = 0;
+    
+    if (!extension) return 1;
+    if (clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, 0, NULL, &size) != CL_SUCCESS || size == 0) return 0;
+    
+    char *extensions = malloc(size);
+    if (!extensions) return 0;
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, size, extensions, NULL);
+    
+    // Match whole space-separated names only
+    size_t length = strlen(extension);
+    int found = 0;
+    for (const char *p = extensions; !found && (p = strstr(p, extension)) != NULL; p += length) {
+        found = (p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0');
     }
+    free(extensions);
+    return found;
+}
+
+// $SISU_CACHE_DIR, else $XDG_CACHE_HOME/sisu-flops, else ~/.cache/sisu-flops;
+// created on demand. 0, or -1 if there is no usable directory.
+static int cache_path(const char *file, char *path, size_t size) {
+    const char *dir = getenv("SISU_CACHE_DIR");
+    const char *home = getenv("HOME");
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    char base[PATH_MAX];
     
-    // Get device info
-    char device_name[256];
-    size_t max_work_group_size;
-    cl_uint compute_units;
+    if (dir && *dir) {
+        snprintf(base, sizeof(base), "%s", dir);
+    } else if (xdg && *xdg) {
+        snprintf(base, sizeof(base), "%s/sisu-flops", xdg);
+    } else if (home && *home) {
+        snprintf(base, sizeof(base), "%s/.cache", home);
+        if (mkdir(base, 0755) != 0 && errno != EEXIST) return -1;
+        snprintf(base, sizeof(base), "%s/.cache/sisu-flops", home);
+    } else {
+        return -1;
+    }
+    if (mkdir(base, 0755) != 0 && errno != EEXIST) return -1;
+    
+    if ((size_t)snprintf(path, size, "%s/%s", base, file) >= size) return -1;
+    return 0;
+}
+
+// FNV-1a, continuing from `hash`
+static uint64_t hash_string(uint64_t hash, const char *text) {
+    for (; *text; text++) {
+        hash ^= (unsigned char)*text;
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ 0xff;     // separator, so "ab"+"c" differs from "a"+"bc"
+}
+
+// Cache file of the binary for this device, driver, options and source;
+// -1 with SISU_BINARY_CACHE=off or no cache directory
+static int binary_cache_path(cl_device_id device, const char *build_options, char *path, size_t size) {
+    const char *setting = getenv("SISU_BINARY_CACHE");
+    char name[256] = "", version[256] = "", driver[256] = "";
+    char file[64];
     
-    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_name), device_name, NULL);
-    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_work_group_size), &max_work_group_size, NULL);
-    clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, NULL);
+    if (setting && (strcmp(setting, "off") == 0 || strcmp(setting, "0") == 0)) return -1;
     
-    printf("=== GPU/OpenCL Benchmark ===\n");
-    printf("Device: %s\n", device_name);
-    printf("Compute Units: %u\n", compute_units);
-    printf("Max Work Group Size: %zu\n\n", max_work_group_size);
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name), name, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_VERSION, sizeof(version), version, NULL);
+    clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driver), driver, NULL);
     
-    // Create context and command queue
-    context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
-    if (err != CL_SUCCESS) {
-        printf("Error creating context: %d\n", err);
-        return 1;
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hash_string(hash, name);
+    hash = hash_string(hash, version);
+    hash = hash_string(hash, driver);
+    hash = hash_string(hash, build_options);
+    hash = hash_string(hash, kernel_source);
+    snprintf(file, sizeof(file), "program-%016llx.bin", (unsigned long long)hash);
+    return cache_path(file, path, size);
+}
+
+// Program from a cached binary, or NULL if there is none or it is stale
+static cl_program load_binary(cl_context context, cl_device_id device, const char *path,
+                              const char *build_options) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    
+    unsigned char *binary = NULL;
+    long size = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    if (size > 0 && fseek(f, 0, SEEK_SET) == 0 && (binary = malloc(size)) != NULL &&
+        fread(binary, 1, size, f) != (size_t)size) {
+        free(binary);
+        binary = NULL;
     }
+    fclose(f);
+    if (!binary) return NULL;
     
-    queue = clCreateCommandQueue(context, device, 0, &err);
-    if (err != CL_SUCCESS) {
-        printf("Error creating command queue: %d\n", err);
-        return 1;
+    const unsigned char *binaries[1] = { binary };
+    size_t sizes[1] = { (size_t)size };
+    cl_int status = CL_SUCCESS, err;
+    cl_program program = clCreateProgramWithBinary(context, 1, &device, sizes, binaries, &status, &err);
+    free(binary);
+    if (err != CL_SUCCESS || status != CL_SUCCESS) {
+        if (program) clReleaseProgram(program);
+        return NULL;
+    }
+    
+    // Binaries still need a build step; a driver that rejects one is
+    // treated as a cache miss
+    if (clBuildProgram(program, 1, &device, build_options, NULL, NULL) != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+    return program;
+}
+
+// Write the built program's binary, via a temporary file and rename
+static int save_binary(cl_program program, const char *path) {
+    size_t size = 0;
+    
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, NULL) != CL_SUCCESS || size == 0) {
+        return -1;
+    }
+    unsigned char *binary = malloc(size);
+    if (!binary) return -1;
+    unsigned char *binaries[1] = { binary };
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, NULL) != CL_SUCCESS) {
+        free(binary);
+        return -1;
+    }
+    
+    char temporary[PATH_MAX + 16];
+    snprintf(temporary, sizeof(temporary), "%s.%d", path, (int)getpid());
+    FILE *f = fopen(temporary, "wb");
+    int written = f && fwrite(binary, 1, size, f) == size;
+    if (f && fclose(f) != 0) written = 0;
+    free(binary);
+    
+    if (!written || rename(temporary, path) != 0) {
+        remove(temporary);
+        return -1;
+    }
+    return 0;
+}
+
+// Build kernel_source specialized for `desc`, or load it from the binary
+// cache; NULL (build log printed) on error
+static cl_program build_program(cl_context context, cl_device_id device, const gpu_kernel_t *desc) {
+    const gpu_precision_t *precision = &precisions[desc->precision];
+    char vector_type[16];
+    char build_options[256];
+    cl_int err;
+    
+    if (desc->width > 1) snprintf(vector_type, sizeof(vector_type), "%s%d", precision->type, desc->width);
+    else snprintf(vector_type, sizeof(vector_type), "%s", precision->type);
+    snprintf(build_options, sizeof(build_options), "-cl-fast-relaxed-math -D REAL=%s -D REALN=%s -D VEC_SUM=SUM%d%s%s",
+             precision->type, vector_type, desc->width, precision->define ? " -D " : "",
+             precision->define ? precision->define : "");
+    
+    char path[PATH_MAX];
+    int cached = binary_cache_path(device, build_options, path, sizeof(path)) == 0;
+    double start_time = get_time();
+    
+    cl_program program = cached ? load_binary(context, device, path, build_options) : NULL;
+    if (program) {
+        printf("   Program: cached binary (%.1f ms)\n", (get_time() - start_time) * 1000.0);
+        return program;
     }
     
-    // Create and build program
     program = clCreateProgramWithSource(context, 1, &kernel_source, NULL, &err);
     if (err != CL_SUCCESS) {
         printf("Error creating program: %d\n", err);
-        return 1;
+        return NULL;
     }
     
-    err = clBuildProgram(program, 1, &device, "-cl-fast-relaxed-math", NULL, NULL);
+    err = clBuildProgram(program, 1, &device, build_options, NULL, NULL);
     if (err != CL_SUCCESS) {
-        printf("Error building program: %d\n", err);
+        printf("Error building program (%s): %d\n", build_options, err);
         
         // Get build log
         size_t log_size;
@@ -100,66 +440,1642 @@ int main() {
         clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, log_size, log, NULL);
         printf("Build log: %s\n", log);
         free(log);
-        return 1;
+        clReleaseProgram(program);
+        return NULL;
     }
     
-    // Create kernel
-    kernel = clCreateKernel(program, "flops_kernel", &err);
+    double build_time = get_time() - start_time;
+    int saved = cached && save_binary(program, path) == 0;
+    printf("   Program: built from source (%.1f ms)%s\n", build_time * 1000.0, saved ? ", binary cached" : "");
+    return program;
+}
+
+// Build `desc` for `dev` and bind its result buffer; NULL on error
+static cl_kernel create_kernel(const gpu_device_t *dev, const gpu_kernel_t *desc) {
+    cl_program program = build_program(dev->context, dev->device, desc);
+    if (!program) return NULL;
+    
+    cl_int err;
+    cl_kernel kernel = clCreateKernel(program, desc->function, &err);
+    clReleaseProgram(program);  // the kernel keeps it alive
     if (err != CL_SUCCESS) {
-        printf("Error creating kernel: %d\n", err);
-        return 1;
+        printf("Error creating kernel %s: %d\n", desc->function, err);
+        return NULL;
     }
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &dev->buffer);
+    return kernel;
+}
+
+// Device energy around the timed launches: NVML's total energy counter on
+// NVIDIA, a hwmon energy1_input on the device's PCI function (Intel discrete
+// GPUs, some amdgpu parts), or the host RAPL domains for CPU devices and
+// integrated GPUs, which draw from the package they share. NVML is loaded
+// at run time, so the build needs neither its headers nor the library.
+typedef enum {
+    GPU_ENERGY_NONE,
+    GPU_ENERGY_NVML,
+    GPU_ENERGY_HWMON,
+    GPU_ENERGY_HOST
+} gpu_energy_source_t;
+
+static const char *gpu_energy_names[] = { "none", "NVML", "hwmon", "host RAPL" };
+
+// cl_khr_pci_bus_info, cl_nv_device_attribute_query, cl_amd_device_attribute_query
+#ifndef CL_DEVICE_PCI_BUS_INFO_KHR
+#define CL_DEVICE_PCI_BUS_INFO_KHR 0x410F
+#endif
+#ifndef CL_DEVICE_PCI_BUS_ID_NV
+#define CL_DEVICE_PCI_BUS_ID_NV 0x4008
+#define CL_DEVICE_PCI_SLOT_ID_NV 0x4009
+#endif
+#ifndef CL_DEVICE_TOPOLOGY_AMD
+#define CL_DEVICE_TOPOLOGY_AMD 0x4037
+#endif
+
+#define NVML_SUCCESS 0
+
+static struct {
+    int state;      // 0: not loaded yet, 1: usable, -1: unavailable
+    int (*handle_by_pci_bus_id)(const char *bus_id, void **device);
+    int (*total_energy_consumption)(void *device, unsigned long long *millijoules);
+} nvml;
+
+static int energy_enabled(void) {
+    const char *setting = getenv("SISU_ENERGY");
+    return !setting || (strcasecmp(setting, "off") != 0 && strcmp(setting, "0") != 0);
+}
+
+static int nvml_load(void) {
+    if (nvml.state) return nvml.state > 0;
+    nvml.state = -1;
     
-    // Set up benchmark parameters
-    size_t global_work_size = compute_units * 256; // 256 work items per compute unit
-    int operations_per_work_item = 1000000; // 1M operations per work item
+    void *library = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!library) return 0;
+    int (*init)(void) = (int (*)(void))dlsym(library, "nvmlInit_v2");
+    *(void **)&nvml.handle_by_pci_bus_id = dlsym(library, "nvmlDeviceGetHandleByPciBusId_v2");
+    *(void **)&nvml.total_energy_consumption = dlsym(library, "nvmlDeviceGetTotalEnergyConsumption");
+    if (!init || !nvml.handle_by_pci_bus_id || !nvml.total_energy_consumption || init() != NVML_SUCCESS) {
+        dlclose(library);
+        return 0;
+    }
+    nvml.state = 1;
+    return 1;
+}
+
+// PCI domain, bus, device and function of `device`; -1 if no extension reports it
+static int device_pci_address(cl_device_id device, unsigned address[4]) {
+    if (device_has_extension(device, "cl_khr_pci_bus_info")) {
+        cl_uint info[4];    // cl_device_pci_bus_info_khr: domain, bus, device, function
+        if (clGetDeviceInfo(device, CL_DEVICE_PCI_BUS_INFO_KHR, sizeof(info), info, NULL) == CL_SUCCESS) {
+            for (int i = 0; i < 4; i++) address[i] = info[i];
+            return 0;
+        }
+    }
+    if (device_has_extension(device, "cl_nv_device_attribute_query")) {
+        cl_uint bus = 0, slot = 0;
+        if (clGetDeviceInfo(device, CL_DEVICE_PCI_BUS_ID_NV, sizeof(bus), &bus, NULL) == CL_SUCCESS &&
+            clGetDeviceInfo(device, CL_DEVICE_PCI_SLOT_ID_NV, sizeof(slot), &slot, NULL) == CL_SUCCESS) {
+            address[0] = 0;
+            address[1] = bus;
+            address[2] = slot >> 3;
+            address[3] = slot & 7;
+            return 0;
+        }
+    }
+    if (device_has_extension(device, "cl_amd_device_attribute_query")) {
+        unsigned char topology[24];     // cl_device_topology_amd: type 1 (PCIe), then bus/device/function at 21..23
+        if (clGetDeviceInfo(device, CL_DEVICE_TOPOLOGY_AMD, sizeof(topology), topology, NULL) == CL_SUCCESS &&
+            topology[0] == 1) {
+            address[0] = 0;
+            address[1] = topology[21];
+            address[2] = topology[22];
+            address[3] = topology[23];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int read_energy_file(const char *path, double *microjoules) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fscanf(f, "%lf", microjoules) == 1;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+// First energy1_input among the hwmon devices of a PCI function
+static int pci_hwmon_energy(const unsigned address[4], char *path, size_t size) {
+    char directory[96];
+    snprintf(directory, sizeof(directory), "/sys/bus/pci/devices/%04x:%02x:%02x.%x/hwmon", address[0], address[1],
+             address[2], address[3]);
+    DIR *dir = opendir(directory);
+    if (!dir) return -1;
+    
+    int found = -1;
+    double value;
+    for (struct dirent *entry; found < 0 && (entry = readdir(dir)) != NULL; ) {
+        if (strncmp(entry->d_name, "hwmon", 5) != 0) continue;
+        snprintf(path, size, "%s/%.32s/energy1_input", directory, entry->d_name);
+        if (read_energy_file(path, &value) == 0) found = 0;
+    }
+    closedir(dir);
+    return found;
+}
+
+static void choose_energy_source(gpu_device_t *dev) {
+    unsigned address[4];
+    cl_bool unified = CL_FALSE;
+    
+    dev->energy_source = GPU_ENERGY_NONE;
+    if (!energy_enabled()) return;
+    if (device_pci_address(dev->device, address) == 0) {
+        char bus_id[32];
+        snprintf(bus_id, sizeof(bus_id), "%08x:%02x:%02x.%x", address[0], address[1], address[2], address[3]);
+        if (nvml_load() && nvml.handle_by_pci_bus_id(bus_id, &dev->nvml_device) == NVML_SUCCESS) {
+            dev->energy_source = GPU_ENERGY_NVML;
+            return;
+        }
+        if (pci_hwmon_energy(address, dev->energy_path, sizeof(dev->energy_path)) == 0) {
+            dev->energy_source = GPU_ENERGY_HWMON;
+            return;
+        }
+    }
+    clGetDeviceInfo(dev->device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(unified), &unified, NULL);
+    if ((dev->is_cpu || unified) && energy_domains() > 0) dev->energy_source = GPU_ENERGY_HOST;
+}
+
+// Device energy counter in joules, or -1
+static double read_device_energy(const gpu_device_t *dev) {
+    unsigned long long millijoules;
+    double microjoules;
+    
+    switch (dev->energy_source) {
+    case GPU_ENERGY_NVML:
+        if (nvml.total_energy_consumption(dev->nvml_device, &millijoules) != NVML_SUCCESS) return -1.0;
+        return millijoules * 1e-3;
+    case GPU_ENERGY_HWMON:
+        return read_energy_file(dev->energy_path, &microjoules) == 0 ? microjoules * 1e-6 : -1.0;
+    default:
+        return -1.0;
+    }
+}
+
+static void gpu_energy_start(gpu_device_t *dev) {
+    if (dev->energy_source == GPU_ENERGY_HOST) energy_start();
+    dev->energy_start = read_device_energy(dev);
+    dev->energy_start_time = get_time();
+}
+
+// Joules since gpu_energy_start (wall seconds in `seconds`), 0 if unknown
+static double gpu_energy_stop(gpu_device_t *dev, double *seconds) {
+    *seconds = get_time() - dev->energy_start_time;
+    if (dev->energy_source == GPU_ENERGY_HOST) {
+        energy_sample_t sample;
+        energy_stop(&sample);
+        return sample.valid ? sample.total : 0.0;
+    }
+    double end = read_device_energy(dev);
+    if (dev->energy_start < 0.0 || end < dev->energy_start || *seconds < GPU_ENERGY_MIN_SECONDS) return 0.0;
+    return end - dev->energy_start;
+}
+
+// Warm up, calibrate and time one kernel on `dev`; returns 0, or -1 on error
+static int benchmark_kernel(gpu_device_t *dev, int k, int index, const bench_options_t *opts,
+                            kernel_result_t *result) {
+    const gpu_kernel_t *desc = &gpu_kernels[k];
+    
+    printf("%d. %s:\n", index, desc->title);
+    
+    cl_kernel kernel = create_kernel(dev, desc);
+    if (!kernel) return -1;
+    launch_t launch = { dev->queue, kernel, dev->global_work_size, dev->local_work_size, 0.0 };
+    
+    // Short launches first: the first enqueue pays for lazy compilation and
+    // the clocks ramp up
+    warmup_t warmup;
+    if (timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &launch) < 0.0) {
+        clReleaseKernel(kernel);
+        return -1;
+    }
+    for (warmup_start(&warmup); warmup_running(&warmup); ) {
+        timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &launch);
+    }
+    
+    double fallback_flops = dev->tuned_operations > 0
+                            ? dev->tuned_operations * gpu_kernels[TUNE_KERNEL].flops_per_iteration
+                            : DEFAULT_OPERATIONS_PER_WORK_ITEM * gpu_kernels[0].flops_per_iteration;
+    long long fallback = (long long)(fallback_flops / desc->flops_per_iteration);
+    if (fallback < 1) fallback = 1;
+    long long operations_per_work_item = options_operations(opts, timed_launch, &launch, 1, fallback);
+    if (operations_per_work_item > INT_MAX) operations_per_work_item = INT_MAX;  // kernel takes an int
+    
+    trial_set_t trials;
+    trial_stats_t stats;
+    trial_stats_t overhead;
+    double overheads[MAX_TRIALS];
+    gpu_energy_start(dev);
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        double elapsed = timed_launch(operations_per_work_item, &launch);
+        if (elapsed < 0.0) {
+            clReleaseKernel(kernel);
+            return -1;
+        }
+        overheads[trials.count] = launch.host_seconds - elapsed;
+        trials_add(&trials, elapsed);
+    }
+    double energy_seconds;
+    double joules = gpu_energy_stop(dev, &energy_seconds);
+    trials_summarize(&trials, &stats);
+    compute_stats(overheads, trials.count, &overhead);
+    clReleaseKernel(kernel);
+    
+    // Calculate performance
+    long long total_operations = (long long)dev->global_work_size * operations_per_work_item;
+    double total_flops = total_operations * desc->flops_per_iteration;
+    double mflops = (total_flops / stats.median) / 1000000.0;
     
-    printf("Global work size: %zu\n", global_work_size);
-    printf("Operations per work item: %d\n", operations_per_work_item);
+    printf("   Operations per work item: %lld", operations_per_work_item);
+    if (opts->target_seconds > 0.0) printf(" (calibrated for %.3f s)", opts->target_seconds);
+    printf("\n");
+    printf("   Kernel time: %.6f seconds (device timer, median of %d trials)\n", stats.median, stats.count);
+    print_trial_stats("   ", &stats);
+    printf("   Launch overhead: %.1f us (host wall time minus kernel time, median)\n", overhead.median * 1e6);
+    printf("   Total FLOPS: %.0f\n", total_flops);
+    printf("   GPU MFLOPS: %.2f (%.2f GFLOPS)\n", mflops, mflops / 1000.0);
+    
+    report_add(desc->name, dev->isa, (int)dev->global_work_size, total_operations, total_flops, &stats);
+    result->gflops_per_watt = 0.0;
+    if (joules > 0.0) {
+        // Joules cover every trial, including the gaps between launches
+        result->gflops_per_watt = total_flops * stats.count / joules / 1e9;
+        printf("   Energy: %.3f J over %.3f s, %.2f W (%s)\n", joules, energy_seconds, joules / energy_seconds,
+               gpu_energy_names[dev->energy_source]);
+        printf("   Efficiency: %.3f GFLOPS/W\n", result->gflops_per_watt);
+        report_set_energy(joules / stats.count, joules / energy_seconds);
+    }
+    printf("\n");
+    
+    result->kernel = k;
+    result->mflops = mflops;
+    result->operations_per_work_item = operations_per_work_item;
+    result->stats = stats;
+    return 0;
+}
+
+// All devices of every platform. GPUs and accelerators are preferred; CPU
+// devices are kept only when there is nothing else, as before.
+static int enumerate_devices(gpu_device_t *devices, int max_devices) {
+    cl_platform_id platforms[MAX_GPU_PLATFORMS];
+    cl_uint num_platforms = 0;
+    int count = 0;
+    int accelerators = 0;
+    
+    cl_int err = clGetPlatformIDs(MAX_GPU_PLATFORMS, platforms, &num_platforms);
+    if (err != CL_SUCCESS) {
+        printf("Error getting OpenCL platforms: %d\n", err);
+        return 0;
+    }
+    if (num_platforms > MAX_GPU_PLATFORMS) num_platforms = MAX_GPU_PLATFORMS;
+    
+    for (cl_uint p = 0; p < num_platforms; p++) {
+        cl_device_id ids[MAX_GPU_DEVICES];
+        cl_uint num_ids = 0;
+        char platform_name[128] = "";
+        
+        clGetPlatformInfo(platforms[p], CL_PLATFORM_NAME, sizeof(platform_name), platform_name, NULL);
+        if (clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_ALL, MAX_GPU_DEVICES, ids, &num_ids) != CL_SUCCESS) continue;
+        if (num_ids > MAX_GPU_DEVICES) num_ids = MAX_GPU_DEVICES;
+        
+        for (cl_uint d = 0; d < num_ids && count < max_devices; d++) {
+            gpu_device_t *dev = &devices[count++];
+            cl_device_type type = 0;
+            
+            memset(dev, 0, sizeof(*dev));
+            dev->device = ids[d];
+            snprintf(dev->platform, sizeof(dev->platform), "%s", platform_name);
+            clGetDeviceInfo(ids[d], CL_DEVICE_NAME, sizeof(dev->name), dev->name, NULL);
+            clGetDeviceInfo(ids[d], CL_DEVICE_TYPE, sizeof(type), &type, NULL);
+            clGetDeviceInfo(ids[d], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(dev->compute_units), &dev->compute_units, NULL);
+            clGetDeviceInfo(ids[d], CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(dev->max_work_group_size),
+                            &dev->max_work_group_size, NULL);
+            clGetDeviceInfo(ids[d], CL_DEVICE_PROFILING_TIMER_RESOLUTION, sizeof(dev->timer_resolution),
+                            &dev->timer_resolution, NULL);
+            clGetDeviceInfo(ids[d], CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(dev->max_alloc), &dev->max_alloc, NULL);
+            dev->is_cpu = (type & CL_DEVICE_TYPE_CPU) != 0;
+            accelerators += !dev->is_cpu;
+            snprintf(dev->isa, sizeof(dev->isa), "opencl %s", dev->name);
+            for (int q = 0; q < NUM_PRECISIONS; q++) {
+                dev->supported[q] = device_has_extension(ids[d], precisions[q].extension);
+                dev->best[q].kernel = -1;
+            }
+        }
+    }
+    
+    if (accelerators == 0) {
+        if (count > 0) printf("No GPU found, using CPU devices\n");
+        return count;
+    }
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (!devices[i].is_cpu) devices[kept++] = devices[i];
+    }
+    return kept;
+}
+
+// Launch geometry for `dev`, (re)creating the result buffer to match
+static int set_geometry(gpu_device_t *dev, size_t global_work_size, size_t local_work_size) {
+    cl_int err;
+    
+    if (dev->buffer) clReleaseMemObject(dev->buffer);
+    dev->global_work_size = global_work_size;
+    dev->local_work_size = local_work_size;
     
     // Create buffer for results
-    buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(float) * global_work_size, NULL, &err);
+    dev->buffer = clCreateBuffer(dev->context, CL_MEM_WRITE_ONLY, sizeof(float) * global_work_size, NULL, &err);
     if (err != CL_SUCCESS) {
+        dev->buffer = NULL;
         printf("Error creating buffer: %d\n", err);
-        return 1;
+        return -1;
     }
+    return 0;
+}
+
+// Tuned geometry of one device, keyed on the device name
+typedef struct {
+    size_t local_work_size;
+    int groups_per_cu;
+    long long operations_per_work_item;
+} geometry_t;
+
+// Cache lines are "<device name>\t<local>\t<groups per CU>\t<operations>"
+static int load_geometry(const char *device_name, geometry_t *geometry) {
+    char path[PATH_MAX];
+    char line[512];
+    int found = 0;
+    
+    if (cache_path(TUNE_CACHE_FILE, path, sizeof(path)) != 0) return 0;
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    
+    size_t length = strlen(device_name);
+    while (!found && fgets(line, sizeof(line), f)) {
+        if (strncmp(line, device_name, length) != 0 || line[length] != '\t') continue;
+        found = sscanf(line + length + 1, "%zu %d %lld", &geometry->local_work_size, &geometry->groups_per_cu,
+                       &geometry->operations_per_work_item) == 3 &&
+                geometry->local_work_size > 0 && geometry->groups_per_cu > 0 &&
+                geometry->operations_per_work_item > 0;
+    }
+    fclose(f);
+    return found;
+}
+
+// Replace this device's line (or add one); written to a temporary file
+// and renamed so concurrent runs never see a partial cache
+static void save_geometry(const char *device_name, const geometry_t *geometry) {
+    char path[PATH_MAX];
+    char temporary[PATH_MAX + 16];
+    char line[512];
     
-    // Set kernel arguments
+    if (cache_path(TUNE_CACHE_FILE, path, sizeof(path)) != 0) return;
+    snprintf(temporary, sizeof(temporary), "%s.%d", path, (int)getpid());
+    FILE *out = fopen(temporary, "w");
+    if (!out) return;
+    
+    FILE *in = fopen(path, "r");
+    size_t length = strlen(device_name);
+    if (in) {
+        while (fgets(line, sizeof(line), in)) {
+            if (strncmp(line, device_name, length) == 0 && line[length] == '\t') continue;
+            fputs(line, out);
+        }
+        fclose(in);
+    } else {
+        fprintf(out, "# device\tlocal_work_size\tgroups_per_cu\toperations_per_work_item\n");
+    }
+    fprintf(out, "%s\t%zu\t%d\t%lld\n", device_name, geometry->local_work_size, geometry->groups_per_cu,
+            geometry->operations_per_work_item);
+    
+    if (fclose(out) == 0 && rename(temporary, path) == 0) {
+        printf("   Saved to %s\n", path);
+    } else {
+        remove(temporary);
+    }
+}
+
+// Median MFLOPS of TUNE_TRIALS launches, or a negative value on error
+static double tune_measure(launch_t *launch, long long operations_per_work_item, double *seconds) {
+    double samples[TUNE_TRIALS];
+    trial_stats_t stats;
+    
+    for (int i = 0; i < TUNE_TRIALS; i++) {
+        samples[i] = timed_launch(operations_per_work_item, launch);
+        if (samples[i] <= 0.0) return -1.0;
+    }
+    compute_stats(samples, TUNE_TRIALS, &stats);
+    if (seconds) *seconds = stats.median;
+    
+    double flops = (double)launch->global_work_size * operations_per_work_item *
+                   gpu_kernels[TUNE_KERNEL].flops_per_iteration;
+    return flops / stats.median / 1000000.0;
+}
+
+// Sweep the launch geometry with TUNE_KERNEL; 0, or -1 on error
+static int tune_geometry(gpu_device_t *dev, geometry_t *best) {
+    const gpu_kernel_t *desc = &gpu_kernels[TUNE_KERNEL];
+    size_t multiple = 0, max_local = 0;
+    cl_int err;
+    
+    cl_kernel kernel = create_kernel(dev, desc);
+    if (!kernel) return -1;
+    clGetKernelWorkGroupInfo(kernel, dev->device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(multiple),
+                             &multiple, NULL);
+    clGetKernelWorkGroupInfo(kernel, dev->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(max_local), &max_local, NULL);
+    if (multiple == 0) multiple = 1;
+    if (max_local == 0 || max_local > dev->max_work_group_size) max_local = dev->max_work_group_size;
+    if (max_local < multiple) max_local = multiple;
+    
+    // One buffer large enough for the widest NDRange in the sweep
+    size_t max_global = max_local * dev->compute_units * TUNE_MAX_GROUPS_PER_CU;
+    cl_mem buffer = clCreateBuffer(dev->context, CL_MEM_WRITE_ONLY, sizeof(float) * max_global, NULL, &err);
+    if (err != CL_SUCCESS) {
+        printf("Error creating buffer: %d\n", err);
+        clReleaseKernel(kernel);
+        return -1;
+    }
     clSetKernelArg(kernel, 0, sizeof(cl_mem), &buffer);
-    clSetKernelArg(kernel, 1, sizeof(int), &operations_per_work_item);
     
-    // Run benchmark
-    printf("Running GPU benchmark...\n");
+    printf("Tuning launch geometry with %s (preferred multiple %zu, max local size %zu):\n", desc->name, multiple,
+           max_local);
+    printf("   %-10s", "Local");
+    for (int groups = 1; groups <= TUNE_MAX_GROUPS_PER_CU; groups *= 2) printf(" %6d/CU", groups);
+    printf("   (GFLOPS by work-groups per compute unit)\n");
+    
+    launch_t launch = { dev->queue, kernel, multiple * dev->compute_units, multiple, 0.0 };
+    timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &launch);
+    
+    double best_mflops = 0.0;
+    int status = 0;
+    for (size_t local = multiple; status == 0 && local <= max_local; local *= 2) {
+        printf("   %-10zu", local);
+        for (int groups = 1; groups <= TUNE_MAX_GROUPS_PER_CU; groups *= 2) {
+            launch.local_work_size = local;
+            launch.global_work_size = local * dev->compute_units * groups;
+            double mflops = tune_measure(&launch, TUNE_OPERATIONS, NULL);
+            if (mflops < 0.0) {
+                status = -1;
+                break;
+            }
+            printf(" %9.1f", mflops / 1000.0);
+            if (mflops > best_mflops) {
+                best_mflops = mflops;
+                best->local_work_size = local;
+                best->groups_per_cu = groups;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    
+    // Then the shortest launch of at least TUNE_MIN_LAUNCH_SECONDS that keeps
+    // the throughput
+    if (status == 0) {
+        double mflops_by_operations[32];
+        double launch_seconds[32];
+        long long operations[32];
+        int count = 0;
+        double peak = 0.0;
+        
+        launch.local_work_size = best->local_work_size;
+        launch.global_work_size = best->local_work_size * dev->compute_units * best->groups_per_cu;
+        for (long long ops = TUNE_MIN_OPERATIONS; count < 32 && ops <= INT_MAX; ops *= 4) {
+            double seconds = 0.0;
+            double mflops = tune_measure(&launch, ops, &seconds);
+            if (mflops < 0.0) {
+                status = -1;
+                break;
+            }
+            operations[count] = ops;
+            launch_seconds[count] = seconds;
+            mflops_by_operations[count++] = mflops;
+            if (mflops > peak) peak = mflops;
+            if (seconds > TUNE_MAX_LAUNCH_SECONDS) break;
+        }
+        for (int i = 0; i < count; i++) {
+            int long_enough = launch_seconds[i] >= TUNE_MIN_LAUNCH_SECONDS || i == count - 1;
+            if (long_enough && mflops_by_operations[i] >= peak * (1.0 - TUNE_TOLERANCE)) {
+                best->operations_per_work_item = operations[i];
+                best_mflops = mflops_by_operations[i];
+                break;
+            }
+        }
+    }
+    
+    clReleaseMemObject(buffer);
+    clReleaseKernel(kernel);
+    if (status != 0 || best->operations_per_work_item == 0) return -1;
+    
+    printf("   Best: local %zu, %d work-groups per CU (global %zu), %lld operations per work item: %.2f GFLOPS\n",
+           best->local_work_size, best->groups_per_cu,
+           best->local_work_size * dev->compute_units * best->groups_per_cu, best->operations_per_work_item,
+           best_mflops / 1000.0);
+    return 0;
+}
+
+// SISU_TUNE=on sweeps and caches; off ignores the cache; unset uses a cached
+// geometry when there is one. --threads always wins.
+static int choose_geometry(gpu_device_t *dev, const bench_options_t *opts) {
+    const char *tune = getenv("SISU_TUNE");
+    int run = tune && (strcmp(tune, "on") == 0 || strcmp(tune, "1") == 0);
+    int off = tune && (strcmp(tune, "off") == 0 || strcmp(tune, "0") == 0);
+    geometry_t geometry = { 0, 0, 0 };
+    const char *source;
+    
+    if (opts->threads > 0 || off) {
+        printf("Launch geometry: global %zu, local chosen by the runtime (%s)\n", dev->global_work_size,
+               opts->threads > 0 ? "--threads" : "tuning off");
+        return 0;
+    }
+    
+    if (run) {
+        if (tune_geometry(dev, &geometry) != 0) return -1;
+        save_geometry(dev->name, &geometry);
+        source = "tuned";
+    } else if (load_geometry(dev->name, &geometry)) {
+        source = "cached";
+    } else {
+        printf("Launch geometry: global %zu, local chosen by the runtime (default; --tune on to tune)\n",
+               dev->global_work_size);
+        return 0;
+    }
+    
+    if (set_geometry(dev, geometry.local_work_size * dev->compute_units * geometry.groups_per_cu,
+                     geometry.local_work_size) != 0) {
+        return -1;
+    }
+    dev->tuned_operations = geometry.operations_per_work_item;
+    printf("Launch geometry: global %zu, local %zu, %lld operations per work item for %s (%s)\n",
+           dev->global_work_size, dev->local_work_size, dev->tuned_operations, gpu_kernels[TUNE_KERNEL].name,
+           source);
+    return 0;
+}
+
+// Context, profiling queue and result buffer for `dev`; 0, or -1 on error
+static int open_device(gpu_device_t *dev, const bench_options_t *opts) {
+    cl_int err;
+    
+    dev->context = clCreateContext(NULL, 1, &dev->device, NULL, NULL, &err);
+    if (err != CL_SUCCESS) {
+        printf("Error creating context: %d\n", err);
+        return -1;
+    }
+    
+    dev->queue = clCreateCommandQueue(dev->context, dev->device, CL_QUEUE_PROFILING_ENABLE, &err);
+    if (err != CL_SUCCESS) {
+        printf("Error creating command queue: %d\n", err);
+        return -1;
+    }
+    
+    choose_energy_source(dev);
+    
+    // --threads sets the global work size (work items)
+    size_t global_work_size = opts->threads > 0 ? (size_t)opts->threads
+                                                : dev->compute_units * DEFAULT_WORK_ITEMS_PER_CU;
+    return set_geometry(dev, global_work_size, 0);
+}
+
+static void close_device(gpu_device_t *dev) {
+    if (dev->buffer) clReleaseMemObject(dev->buffer);
+    if (dev->queue) clReleaseCommandQueue(dev->queue);
+    if (dev->context) clReleaseContext(dev->context);
+}
+
+// Buffers for the transfer tests; the pinned buffer stays mapped so its
+// host pointer can be handed to clEnqueueRead/WriteBuffer
+typedef struct {
+    cl_command_queue queue;     // second in-order queue, next to the kernel queue
+    cl_mem device_a;
+    cl_mem device_b;
+    cl_mem pinned;              // CL_MEM_ALLOC_HOST_PTR
+    void *pinned_ptr;
+    cl_mem zero_copy;           // CL_MEM_ALLOC_HOST_PTR, mapped per transfer
+    void *pageable;
+    size_t max_bytes;
+    transfer_mode_t mode;
+    size_t bytes;
+    int batch;                  // transfers per timed run
+    int blocking;               // wait for each transfer (latency test)
+} transfer_t;
+
+static void close_transfers(transfer_t *t) {
+    if (t->pinned_ptr) clEnqueueUnmapMemObject(t->queue, t->pinned, t->pinned_ptr, 0, NULL, NULL);
+    if (t->queue) clFinish(t->queue);
+    if (t->device_a) clReleaseMemObject(t->device_a);
+    if (t->device_b) clReleaseMemObject(t->device_b);
+    if (t->pinned) clReleaseMemObject(t->pinned);
+    if (t->zero_copy) clReleaseMemObject(t->zero_copy);
+    if (t->queue) clReleaseCommandQueue(t->queue);
+    free(t->pageable);
+}
+
+// Queue and buffers of up to TRANSFER_MAX_BYTES (less if the device's
+// allocation limit is lower); 0, or -1 on error
+static int open_transfers(const gpu_device_t *dev, transfer_t *t) {
+    cl_int err;
+    
+    memset(t, 0, sizeof(*t));
+    t->max_bytes = TRANSFER_MAX_BYTES;
+    while (t->max_bytes > TRANSFER_MIN_BYTES && dev->max_alloc > 0 && t->max_bytes > dev->max_alloc / 2) {
+        t->max_bytes /= 4;
+    }
+    
+    t->queue = clCreateCommandQueue(dev->context, dev->device, 0, &err);
+    if (err == CL_SUCCESS) t->device_a = clCreateBuffer(dev->context, CL_MEM_READ_WRITE, t->max_bytes, NULL, &err);
+    if (err == CL_SUCCESS) t->device_b = clCreateBuffer(dev->context, CL_MEM_READ_WRITE, t->max_bytes, NULL, &err);
+    if (err == CL_SUCCESS) {
+        t->pinned = clCreateBuffer(dev->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, t->max_bytes, NULL, &err);
+    }
+    if (err == CL_SUCCESS) {
+        t->zero_copy = clCreateBuffer(dev->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, t->max_bytes, NULL,
+                                      &err);
+    }
+    if (err == CL_SUCCESS) {
+        t->pinned_ptr = clEnqueueMapBuffer(t->queue, t->pinned, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+                                           t->max_bytes, 0, NULL, NULL, &err);
+    }
+    if (err != CL_SUCCESS) {
+        printf("Error creating transfer buffers: %d\n", err);
+        close_transfers(t);
+        return -1;
+    }
+    
+    // Touch every page so first-use faults stay out of the timings
+    t->pageable = malloc(t->max_bytes);
+    if (!t->pageable) {
+        printf("Error allocating %zu bytes of host memory\n", t->max_bytes);
+        close_transfers(t);
+        return -1;
+    }
+    memset(t->pageable, 1, t->max_bytes);
+    memset(t->pinned_ptr, 2, t->max_bytes);
+    return 0;
+}
+
+static cl_int transfer_once(transfer_t *t) {
+    cl_bool blocking = t->blocking ? CL_TRUE : CL_FALSE;
+    cl_int err = CL_SUCCESS;
+    void *mapped;
+    
+    switch (t->mode) {
+    case TRANSFER_H2D_PAGEABLE:
+        return clEnqueueWriteBuffer(t->queue, t->device_a, blocking, 0, t->bytes, t->pageable, 0, NULL, NULL);
+    case TRANSFER_H2D_PINNED:
+        return clEnqueueWriteBuffer(t->queue, t->device_a, blocking, 0, t->bytes, t->pinned_ptr, 0, NULL, NULL);
+    case TRANSFER_D2H_PAGEABLE:
+        return clEnqueueReadBuffer(t->queue, t->device_a, blocking, 0, t->bytes, t->pageable, 0, NULL, NULL);
+    case TRANSFER_D2H_PINNED:
+        return clEnqueueReadBuffer(t->queue, t->device_a, blocking, 0, t->bytes, t->pinned_ptr, 0, NULL, NULL);
+    case TRANSFER_D2D:
+        err = clEnqueueCopyBuffer(t->queue, t->device_a, t->device_b, 0, 0, t->bytes, 0, NULL, NULL);
+        if (err == CL_SUCCESS && t->blocking) err = clFinish(t->queue);
+        return err;
+    case TRANSFER_H2D_MAP:
+        mapped = clEnqueueMapBuffer(t->queue, t->zero_copy, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, t->bytes,
+                                    0, NULL, NULL, &err);
+        if (err != CL_SUCCESS) return err;
+        memcpy(mapped, t->pageable, t->bytes);
+        break;
+    case TRANSFER_D2H_MAP:
+        mapped = clEnqueueMapBuffer(t->queue, t->zero_copy, CL_TRUE, CL_MAP_READ, 0, t->bytes, 0, NULL, NULL, &err);
+        if (err != CL_SUCCESS) return err;
+        memcpy(t->pageable, mapped, t->bytes);
+        break;
+    default:
+        return CL_INVALID_VALUE;
+    }
+    
+    err = clEnqueueUnmapMemObject(t->queue, t->zero_copy, mapped, 0, NULL, NULL);
+    if (err == CL_SUCCESS && t->blocking) err = clFinish(t->queue);
+    return err;
+}
+
+// `batch` transfers and the queue drained, host clock; negative on error
+static double timed_transfers(void *context) {
+    transfer_t *t = context;
+    double start_time = get_time();
+    
+    for (int i = 0; i < t->batch; i++) {
+        cl_int err = transfer_once(t);
+        if (err != CL_SUCCESS) {
+            printf("Error in %s transfer of %zu bytes: %d\n", transfer_names[t->mode], t->bytes, err);
+            return -1.0;
+        }
+    }
+    clFinish(t->queue);
+    return get_time() - start_time;
+}
+
+// Trials of timed_transfers; 0, or -1 on error
+static int measure_transfers(transfer_t *t, trial_stats_t *stats) {
+    trial_set_t trials;
+    
+    // Untimed pass: first use of a size may allocate or pin pages
+    if (timed_transfers(t) < 0.0) return -1;
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        double elapsed = timed_transfers(t);
+        if (elapsed < 0.0) return -1;
+        trials_add(&trials, elapsed);
+    }
+    trials_summarize(&trials, stats);
+    return 0;
+}
+
+static const char *format_bytes(size_t bytes, char *text, size_t size) {
+    if (bytes >= ((size_t)1 << 20)) snprintf(text, size, "%zu MiB", bytes >> 20);
+    else if (bytes >= ((size_t)1 << 10)) snprintf(text, size, "%zu KiB", bytes >> 10);
+    else snprintf(text, size, "%zu B", bytes);
+    return text;
+}
+
+// GB/s for every mode and size; records carry bytes as operations and no FLOPs
+static int transfer_sweep(gpu_device_t *dev, transfer_t *t, int index) {
+    char size_text[24];
+    char name[48];
+    
+    printf("%d. Transfer bandwidth (GB/s, host clock, %zu MiB per trial):\n", index, TRANSFER_BATCH_BYTES >> 20);
+    printf("   %-8s", "Size");
+    for (int m = 0; m < NUM_TRANSFER_MODES; m++) printf(" %13s", transfer_names[m]);
+    printf("\n");
     
+    t->blocking = 0;
+    for (size_t bytes = TRANSFER_MIN_BYTES; bytes <= t->max_bytes; bytes *= 4) {
+        printf("   %-8s", format_bytes(bytes, size_text, sizeof(size_text)));
+        for (int m = 0; m < NUM_TRANSFER_MODES; m++) {
+            trial_stats_t stats;
+            
+            t->mode = (transfer_mode_t)m;
+            t->bytes = bytes;
+            t->batch = bytes >= TRANSFER_BATCH_BYTES ? 1 : (int)(TRANSFER_BATCH_BYTES / bytes);
+            if (measure_transfers(t, &stats) != 0) return -1;
+            
+            // A device-to-device copy reads and writes device memory, so it
+            // counts both, as STREAM copy does
+            double moved = (double)bytes * t->batch * (m == TRANSFER_D2D ? 2 : 1);
+            double gbps = moved / stats.median / 1e9;
+            if (gbps > dev->transfer_gbps[m]) dev->transfer_gbps[m] = gbps;
+            printf(" %13.2f", gbps);
+            
+            snprintf(name, sizeof(name), "%s_%s", transfer_names[m], size_text);
+            for (char *c = name; *c; c++) if (*c == ' ') *c = '_';
+            report_add(name, dev->isa, 1, moved, 0.0, &stats);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    printf("\n");
+    return 0;
+}
+
+// Per-transfer time of tiny blocking H2D and D2H copies
+static int latency_test(gpu_device_t *dev, transfer_t *t, int index) {
+    const transfer_mode_t modes[2] = { TRANSFER_H2D_PINNED, TRANSFER_D2H_PINNED };
+    
+    printf("%d. Small-transfer latency (%d-byte blocking transfers, pinned host memory):\n", index, LATENCY_BYTES);
+    
+    t->blocking = 1;
+    t->bytes = LATENCY_BYTES;
+    t->batch = LATENCY_BATCH;
+    for (int i = 0; i < 2; i++) {
+        trial_stats_t stats;
+        
+        t->mode = modes[i];
+        if (measure_transfers(t, &stats) != 0) return -1;
+        dev->latency_us[i] = stats.median / LATENCY_BATCH * 1e6;
+        printf("   %s: %.2f us per transfer (median of %d trials of %d)\n", i ? "D2H" : "H2D",
+               dev->latency_us[i], stats.count, LATENCY_BATCH);
+        
+        report_add(i ? "d2h_latency" : "h2d_latency", dev->isa, 1, (double)LATENCY_BYTES * LATENCY_BATCH, 0.0,
+                   &stats);
+    }
+    printf("\n");
+    t->blocking = 0;
+    return 0;
+}
+
+// flops_kernel on the kernel queue and pinned H2D copies on the transfer
+// queue, alone and together
+typedef struct {
+    launch_t *launch;
+    long long operations_per_work_item;
+    transfer_t *transfers;
+} overlap_t;
+
+static double timed_overlap(void *context) {
+    overlap_t *o = context;
+    int operations = (int)o->operations_per_work_item;
     double start_time = get_time();
     
-    err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global_work_size, NULL, 0, NULL, NULL);
+    clSetKernelArg(o->launch->kernel, 1, sizeof(int), &operations);
+    cl_int err = clEnqueueNDRangeKernel(o->launch->queue, o->launch->kernel, 1, NULL,
+                                        &o->launch->global_work_size,
+                                        o->launch->local_work_size ? &o->launch->local_work_size : NULL,
+                                        0, NULL, NULL);
     if (err != CL_SUCCESS) {
         printf("Error executing kernel: %d\n", err);
+        return -1.0;
+    }
+    clFlush(o->launch->queue);  // start the kernel before the copies queue up
+    
+    if (timed_transfers(o->transfers) < 0.0) return -1.0;
+    clFinish(o->launch->queue);
+    return get_time() - start_time;
+}
+
+static int overlap_test(gpu_device_t *dev, transfer_t *t, const bench_options_t *opts, int index) {
+    const gpu_kernel_t *desc = &gpu_kernels[0];     // flops_kernel
+    trial_stats_t transfer_stats, kernel_stats, overlap_stats;
+    trial_set_t trials;
+    char size_text[24];
+    
+    t->mode = TRANSFER_H2D_PINNED;
+    t->bytes = t->max_bytes;
+    t->batch = t->max_bytes >= TRANSFER_BATCH_BYTES ? 1 : (int)(TRANSFER_BATCH_BYTES / t->max_bytes);
+    t->blocking = 0;
+    
+    printf("%d. Transfer/compute overlap (%s, %d x %s H2D pinned on a second queue):\n", index, desc->name, t->batch,
+           format_bytes(t->bytes, size_text, sizeof(size_text)));
+    
+    cl_kernel kernel = create_kernel(dev, desc);
+    if (!kernel) return -1;
+    launch_t launch = { dev->queue, kernel, dev->global_work_size, dev->local_work_size, 0.0 };
+    overlap_t overlap = { &launch, 0, t };
+    
+    // Size the kernel to take as long as the copies, so full overlap halves
+    // the combined time
+    if (measure_transfers(t, &transfer_stats) != 0 || timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &launch) < 0.0) {
+        clReleaseKernel(kernel);
+        return -1;
+    }
+    bench_options_t matched = *opts;
+    matched.target_seconds = transfer_stats.median;
+    overlap.operations_per_work_item = options_operations(&matched, timed_launch, &launch, 1,
+                                                          DEFAULT_OPERATIONS_PER_WORK_ITEM);
+    if (overlap.operations_per_work_item > INT_MAX) overlap.operations_per_work_item = INT_MAX;
+    
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        double elapsed = timed_launch(overlap.operations_per_work_item, &launch);
+        if (elapsed < 0.0) break;
+        trials_add(&trials, launch.host_seconds);
+    }
+    trials_summarize(&trials, &kernel_stats);
+    
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        double elapsed = timed_overlap(&overlap);
+        if (elapsed < 0.0) break;
+        trials_add(&trials, elapsed);
+    }
+    trials_summarize(&trials, &overlap_stats);
+    clReleaseKernel(kernel);
+    if (kernel_stats.count == 0 || overlap_stats.count == 0) return -1;
+    
+    // 100%: the shorter phase is completely hidden behind the longer one
+    double alone = kernel_stats.median + transfer_stats.median;
+    double shorter = kernel_stats.median < transfer_stats.median ? kernel_stats.median : transfer_stats.median;
+    double hidden = (alone - overlap_stats.median) / shorter;
+    if (hidden < 0.0) hidden = 0.0;
+    
+    printf("   Kernel alone: %.3f ms, transfers alone: %.3f ms, together: %.3f ms\n",
+           kernel_stats.median * 1e3, transfer_stats.median * 1e3, overlap_stats.median * 1e3);
+    print_trial_stats("   ", &overlap_stats);
+    printf("   Overlap: %.0f%% of the shorter phase hidden\n\n", hidden * 100.0);
+    
+    long long operations = (long long)dev->global_work_size * overlap.operations_per_work_item;
+    report_add("overlap", dev->isa, (int)dev->global_work_size, operations,
+               operations * desc->flops_per_iteration, &overlap_stats);
+    return 0;
+}
+
+// The selected transfer tests, numbered from `index`; 0, or -1 on error
+static int run_transfers(gpu_device_t *dev, const bench_options_t *opts, int index) {
+    int sweep = options_kernel_selected(opts, "transfer");
+    int latency = options_kernel_selected(opts, "latency");
+    int overlap = options_kernel_selected(opts, "overlap");
+    transfer_t t;
+    int status = 0;
+    
+    if (!sweep && !latency && !overlap) return 0;
+    if (open_transfers(dev, &t) != 0) return -1;
+    
+    if (sweep) status = transfer_sweep(dev, &t, index++);
+    if (status == 0 && latency) status = latency_test(dev, &t, index++);
+    if (status == 0 && overlap) status = overlap_test(dev, &t, opts, index++);
+    
+    close_transfers(&t);
+    return status;
+}
+
+// Every selected kernel on one device; returns 0, or -1 on error
+static int run_device(gpu_device_t *dev, int d, const bench_options_t *opts) {
+    printf("--- Device %d: %s (%s) ---\n", d, dev->name, dev->platform);
+    printf("Compute Units: %u\n", dev->compute_units);
+    printf("Max Work Group Size: %zu\n", dev->max_work_group_size);
+    printf("Precisions:");
+    for (int q = 0; q < NUM_PRECISIONS; q++) {
+        printf(" %s %s%s", precisions[q].label, dev->supported[q] ? "yes" : "no", q + 1 < NUM_PRECISIONS ? "," : "");
+    }
+    printf("\n");
+    
+    if (open_device(dev, opts) != 0 || choose_geometry(dev, opts) != 0) return -1;
+    
+    printf("Timer: OpenCL profiling events (%zu ns resolution), warm-up %.0f ms\n",
+           dev->timer_resolution, warmup_seconds() * 1000.0);
+    if (dev->energy_source != GPU_ENERGY_NONE) printf("Energy: %s\n\n", gpu_energy_names[dev->energy_source]);
+    else printf("Energy: unavailable (no NVML, hwmon energy counter or shared host RAPL)\n\n");
+    
+    int index = 1;
+    for (int k = 0; k < NUM_GPU_KERNELS; k++) {
+        const gpu_kernel_t *desc = &gpu_kernels[k];
+        kernel_result_t result;
+        
+        if (!options_kernel_selected(opts, desc->name)) continue;
+        if (!dev->supported[desc->precision]) {
+            printf("%d. %s: skipped (no %s)\n\n", index++, desc->title, precisions[desc->precision].extension);
+            continue;
+        }
+        if (benchmark_kernel(dev, k, index++, opts, &result) != 0) return -1;
+        
+        // Fastest kernel per precision
+        if (result.mflops > dev->best[desc->precision].mflops) dev->best[desc->precision] = result;
+    }
+    return run_transfers(dev, opts, index);
+}
+
+// Each device's peak per precision, other precisions as a ratio to FP32
+static void print_device_summary(const gpu_device_t *dev, int d) {
+    const kernel_result_t *fp32 = &dev->best[PRECISION_FP32];
+    
+    printf("Device %d: %s\n", d, dev->name);
+    for (int q = 0; q < NUM_PRECISIONS; q++) {
+        const kernel_result_t *best = &dev->best[q];
+        if (best->kernel < 0) continue;
+        printf("   %s peak: %.2f GFLOPS (%s)", precisions[q].label, best->mflops / 1000.0,
+               gpu_kernels[best->kernel].title);
+        if (q != PRECISION_FP32 && fp32->kernel >= 0) {
+            double ratio = best->mflops / fp32->mflops;
+            if (ratio < 1.0) printf(", 1:%.0f of FP32", 1.0 / ratio);
+            else printf(", %.2fx FP32", ratio);
+        }
+        if (best->gflops_per_watt > 0.0) printf(", %.3f GFLOPS/W", best->gflops_per_watt);
+        printf("\n");
+    }
+    if (dev->transfer_gbps[TRANSFER_H2D_PINNED] > 0.0) {
+        printf("   Transfers: H2D %.2f GB/s pinned, %.2f pageable; D2H %.2f pinned, %.2f pageable; "
+               "D2D %.2f GB/s (read + write)\n",
+               dev->transfer_gbps[TRANSFER_H2D_PINNED], dev->transfer_gbps[TRANSFER_H2D_PAGEABLE],
+               dev->transfer_gbps[TRANSFER_D2H_PINNED], dev->transfer_gbps[TRANSFER_D2H_PAGEABLE],
+               dev->transfer_gbps[TRANSFER_D2D]);
+    }
+    if (dev->latency_us[0] > 0.0) {
+        printf("   Latency: H2D %.2f us, D2H %.2f us\n", dev->latency_us[0], dev->latency_us[1]);
+    }
+}
+
+// One host thread driving one device during the concurrent run
+typedef struct {
+    launch_t launch;
+    long long operations_per_work_item;
+    int rounds;
+    pthread_barrier_t *barrier;     // releases all devices together each round
+    double start[MAX_TRIALS];       // host clock
+    double end[MAX_TRIALS];
+    double device_seconds[MAX_TRIALS];
+    int failed;
+} corun_t;
+
+static void *corun_thread(void *arg) {
+    corun_t *run = arg;
+    
+    timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &run->launch);
+    
+    // Every thread takes part in every round, even after a failed launch,
+    // so the barrier cannot deadlock
+    for (int r = 0; r < run->rounds; r++) {
+        pthread_barrier_wait(run->barrier);
+        run->start[r] = get_time();
+        run->device_seconds[r] = timed_launch(run->operations_per_work_item, &run->launch);
+        run->end[r] = get_time();
+        if (run->device_seconds[r] < 0.0) run->failed = 1;
+    }
+    return NULL;
+}
+
+// Every device's fastest FP32 kernel at once, one queue and host thread per
+// device. Rounds start together; a round lasts from the first start to the
+// last completion. Returns 0, or -1 on error.
+static int run_concurrent(gpu_device_t *devices, int count) {
+    static corun_t runs[MAX_GPU_DEVICES];
+    pthread_t threads[MAX_GPU_DEVICES];
+    pthread_barrier_t barrier;
+    double flops_per_round = 0.0;
+    double individual_mflops = 0.0;
+    long long total_operations = 0;
+    int total_work_items = 0;
+    int rounds = 1;
+    int failed = 0;
+    
+    for (int d = 0; d < count; d++) {
+        const kernel_result_t *best = &devices[d].best[PRECISION_FP32];
+        if (best->kernel < 0) {
+            printf("Skipping concurrent run: no FP32 result for device %d\n", d);
+            return 0;
+        }
+        if (best->stats.count > rounds) rounds = best->stats.count;
+    }
+    
+    printf("\n=== Concurrent Run (%d devices) ===\n", count);
+    pthread_barrier_init(&barrier, NULL, (unsigned)count);
+    
+    for (int d = 0; d < count; d++) {
+        gpu_device_t *dev = &devices[d];
+        const kernel_result_t *best = &dev->best[PRECISION_FP32];
+        const gpu_kernel_t *desc = &gpu_kernels[best->kernel];
+        corun_t *run = &runs[d];
+        
+        memset(run, 0, sizeof(*run));
+        run->launch.queue = dev->queue;
+        run->launch.kernel = create_kernel(dev, desc);
+        run->launch.global_work_size = dev->global_work_size;
+        run->launch.local_work_size = dev->local_work_size;
+        run->operations_per_work_item = best->operations_per_work_item;
+        run->rounds = rounds;
+        run->barrier = &barrier;
+        if (!run->launch.kernel) {
+            for (int e = 0; e < d; e++) clReleaseKernel(runs[e].launch.kernel);
+            pthread_barrier_destroy(&barrier);
+            return -1;
+        }
+        
+        long long operations = (long long)dev->global_work_size * best->operations_per_work_item;
+        flops_per_round += operations * desc->flops_per_iteration;
+        total_operations += operations;
+        total_work_items += (int)dev->global_work_size;
+        individual_mflops += best->mflops;
+    }
+    
+    for (int d = 0; d < count; d++) pthread_create(&threads[d], NULL, corun_thread, &runs[d]);
+    for (int d = 0; d < count; d++) pthread_join(threads[d], NULL);
+    pthread_barrier_destroy(&barrier);
+    
+    // Each device against its own run alone, on the device timer
+    for (int d = 0; d < count; d++) {
+        const gpu_device_t *dev = &devices[d];
+        const kernel_result_t *best = &dev->best[PRECISION_FP32];
+        const gpu_kernel_t *desc = &gpu_kernels[best->kernel];
+        corun_t *run = &runs[d];
+        trial_stats_t stats;
+        char name[48];
+        
+        clReleaseKernel(run->launch.kernel);
+        if (run->failed) {
+            failed = 1;
+            continue;
+        }
+        compute_stats(run->device_seconds, rounds, &stats);
+        
+        long long operations = (long long)dev->global_work_size * run->operations_per_work_item;
+        double flops = operations * desc->flops_per_iteration;
+        double mflops = (flops / stats.median) / 1000000.0;
+        printf("Device %d: %s: %.2f GFLOPS alone, %.2f GFLOPS concurrent (%.2fx slowdown)\n",
+               d, desc->name, best->mflops / 1000.0, mflops / 1000.0, stats.median / best->stats.median);
+        
+        snprintf(name, sizeof(name), "%s_concurrent", desc->name);
+        report_add(name, dev->isa, (int)dev->global_work_size, operations, flops, &stats);
+    }
+    if (failed) return -1;
+    
+    // Node aggregate over the round windows
+    double windows[MAX_TRIALS];
+    trial_stats_t stats;
+    for (int r = 0; r < rounds; r++) {
+        double first = runs[0].start[r], last = runs[0].end[r];
+        for (int d = 1; d < count; d++) {
+            if (runs[d].start[r] < first) first = runs[d].start[r];
+            if (runs[d].end[r] > last) last = runs[d].end[r];
+        }
+        windows[r] = last - first;
+    }
+    compute_stats(windows, rounds, &stats);
+    
+    double mflops = (flops_per_round / stats.median) / 1000000.0;
+    printf("Aggregate: %.2f GFLOPS over %d rounds (sum of individual runs: %.2f GFLOPS, %.1f%% efficiency)\n",
+           mflops / 1000.0, rounds, individual_mflops / 1000.0, 100.0 * mflops / individual_mflops);
+    print_trial_stats("   ", &stats);
+    
+    char isa[64];
+    snprintf(isa, sizeof(isa), "opencl %d devices", count);
+    report_add("aggregate", isa, total_work_items, total_operations, flops_per_round, &stats);
+    return 0;
+}
+
+#ifdef HAVE_HOST_KERNELS
+// CPU+GPU co-run (--hetero): one host thread keeps flops_kernel in flight on
+// an out-of-order queue while the other host threads run the SIMD peak kernel
+#define HETERO_KERNEL 0                     // flops_kernel
+#define HETERO_LAUNCH_SECONDS 0.02          // per launch, unless --ops / --time
+#define HETERO_BATCH 16                     // launches per round
+#define HETERO_IN_FLIGHT 4                  // enqueued ahead of completion
+
+// GPU side of a round: the feeder enqueues, completion callbacks count
+typedef struct {
+    launch_t launch;
+    int operations;                     // per work item
+    pthread_mutex_t lock;
+    pthread_cond_t completion;
+    int completed;
+    int failed;
+    double busy_seconds;                // device execution time of the round, summed over launches
+} gpu_feed_t;
+
+static void CL_CALLBACK feed_complete(cl_event event, cl_int status, void *user_data) {
+    gpu_feed_t *feed = user_data;
+    cl_ulong start_ns = 0, end_ns = 0;
+    
+    if (status == CL_COMPLETE) {
+        clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start_ns), &start_ns, NULL);
+        clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end_ns), &end_ns, NULL);
+    }
+    pthread_mutex_lock(&feed->lock);
+    if (status != CL_COMPLETE) feed->failed = 1;
+    feed->busy_seconds += (end_ns - start_ns) * 1e-9;
+    feed->completed++;
+    pthread_cond_signal(&feed->completion);
+    pthread_mutex_unlock(&feed->lock);
+    clReleaseEvent(event);
+}
+
+// HETERO_BATCH launches, at most HETERO_IN_FLIGHT outstanding. Returns the
+// host-clock seconds from the first enqueue to the last completion, or a
+// negative value if a launch failed.
+static double gpu_feed_round(gpu_feed_t *feed) {
+    launch_t *launch = &feed->launch;
+    int issued = 0;
+    
+    clSetKernelArg(launch->kernel, 1, sizeof(int), &feed->operations);
+    pthread_mutex_lock(&feed->lock);
+    feed->completed = 0;
+    feed->failed = 0;
+    feed->busy_seconds = 0.0;
+    pthread_mutex_unlock(&feed->lock);
+    
+    double start_time = get_time();
+    for (;;) {
+        // The lock is not held across enqueues: a callback may run on this
+        // thread if its event has already completed
+        pthread_mutex_lock(&feed->lock);
+        while (feed->completed < issued &&
+               (issued - feed->completed >= HETERO_IN_FLIGHT || issued == HETERO_BATCH || feed->failed)) {
+            pthread_cond_wait(&feed->completion, &feed->lock);
+        }
+        int done = feed->completed == issued && (issued == HETERO_BATCH || feed->failed);
+        pthread_mutex_unlock(&feed->lock);
+        if (done) break;
+        
+        cl_event event;
+        cl_int err = clEnqueueNDRangeKernel(launch->queue, launch->kernel, 1, NULL, &launch->global_work_size,
+                                            launch->local_work_size ? &launch->local_work_size : NULL,
+                                            0, NULL, &event);
+        if (err != CL_SUCCESS) {
+            printf("Error executing kernel: %d\n", err);
+            pthread_mutex_lock(&feed->lock);
+            feed->failed = 1;
+            pthread_mutex_unlock(&feed->lock);
+            continue;
+        }
+        issued++;
+        if (clSetEventCallback(event, CL_COMPLETE, feed_complete, feed) != CL_SUCCESS) {
+            clWaitForEvents(1, &event);
+            cl_int status = CL_COMPLETE;
+            clGetEventInfo(event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+            feed_complete(event, status, feed);
+        }
+        clFlush(launch->queue);
+    }
+    double elapsed = get_time() - start_time;
+    return feed->failed ? -1.0 : elapsed;
+}
+
+// Host peak kernel on `threads` OpenMP threads, for --time calibration
+typedef struct {
+    const simd_kernels_t *simd;
+    int threads;
+} host_peak_t;
+
+static double host_peak_run(long long operations, void *context) {
+    const host_peak_t *host = context;
+    return host->simd->multithreaded_peak(operations, host->threads);
+}
+
+// The feeder thread: rounds of gpu_feed_round on its own CPU, under the
+// trial policy when alone, or `rounds` rounds in step with the host threads
+typedef struct {
+    gpu_feed_t *feed;
+    int cpu_slot;                       // affinity slot the host threads leave free
+    int rounds;                         // 0: alone, until the trials settle
+    pthread_barrier_t *barrier;         // releases both sides together each round
+    double start[MAX_TRIALS];           // host clock
+    double end[MAX_TRIALS];
+    double seconds[MAX_TRIALS];
+    double busy_seconds;                // summed over rounds
+    int count;
+    int failed;
+} feeder_t;
+
+static void *feeder_thread(void *arg) {
+    feeder_t *feeder = arg;
+    trial_set_t trials;
+    
+    affinity_bind_thread(feeder->cpu_slot);
+    feeder->busy_seconds = 0.0;
+    feeder->count = 0;
+    
+    // Both sides take part in every round, even after a failed one, so the
+    // barrier cannot deadlock
+    for (trials_begin(&trials); feeder->rounds ? feeder->count < feeder->rounds : trials_continue(&trials); ) {
+        if (feeder->barrier) pthread_barrier_wait(feeder->barrier);
+        feeder->start[feeder->count] = get_time();
+        double elapsed = gpu_feed_round(feeder->feed);
+        feeder->end[feeder->count] = get_time();
+        if (elapsed < 0.0) {
+            feeder->failed = 1;
+            if (!feeder->rounds) break;
+        }
+        feeder->busy_seconds += feeder->feed->busy_seconds;
+        feeder->seconds[feeder->count++] = elapsed;
+        trials_add(&trials, elapsed);
+    }
+    return NULL;
+}
+
+static void print_side(const char *indent, const char *side, double gflops, double alone_gflops) {
+    printf("%s%s: %.2f GFLOPS", indent, side, gflops);
+    if (alone_gflops > 0.0) printf(" (%.1f%% of alone)", 100.0 * gflops / alone_gflops);
+    printf("\n");
+}
+
+// The co-run on `dev`: the GPU alone, the host alone, then both at once for
+// as many rounds as the longer of the two. Returns 0, or 1 on error.
+static int hetero_mode(gpu_device_t *dev, int d, const bench_options_t *opts) {
+    const gpu_kernel_t *desc = &gpu_kernels[HETERO_KERNEL];
+    cl_int err;
+    int status = 1;
+    
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    const simd_kernels_t *simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    if (!simd) {
+        printf("No supported SIMD instruction set found\n");
         return 1;
     }
     
-    clFinish(queue); // Wait for completion
+    // One CPU of the plan is left to the feeder; on a single CPU they share it
+    int cpus = affinity_default_threads();
+    host_peak_t host = { simd, cpus > 1 ? cpus - 1 : 1 };
     
-    double end_time = get_time();
-    double elapsed = end_time - start_time;
+    printf("--- Device %d: %s (%s) ---\n", d, dev->name, dev->platform);
+    if (open_device(dev, opts) != 0 || choose_geometry(dev, opts) != 0) return 1;
     
-    // Calculate performance
-    long long total_operations = (long long)global_work_size * operations_per_work_item;
-    double total_flops = total_operations * 4.0; // 4 FP ops per iteration (FMA + mul + add)
-    double mflops = (total_flops / elapsed) / 1000000.0;
+    cl_command_queue queue = clCreateCommandQueue(dev->context, dev->device,
+                                                  CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_PROFILING_ENABLE,
+                                                  &err);
+    int out_of_order = err == CL_SUCCESS;
+    if (!out_of_order) queue = clCreateCommandQueue(dev->context, dev->device, CL_QUEUE_PROFILING_ENABLE, &err);
+    if (err != CL_SUCCESS) {
+        printf("Error creating command queue: %d\n", err);
+        return 1;
+    }
+    cl_kernel kernel = create_kernel(dev, desc);
+    if (!kernel) {
+        clReleaseCommandQueue(queue);
+        return 1;
+    }
     
-    printf("Elapsed time: %.6f seconds\n", elapsed);
-    printf("Total operations: %lld\n", total_operations);
-    printf("Total FLOPS: %.0f\n", total_flops);
-    printf("GPU MFLOPS: %.2f (%.2f GFLOPS)\n", mflops, mflops / 1000.0);
+    static gpu_feed_t feed;
+    static feeder_t feeder;
+    pthread_t thread;
+    pthread_barrier_t barrier;
+    memset(&feed, 0, sizeof(feed));
+    memset(&feeder, 0, sizeof(feeder));
+    feed.launch = (launch_t){ queue, kernel, dev->global_work_size, dev->local_work_size, 0.0 };
+    pthread_mutex_init(&feed.lock, NULL);
+    pthread_cond_init(&feed.completion, NULL);
+    feeder.feed = &feed;
+    feeder.cpu_slot = cpus > 1 ? host.threads : 0;
     
-    // Cleanup
-    clReleaseMemObject(buffer);
+    printf("\n=== CPU+GPU Co-run ===\n");
+    printf("GPU: %s, %zu work items, %d launches per round, %d in flight, %s queue, completion callbacks\n",
+           desc->name, dev->global_work_size, HETERO_BATCH, HETERO_IN_FLIGHT,
+           out_of_order ? "out-of-order" : "in-order (out-of-order unsupported)");
+    printf("Host: %s peak kernel (%d accumulators), %d OpenMP threads; fed from thread %d%s\n",
+           simd->name, PEAK_ACCUMULATORS, host.threads, feeder.cpu_slot,
+           cpus > 1 ? "" : " (sharing the only CPU)");
+    affinity_print_map(cpus);
+    printf("\n");
+    
+    // GPU alone: one launch calibrated to HETERO_LAUNCH_SECONDS
+    bench_options_t gpu_opts = *opts;
+    if (gpu_opts.operations == 0 && gpu_opts.target_seconds <= 0.0) gpu_opts.target_seconds = HETERO_LAUNCH_SECONDS;
+    timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &feed.launch);
+    long long operations_per_work_item = options_operations(&gpu_opts, timed_launch, &feed.launch, 1,
+                                                            DEFAULT_OPERATIONS_PER_WORK_ITEM);
+    if (operations_per_work_item > INT_MAX) operations_per_work_item = INT_MAX;
+    feed.operations = (int)operations_per_work_item;
+    long long gpu_operations = (long long)dev->global_work_size * operations_per_work_item * HETERO_BATCH;
+    double gpu_flops = gpu_operations * desc->flops_per_iteration;
+    trial_stats_t gpu_alone, host_alone, stats;
+    
+    pthread_create(&thread, NULL, feeder_thread, &feeder);
+    pthread_join(thread, NULL);
+    if (feeder.failed) goto done;
+    compute_stats(feeder.seconds, feeder.count, &gpu_alone);
+    double gpu_alone_gflops = gpu_flops / gpu_alone.median / 1e9;
+    
+    printf("1. GPU alone:\n");
+    printf("   Operations per work item: %lld\n", operations_per_work_item);
+    printf("   Round time: %.6f seconds (host clock, median of %d rounds), device busy %.1f%%\n",
+           gpu_alone.median, gpu_alone.count, 100.0 * feeder.busy_seconds / (gpu_alone.mean * gpu_alone.count));
+    print_trial_stats("   ", &gpu_alone);
+    printf("   GPU GFLOPS: %.2f\n\n", gpu_alone_gflops);
+    report_add("hetero_gpu", dev->isa, (int)dev->global_work_size, gpu_operations, gpu_flops, &gpu_alone);
+    
+    // Host alone: calibrated to the GPU round, so the two sides overlap
+    bench_options_t host_opts = *opts;
+    host_opts.operations = 0;
+    host_opts.target_seconds = gpu_alone.median;
+    warmup_t warmup;
+    for (warmup_start(&warmup); warmup_running(&warmup); ) {
+        host_peak_run(PEAK_ACCUMULATORS * 100000LL, &host);
+    }
+    long long host_operations = options_operations(&host_opts, host_peak_run, &host, PEAK_ACCUMULATORS,
+                                                   PEAK_ACCUMULATORS * 10000000LL);
+    double host_flops = kernel_flops(simd->peak_flops, host_operations);
+    double host_reference = verify_peak_reference(host_operations / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS,
+                                                  simd->lanes, host.threads);
+    trial_set_t trials;
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, host_peak_run(host_operations, &host));
+    }
+    trials_summarize(&trials, &host_alone);
+    double host_alone_gflops = host_flops / host_alone.median / 1e9;
+    
+    printf("2. Host alone:\n");
+    printf("   Operations: %lld\n", host_operations);
+    printf("   Time: %.6f seconds (median of %d trials)\n", host_alone.median, host_alone.count);
+    print_trial_stats("   ", &host_alone);
+    printf("   CPU GFLOPS: %.2f\n", host_alone_gflops);
+    verify_print("   ", kernel_checksum, host_reference, verify_checksum(kernel_checksum, host_reference));
+    printf("\n");
+    report_add("hetero_cpu", simd->name, host.threads, host_operations, host_flops, &host_alone);
+    
+    // Both at once, in rounds released together
+    int rounds = gpu_alone.count > host_alone.count ? gpu_alone.count : host_alone.count;
+    double host_seconds[MAX_TRIALS];
+    double host_start[MAX_TRIALS];
+    double host_end[MAX_TRIALS];
+    pthread_barrier_init(&barrier, NULL, 2);
+    feeder.rounds = rounds;
+    feeder.barrier = &barrier;
+    pthread_create(&thread, NULL, feeder_thread, &feeder);
+    for (int r = 0; r < rounds; r++) {
+        pthread_barrier_wait(&barrier);
+        host_start[r] = get_time();
+        host_seconds[r] = host_peak_run(host_operations, &host);
+        host_end[r] = get_time();
+    }
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&barrier);
+    if (feeder.failed) goto done;
+    
+    trial_stats_t gpu_corun, host_corun;
+    compute_stats(feeder.seconds, rounds, &gpu_corun);
+    compute_stats(host_seconds, rounds, &host_corun);
+    double gpu_corun_gflops = gpu_flops / gpu_corun.median / 1e9;
+    double host_corun_gflops = host_flops / host_corun.median / 1e9;
+    
+    // System throughput over the round windows, first start to last end
+    double windows[MAX_TRIALS];
+    for (int r = 0; r < rounds; r++) {
+        double first = host_start[r] < feeder.start[r] ? host_start[r] : feeder.start[r];
+        double last = host_end[r] > feeder.end[r] ? host_end[r] : feeder.end[r];
+        windows[r] = last - first;
+    }
+    compute_stats(windows, rounds, &stats);
+    double system_gflops = (gpu_flops + host_flops) / stats.median / 1e9;
+    double alone_sum = gpu_alone_gflops + host_alone_gflops;
+    
+    printf("3. Co-run (%d rounds):\n", rounds);
+    print_side("   ", "GPU", gpu_corun_gflops, gpu_alone_gflops);
+    printf("      Round time: %.6f seconds, device busy %.1f%%\n", gpu_corun.median,
+           100.0 * feeder.busy_seconds / (gpu_corun.mean * rounds));
+    print_side("   ", "CPU", host_corun_gflops, host_alone_gflops);
+    verify_print("      ", kernel_checksum, host_reference, verify_checksum(kernel_checksum, host_reference));
+    printf("   System: %.2f GFLOPS (sum alone: %.2f GFLOPS, %.1f%%)\n", system_gflops, alone_sum,
+           100.0 * system_gflops / alone_sum);
+    print_trial_stats("   ", &stats);
+    
+    char isa[96];
+    report_add("hetero_gpu_corun", dev->isa, (int)dev->global_work_size, gpu_operations, gpu_flops, &gpu_corun);
+    report_add("hetero_cpu_corun", simd->name, host.threads, host_operations, host_flops, &host_corun);
+    snprintf(isa, sizeof(isa), "%s + %.64s", simd->name, dev->isa);
+    report_add("hetero_system", isa, host.threads + 1, gpu_operations + host_operations, gpu_flops + host_flops,
+               &stats);
+    
+    printf("\n=== Co-run Summary ===\n");
+    printf("GPU: %.2f GFLOPS alone, %.2f GFLOPS co-run\n", gpu_alone_gflops, gpu_corun_gflops);
+    printf("CPU: %.2f GFLOPS alone, %.2f GFLOPS co-run\n", host_alone_gflops, host_corun_gflops);
+    printf("System: %.2f GFLOPS\n", system_gflops);
+    status = verify_failures() != 0;
+
+done:
+    if (feeder.failed) printf("GPU launches failed, co-run aborted\n");
+    pthread_mutex_destroy(&feed.lock);
+    pthread_cond_destroy(&feed.completion);
     clReleaseKernel(kernel);
-    clReleaseProgram(program);
     clReleaseCommandQueue(queue);
-    clReleaseContext(context);
+    return status;
+}
+#endif
+
+// One kernel of one device, compiled once for the daemon's lifetime
+typedef struct {
+    gpu_device_t *dev;
+    int kernel;                         // gpu_kernels index
+    cl_kernel cl_kernel;
+    bench_options_t opts;               // fixed --ops once calibrated
+} gpu_probe_t;
+
+typedef struct {
+    gpu_probe_t probes[MAX_GPU_DEVICES * NUM_GPU_KERNELS];
+    int count;
+} gpu_daemon_t;
+
+static int gpu_daemon_probe(void *context) {
+    gpu_daemon_t *daemon = context;
+    int failed = 0;
     
-    return 0;
+    for (int i = 0; i < daemon->count; i++) {
+        gpu_probe_t *probe = &daemon->probes[i];
+        gpu_device_t *dev = probe->dev;
+        const gpu_kernel_t *desc = &gpu_kernels[probe->kernel];
+        launch_t launch = { dev->queue, probe->cl_kernel, dev->global_work_size, dev->local_work_size, 0.0 };
+        warmup_t warmup;
+        trial_set_t trials;
+        trial_stats_t stats;
+        
+        for (warmup_start(&warmup); warmup_running(&warmup); ) {
+            timed_launch(WARMUP_OPERATIONS_PER_WORK_ITEM, &launch);
+        }
+        long long operations_per_work_item = options_operations(&probe->opts, timed_launch, &launch, 1,
+                                                                DEFAULT_OPERATIONS_PER_WORK_ITEM);
+        if (operations_per_work_item > INT_MAX) operations_per_work_item = INT_MAX;
+        probe->opts.operations = operations_per_work_item;
+        probe->opts.target_seconds = 0.0;
+        
+        int ok = 1;
+        gpu_energy_start(dev);
+        for (trials_begin(&trials); trials_continue(&trials) && ok; ) {
+            double elapsed = timed_launch(operations_per_work_item, &launch);
+            if (elapsed < 0.0) ok = 0;
+            else trials_add(&trials, elapsed);
+        }
+        double energy_seconds;
+        double joules = gpu_energy_stop(dev, &energy_seconds);
+        if (!ok || trials.count == 0) {
+            failed = 1;
+            continue;
+        }
+        trials_summarize(&trials, &stats);
+        
+        double flops = (double)dev->global_work_size * operations_per_work_item * desc->flops_per_iteration;
+        daemon_publish(desc->name, dev->isa, (int)dev->global_work_size, "gflops", flops / stats.median / 1e9,
+                       &stats);
+        if (joules > 0.0) {
+            daemon_publish_gauge(desc->name, dev->isa, (int)dev->global_work_size, "gflops_per_watt",
+                                 flops * stats.count / joules / 1e9);
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+// Resident mode: every device keeps its context, queue and compiled kernels
+// between probes. Without --kernels only the peak kernels are probed.
+static int gpu_daemon_mode(gpu_device_t *devices, int count, const bench_options_t *opts) {
+    static gpu_daemon_t daemon;
+    int opened = 0;
+    
+    for (int d = 0; d < count; d++) {
+        gpu_device_t *dev = &devices[d];
+        printf("--- Device %d: %s (%s) ---\n", d, dev->name, dev->platform);
+        if (open_device(dev, opts) != 0 || choose_geometry(dev, opts) != 0) {
+            printf("Device %d failed, not probed\n", d);
+            continue;
+        }
+        opened++;
+        
+        for (int k = 0; k < NUM_GPU_KERNELS; k++) {
+            const gpu_kernel_t *desc = &gpu_kernels[k];
+            if (!dev->supported[desc->precision]) continue;
+            if (opts->kernels ? !options_kernel_selected(opts, desc->name) : strncmp(desc->name, "peak_", 5) != 0) {
+                continue;
+            }
+            gpu_probe_t *probe = &daemon.probes[daemon.count];
+            probe->cl_kernel = create_kernel(dev, desc);
+            if (!probe->cl_kernel) continue;
+            probe->dev = dev;
+            probe->kernel = k;
+            probe->opts = *opts;
+            if (probe->opts.operations == 0 && probe->opts.target_seconds <= 0.0) {
+                probe->opts.target_seconds = GPU_DAEMON_PROBE_SECONDS;
+            }
+            daemon.count++;
+        }
+    }
+    printf("\n");
+    if (opened == 0 || daemon.count == 0) {
+        printf("No device kernels to probe\n");
+        return 1;
+    }
+    
+    int status = daemon_run("gpu", gpu_daemon_probe, &daemon);
+    for (int i = 0; i < daemon.count; i++) clReleaseKernel(daemon.probes[i].cl_kernel);
+    return status != 0;
+}
+
+int main(int argc, char **argv) {
+    static gpu_device_t devices[MAX_GPU_DEVICES];
+    int failed = 0;
+    
+    bench_options_t opts;
+    int status = options_parse(argc, argv, GPU_KERNEL_NAMES, GPU_FLAG_NAMES, &opts);
+    if (status) return status < 0;
+    report_begin("gpu", opts.format);
+    
+    printf("=== GPU/OpenCL Benchmark ===\n");
+    int count = enumerate_devices(devices, MAX_GPU_DEVICES);
+    if (count == 0) {
+        printf("No OpenCL device found\n");
+        return 1;
+    }
+    printf("OpenCL devices: %d\n", count);
+    for (int d = 0; d < count; d++) {
+        printf("   %d: %s (%s), %u compute units\n", d, devices[d].name, devices[d].platform,
+               devices[d].compute_units);
+    }
+    printf("\n");
+    
+    // Daemon mode replaces the standard run: --daemon / SISU_DAEMON
+    if (daemon_requested()) {
+        status = gpu_daemon_mode(devices, count, &opts);
+        for (int d = 0; d < count; d++) close_device(&devices[d]);
+        return status;
+    }
+    
+    // Co-run mode replaces the standard run: --hetero on|DEVICE / SISU_HETERO
+    const char *hetero = getenv("SISU_HETERO");
+    if (hetero && strcmp(hetero, "off") != 0) {
+        int d = strcmp(hetero, "on") == 0 ? 0 : atoi(hetero);
+        if (d < 0 || d >= count) {
+            printf("No OpenCL device %d\n", d);
+            return 1;
+        }
+#ifdef HAVE_HOST_KERNELS
+        status = hetero_mode(&devices[d], d, &opts);
+        report_finish();
+#else
+        printf("CPU+GPU co-run unavailable: built without OpenMP or SIMD kernels\n");
+        status = 1;
+#endif
+        for (int e = 0; e < count; e++) close_device(&devices[e]);
+        return status;
+    }
+    
+    // Each device alone
+    for (int d = 0; d < count; d++) {
+        if (run_device(&devices[d], d, &opts) != 0) {
+            printf("Device %d failed, continuing with the others\n\n", d);
+            failed = 1;
+        }
+    }
+    
+    // Summary
+    printf("=== GPU Summary ===\n");
+    for (int d = 0; d < count; d++) print_device_summary(&devices[d], d);
+    
+    // All devices at once
+    if (count > 1 && !failed && run_concurrent(devices, count) != 0) failed = 1;
+    report_finish();
+    
+    // Cleanup
+    for (int d = 0; d < count; d++) close_device(&devices[d]);
+    
+    return failed;
 }
@@ -0,0 +1,35 @@
+// AVX2 + FMA kernels: 4 doubles per vector
+#include <immintrin.h>
+
+#define ISA_NAME "avx2"
+#define KERNEL(name) name##_avx2
+#define VEC_T __m256d
+#define VEC_LANES 4
+#define VSET1(x) _mm256_set1_pd(x)
+#define VLOAD(p) _mm256_load_pd(p)
+#define VSTORE(p, v) _mm256_store_pd(p, v)
+#define VLOADU(p) _mm256_loadu_pd(p)
+#define VSTOREU(p, v) _mm256_storeu_pd(p, v)
+#define VFMADD(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define VMUL(a, b) _mm256_mul_pd(a, b)
+#define VADD(a, b) _mm256_add_pd(a, b)
+#define VDIV(a, b) _mm256_div_pd(a, b)
+#define VSQRT(a) _mm256_sqrt_pd(a)
+#define VGATHER(base, index) _mm256_i64gather_pd(base, _mm256_loadu_si256((const __m256i *)(index)), 8)
+#define VGATHER_NAME "vgatherqpd"
+#define VECS_T __m256
+#define VECS_LANES 8
+#define VSSET1(x) _mm256_set1_ps(x)
+#define VSLOAD(p) _mm256_load_ps(p)
+#define VSSTORE(p, v) _mm256_store_ps(p, v)
+#define VSFMADD(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define VSMUL(a, b) _mm256_mul_ps(a, b)
+#define VSADD(a, b) _mm256_add_ps(a, b)
+#define VSDIV(a, b) _mm256_div_ps(a, b)
+#define VSSQRT(a) _mm256_sqrt_ps(a)
+#define VFMADD_FUSED 1
+#define INSTR_MNEMONIC(x86, arm, suffix) "v" x86 suffix
+#define INSTR_SUFFIX_f64 "pd"
+#define INSTR_SUFFIX_f32 "ps"
+
+#include "kernels_template.h"
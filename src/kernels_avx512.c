@@ -0,0 +1,37 @@
+// AVX-512F kernels: 8 doubles per vector
+#include <immintrin.h>
+
+#define ISA_NAME "avx512"
+#define KERNEL(name) name##_avx512
+#define VEC_T __m512d
+#define VEC_LANES 8
+#define VSET1(x) _mm512_set1_pd(x)
+#define VLOAD(p) _mm512_load_pd(p)
+#define VSTORE(p, v) _mm512_store_pd(p, v)
+#define VLOADU(p) _mm512_loadu_pd(p)
+#define VSTOREU(p, v) _mm512_storeu_pd(p, v)
+#define VFMADD(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define VMUL(a, b) _mm512_mul_pd(a, b)
+#define VADD(a, b) _mm512_add_pd(a, b)
+#define VDIV(a, b) _mm512_div_pd(a, b)
+#define VSQRT(a) _mm512_sqrt_pd(a)
+#define VGATHER(base, index) _mm512_i64gather_pd(_mm512_loadu_si512(index), base, 8)
+#define VGATHER_NAME "vgatherqpd"
+#define VSCATTER(base, index, v) _mm512_i64scatter_pd(base, _mm512_loadu_si512(index), v, 8)
+#define VSCATTER_NAME "vscatterqpd"
+#define VECS_T __m512
+#define VECS_LANES 16
+#define VSSET1(x) _mm512_set1_ps(x)
+#define VSLOAD(p) _mm512_load_ps(p)
+#define VSSTORE(p, v) _mm512_store_ps(p, v)
+#define VSFMADD(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define VSMUL(a, b) _mm512_mul_ps(a, b)
+#define VSADD(a, b) _mm512_add_ps(a, b)
+#define VSDIV(a, b) _mm512_div_ps(a, b)
+#define VSSQRT(a) _mm512_sqrt_ps(a)
+#define VFMADD_FUSED 1
+#define INSTR_MNEMONIC(x86, arm, suffix) "v" x86 suffix
+#define INSTR_SUFFIX_f64 "pd"
+#define INSTR_SUFFIX_f32 "ps"
+
+#include "kernels_template.h"
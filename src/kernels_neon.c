@@ -0,0 +1,33 @@
+// AArch64 NEON (Advanced SIMD) kernels: 2 doubles per vector
+#include <arm_neon.h>
+
+#define ISA_NAME "neon"
+#define KERNEL(name) name##_neon
+#define VEC_T float64x2_t
+#define VEC_LANES 2
+#define VSET1(x) vdupq_n_f64(x)
+#define VLOAD(p) vld1q_f64(p)
+#define VSTORE(p, v) vst1q_f64(p, v)
+#define VLOADU(p) vld1q_f64(p)
+#define VSTOREU(p, v) vst1q_f64(p, v)
+#define VFMADD(a, b, c) vfmaq_f64(c, a, b)
+#define VMUL(a, b) vmulq_f64(a, b)
+#define VADD(a, b) vaddq_f64(a, b)
+#define VDIV(a, b) vdivq_f64(a, b)
+#define VSQRT(a) vsqrtq_f64(a)
+#define VECS_T float32x4_t
+#define VECS_LANES 4
+#define VSSET1(x) vdupq_n_f32(x)
+#define VSLOAD(p) vld1q_f32(p)
+#define VSSTORE(p, v) vst1q_f32(p, v)
+#define VSFMADD(a, b, c) vfmaq_f32(c, a, b)
+#define VSMUL(a, b) vmulq_f32(a, b)
+#define VSADD(a, b) vaddq_f32(a, b)
+#define VSDIV(a, b) vdivq_f32(a, b)
+#define VSSQRT(a) vsqrtq_f32(a)
+#define VFMADD_FUSED 1
+#define INSTR_MNEMONIC(x86, arm, suffix) arm suffix
+#define INSTR_SUFFIX_f64 ".2d"
+#define INSTR_SUFFIX_f32 ".4s"
+
+#include "kernels_template.h"
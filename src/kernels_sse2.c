@@ -0,0 +1,33 @@
+// SSE2 kernels: 2 doubles per vector, no FMA (multiply + add instead)
+#include <emmintrin.h>
+
+#define ISA_NAME "sse2"
+#define KERNEL(name) name##_sse2
+#define VEC_T __m128d
+#define VEC_LANES 2
+#define VSET1(x) _mm_set1_pd(x)
+#define VLOAD(p) _mm_load_pd(p)
+#define VSTORE(p, v) _mm_store_pd(p, v)
+#define VLOADU(p) _mm_loadu_pd(p)
+#define VSTOREU(p, v) _mm_storeu_pd(p, v)
+#define VFMADD(a, b, c) _mm_add_pd(_mm_mul_pd(a, b), c)
+#define VMUL(a, b) _mm_mul_pd(a, b)
+#define VADD(a, b) _mm_add_pd(a, b)
+#define VDIV(a, b) _mm_div_pd(a, b)
+#define VSQRT(a) _mm_sqrt_pd(a)
+#define VECS_T __m128
+#define VECS_LANES 4
+#define VSSET1(x) _mm_set1_ps(x)
+#define VSLOAD(p) _mm_load_ps(p)
+#define VSSTORE(p, v) _mm_store_ps(p, v)
+#define VSFMADD(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#define VSMUL(a, b) _mm_mul_ps(a, b)
+#define VSADD(a, b) _mm_add_ps(a, b)
+#define VSDIV(a, b) _mm_div_ps(a, b)
+#define VSSQRT(a) _mm_sqrt_ps(a)
+#define VFMADD_FUSED 0
+#define INSTR_MNEMONIC(x86, arm, suffix) x86 suffix
+#define INSTR_SUFFIX_f64 "pd"
+#define INSTR_SUFFIX_f32 "ps"
+
+#include "kernels_template.h"
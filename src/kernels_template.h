@@ -0,0 +1,576 @@
+// Vectorized kernel bodies shared by every ISA. Not a normal header: each
+// kernels_<isa>.c defines the vector type and operations below and then
+// includes this file once, producing `simd_kernels_<isa>`.
+//
+//   VEC_T                 vector of doubles
+//   VEC_LANES             doubles per vector
+//   ISA_NAME              name reported and accepted by select_simd_kernels()
+//   KERNEL(name)          appends the ISA suffix to `name`
+//   VSET1(x)              broadcast
+//   VLOAD(p) / VSTORE(p,v) aligned load / store
+//   VLOADU(p) / VSTOREU(p,v) unaligned load / store
+//   VFMADD(a,b,c)         a * b + c
+//   VMUL(a,b) / VADD(a,b) / VDIV(a,b) / VSQRT(a)
+//
+// optionally the ISA's indexed accesses (lane loops are used otherwise):
+//
+//   VGATHER(base, index)      base[index[0..VEC_LANES)] from 64-bit indices
+//   VSCATTER(base, index, v)  the reverse
+//   VGATHER_NAME / VSCATTER_NAME  the instruction, for the report
+//
+// and the same operations on floats for the op-mix kernels:
+//
+//   VECS_T, VECS_LANES    vector of floats, floats per vector
+//   VSSET1(x), VSSTORE(p,v), VSFMADD(a,b,c), VSMUL, VSADD, VSDIV, VSSQRT
+//
+// and, for the instruction tables:
+//
+//   VFMADD_FUSED          1 if VFMADD is a single fused instruction
+//   INSTR_MNEMONIC(x86, arm, suffix)  instruction name from INSTR_OPS
+//   INSTR_SUFFIX_f64 / INSTR_SUFFIX_f32  its element-type suffix
+
+#include <stdio.h>
+#include <math.h>
+#include <omp.h>
+#include "simd_kernels.h"
+#include "timing.h"
+#include "affinity.h"
+
+#define VEC_ALIGN __attribute__((aligned(sizeof(VEC_T))))
+
+static double KERNEL(horizontal_sum)(VEC_T v) {
+    VEC_ALIGN double lanes[VEC_LANES];
+    VSTORE(lanes, v);
+    double sum = 0.0;
+    for (int i = 0; i < VEC_LANES; i++) {
+        sum += lanes[i];
+    }
+    return sum;
+}
+
+// Latency-bound benchmark: one dependent FMA/mul/add chain, VEC_LANES wide
+static double KERNEL(vectorized_benchmark)(long long operations) {
+    VEC_ALIGN double a_vals[VEC_LANES];
+    VEC_ALIGN double b_vals[VEC_LANES];
+    VEC_ALIGN double r_vals[VEC_LANES];
+    for (int i = 0; i < VEC_LANES; i++) {
+        a_vals[i] = 1.1 + i * 0.1;
+        b_vals[i] = 2.1 + i * 0.1;
+        r_vals[i] = chain_start(a_vals[i], b_vals[i]);
+    }
+    
+    VEC_T a_vec = VLOAD(a_vals);
+    VEC_T b_vec = VLOAD(b_vals);
+    VEC_T result_vec = VLOAD(r_vals);
+    VEC_T mult_factor = VSET1(CHAIN_MULTIPLIER);
+    VEC_T add_factor = VSET1(CHAIN_ADDEND);
+    VEC_T steps_vec = VSET1(0.0);
+    VEC_T one = VSET1(1.0);
+    
+    double start_time = get_time();
+    
+    for (long long i = 0; i < operations / VEC_LANES; i++) {
+        result_vec = VFMADD(a_vec, b_vec, result_vec);
+        a_vec = VMUL(result_vec, mult_factor);
+        b_vec = VADD(a_vec, add_factor);
+        steps_vec = VADD(steps_vec, one);
+    }
+    
+    double end_time = get_time();
+    double elapsed = end_time - start_time;
+    
+    // Checked against verify_chain_reference; also keeps the chain live
+    kernel_checksum = KERNEL(horizontal_sum)(result_vec);
+    kernel_chain_steps = KERNEL(horizontal_sum)(steps_vec);
+    
+    return elapsed;
+}
+
+// Multi-threaded latency-bound benchmark
+static double KERNEL(multithreaded_vectorized_benchmark)(long long operations, int num_threads) {
+    volatile double global_result = 0.0;
+    double global_steps = 0.0;
+    
+    omp_set_num_threads(num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        int thread_id = omp_get_thread_num();
+        affinity_bind_thread(thread_id);
+        
+        VEC_ALIGN double a_vals[VEC_LANES];
+        VEC_ALIGN double b_vals[VEC_LANES];
+        VEC_ALIGN double r_vals[VEC_LANES];
+        for (int i = 0; i < VEC_LANES; i++) {
+            a_vals[i] = 1.1 + i * 0.1 + thread_id * 0.1;
+            b_vals[i] = 2.1 + i * 0.1 + thread_id * 0.1;
+            r_vals[i] = chain_start(a_vals[i], b_vals[i]);
+        }
+        
+        VEC_T a_vec = VLOAD(a_vals);
+        VEC_T b_vec = VLOAD(b_vals);
+        VEC_T result_vec = VLOAD(r_vals);
+        VEC_T mult_factor = VSET1(CHAIN_MULTIPLIER);
+        VEC_T add_factor = VSET1(CHAIN_ADDEND);
+        VEC_T steps_vec = VSET1(0.0);
+        VEC_T one = VSET1(1.0);
+        
+        long long ops_per_thread = thread_share(operations / VEC_LANES, thread_id, num_threads);
+        
+        for (long long i = 0; i < ops_per_thread; i++) {
+            result_vec = VFMADD(a_vec, b_vec, result_vec);
+            a_vec = VMUL(result_vec, mult_factor);
+            b_vec = VADD(a_vec, add_factor);
+            steps_vec = VADD(steps_vec, one);
+        }
+        
+        double thread_result = KERNEL(horizontal_sum)(result_vec);
+        double thread_steps = KERNEL(horizontal_sum)(steps_vec);
+        
+        #pragma omp atomic
+        global_result += thread_result;
+        #pragma omp atomic
+        global_steps += thread_steps;
+    }
+    
+    double end_time = get_time();
+    double elapsed = end_time - start_time;
+    
+    // Sum over threads, checked against the reference
+    kernel_checksum = global_result;
+    kernel_chain_steps = global_steps;
+    
+    return elapsed;
+}
+
+// Peak-throughput benchmark: PEAK_ACCUMULATORS independent FMA chains, so the
+// result measures FMA throughput rather than FMA latency
+static double KERNEL(peak_throughput_benchmark)(long long operations) {
+    VEC_T acc[PEAK_ACCUMULATORS];
+    VEC_T mult_factor = VSET1(PEAK_MULTIPLIER);
+    VEC_T add_factor = VSET1(PEAK_ADDEND);
+    
+    for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+        acc[j] = VSET1(peak_start(j, 0));
+    }
+    
+    long long iterations = operations / PEAK_ACCUMULATORS;
+    
+    double start_time = get_time();
+    
+    for (long long i = 0; i < iterations; i++) {
+        // Fully unrolled by the compiler: no chain depends on another
+        for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+            acc[j] = VFMADD(acc[j], mult_factor, add_factor);
+        }
+    }
+    
+    double end_time = get_time();
+    double elapsed = end_time - start_time;
+    
+    // Checked against verify_peak_reference; also keeps the chains live
+    VEC_T sum = acc[0];
+    for (int j = 1; j < PEAK_ACCUMULATORS; j++) {
+        sum = VADD(sum, acc[j]);
+    }
+    kernel_checksum = KERNEL(horizontal_sum)(sum);
+    
+    return elapsed;
+}
+
+// Multi-threaded peak-throughput benchmark
+static double KERNEL(multithreaded_peak_benchmark)(long long operations, int num_threads) {
+    volatile double global_result = 0.0;
+    
+    omp_set_num_threads(num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        int thread_id = omp_get_thread_num();
+        affinity_bind_thread(thread_id);
+        
+        VEC_T acc[PEAK_ACCUMULATORS];
+        VEC_T mult_factor = VSET1(PEAK_MULTIPLIER);
+        VEC_T add_factor = VSET1(PEAK_ADDEND);
+        
+        for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+            acc[j] = VSET1(peak_start(j, thread_id));
+        }
+        
+        long long iterations = thread_share(operations / PEAK_ACCUMULATORS, thread_id, num_threads);
+        
+        for (long long i = 0; i < iterations; i++) {
+            for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+                acc[j] = VFMADD(acc[j], mult_factor, add_factor);
+            }
+        }
+        
+        VEC_T sum = acc[0];
+        for (int j = 1; j < PEAK_ACCUMULATORS; j++) {
+            sum = VADD(sum, acc[j]);
+        }
+        double thread_result = KERNEL(horizontal_sum)(sum);
+        
+        #pragma omp atomic
+        global_result += thread_result;
+    }
+    
+    double end_time = get_time();
+    double elapsed = end_time - start_time;
+    
+    // Sum over threads, checked against the reference
+    kernel_checksum = global_result;
+    
+    return elapsed;
+}
+
+// STREAM kernels: plain loops, auto-vectorized with this ISA's flags
+static void KERNEL(stream_copy)(double *restrict c, const double *restrict a, long long n) {
+    for (long long i = 0; i < n; i++) {
+        c[i] = a[i];
+    }
+}
+
+static void KERNEL(stream_scale)(double *restrict b, const double *restrict c, double scalar, long long n) {
+    for (long long i = 0; i < n; i++) {
+        b[i] = scalar * c[i];
+    }
+}
+
+static void KERNEL(stream_add)(double *restrict c, const double *restrict a, const double *restrict b, long long n) {
+    for (long long i = 0; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+static void KERNEL(stream_triad)(double *restrict a, const double *restrict b, const double *restrict c, double scalar, long long n) {
+    for (long long i = 0; i < n; i++) {
+        a[i] = b[i] + scalar * c[i];
+    }
+}
+
+#ifndef VGATHER
+static inline VEC_T KERNEL(gather_lanes)(const double *base, const long long *index) {
+    VEC_ALIGN double lanes[VEC_LANES];
+    for (int l = 0; l < VEC_LANES; l++) {
+        lanes[l] = base[index[l]];
+    }
+    return VLOAD(lanes);
+}
+#define VGATHER(base, index) KERNEL(gather_lanes)(base, index)
+#define VGATHER_NAME "scalar loads"
+#endif
+
+#ifndef VSCATTER
+static inline void KERNEL(scatter_lanes)(double *base, const long long *index, VEC_T v) {
+    VEC_ALIGN double lanes[VEC_LANES];
+    VSTORE(lanes, v);
+    for (int l = 0; l < VEC_LANES; l++) {
+        base[index[l]] = lanes[l];
+    }
+}
+#define VSCATTER(base, index, v) KERNEL(scatter_lanes)(base, index, v)
+#define VSCATTER_NAME "scalar stores"
+#endif
+
+// dst[i] = table[index[i]], VEC_LANES elements per gather
+static void KERNEL(gather_kernel)(double *restrict dst, const double *restrict table, const long long *restrict index,
+                                  long long n) {
+    long long i = 0;
+    for (; i + VEC_LANES <= n; i += VEC_LANES) {
+        VSTOREU(dst + i, VGATHER(table, index + i));
+    }
+    for (; i < n; i++) {
+        dst[i] = table[index[i]];
+    }
+}
+
+// table[index[i]] = src[i], VEC_LANES elements per scatter
+static void KERNEL(scatter_kernel)(double *restrict table, const long long *restrict index, const double *restrict src,
+                                   long long n) {
+    long long i = 0;
+    for (; i + VEC_LANES <= n; i += VEC_LANES) {
+        VSCATTER(table, index + i, VLOADU(src + i));
+    }
+    for (; i < n; i++) {
+        table[index[i]] = src[i];
+    }
+}
+
+// SELL-C-sigma SpMV over slices [slice_begin, slice_end) with C = VEC_LANES:
+// slice s holds VEC_LANES rows column-major from val/col + slice_ptr[s], so
+// each step is one vector load of values, one gather of x and one FMA per
+// lane. row_of maps the slice rows back to rows of y (padding rows to a
+// spare entry past the last row).
+static void KERNEL(spmv_sell_kernel)(long long slice_begin, long long slice_end, const long long *slice_ptr,
+                                     const long long *col, const double *val, const long long *row_of,
+                                     const double *x, double *y) {
+    VEC_ALIGN double lanes[VEC_LANES];
+    for (long long s = slice_begin; s < slice_end; s++) {
+        VEC_T sum = VSET1(0.0);
+        for (long long k = slice_ptr[s]; k < slice_ptr[s + 1]; k += VEC_LANES) {
+            sum = VFMADD(VLOADU(val + k), VGATHER(x, col + k), sum);
+        }
+        VSTORE(lanes, sum);
+        for (int l = 0; l < VEC_LANES; l++) {
+            y[row_of[s * VEC_LANES + l]] = lanes[l];
+        }
+    }
+}
+
+// Arithmetic-intensity kernel: PEAK_ACCUMULATORS vectors are loaded, updated
+// `fmas` times and stored, so high intensities still reach peak FMA rate
+static void KERNEL(intensity_kernel)(double *x, long long n, int fmas) {
+    VEC_T mult_factor = VSET1(0.999999);
+    VEC_T add_factor = VSET1(0.000001);
+    const long long block = PEAK_ACCUMULATORS * VEC_LANES;
+    long long i = 0;
+    
+    for (; i + block <= n; i += block) {
+        VEC_T v[PEAK_ACCUMULATORS];
+        for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+            v[j] = VLOAD(x + i + j * VEC_LANES);
+        }
+        for (int k = 0; k < fmas; k++) {
+            for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+                v[j] = VFMADD(v[j], mult_factor, add_factor);
+            }
+        }
+        for (int j = 0; j < PEAK_ACCUMULATORS; j++) {
+            VSTORE(x + i + j * VEC_LANES, v[j]);
+        }
+    }
+    
+    for (; i < n; i++) {
+        double y = x[i];
+        for (int k = 0; k < fmas; k++) {
+            y = y * 0.999999 + 0.000001;
+        }
+        x[i] = y;
+    }
+}
+
+// DGEMM micro-kernel: C[DGEMM_MR x DGEMM_NR] += A_panel * B_panel over `kc`
+// steps, with the whole C tile held in 2 x DGEMM_NR vector registers.
+// A is packed MR-contiguous per k step (vector aligned), B NR-contiguous;
+// C is column-major with leading dimension `ldc`.
+#define DGEMM_MR (2 * VEC_LANES)
+
+static void KERNEL(dgemm_micro_kernel)(long long kc, const double *a, const double *b, double *c, long long ldc) {
+    VEC_T c0[DGEMM_NR];
+    VEC_T c1[DGEMM_NR];
+    
+    for (int j = 0; j < DGEMM_NR; j++) {
+        c0[j] = VSET1(0.0);
+        c1[j] = VSET1(0.0);
+    }
+    
+    for (long long p = 0; p < kc; p++) {
+        VEC_T a0 = VLOAD(a);
+        VEC_T a1 = VLOAD(a + VEC_LANES);
+        for (int j = 0; j < DGEMM_NR; j++) {
+            VEC_T bj = VSET1(b[j]);
+            c0[j] = VFMADD(a0, bj, c0[j]);
+            c1[j] = VFMADD(a1, bj, c1[j]);
+        }
+        a += DGEMM_MR;
+        b += DGEMM_NR;
+    }
+    
+    for (int j = 0; j < DGEMM_NR; j++) {
+        double *cj = c + j * ldc;
+        VSTOREU(cj, VADD(VLOADU(cj), c0[j]));
+        VSTOREU(cj + VEC_LANES, VADD(VLOADU(cj + VEC_LANES), c1[j]));
+    }
+}
+
+// Op-mix kernels, one per entry of OPMIX_TYPES x OPMIX_OPS x OPMIX_CHAINS
+// (simd_kernels.h). Element-type operations, by the list's type name:
+#define OPMIX_VEC_f64 VEC_T
+#define OPMIX_VEC_f32 VECS_T
+#define OPMIX_LANES_f64 VEC_LANES
+#define OPMIX_LANES_f32 VECS_LANES
+#define OPMIX_SET1_f64(x) VSET1(x)
+#define OPMIX_SET1_f32(x) VSSET1((float)(x))
+#define OPMIX_STORE_f64(p, v) VSTORE(p, v)
+#define OPMIX_STORE_f32(p, v) VSSTORE(p, v)
+#define OPMIX_LOAD_f64(p) VLOAD(p)
+#define OPMIX_LOAD_f32(p) VSLOAD(p)
+#define OPMIX_FMADD_f64(a, b, c) VFMADD(a, b, c)
+#define OPMIX_FMADD_f32(a, b, c) VSFMADD(a, b, c)
+#define OPMIX_MUL_f64(a, b) VMUL(a, b)
+#define OPMIX_MUL_f32(a, b) VSMUL(a, b)
+#define OPMIX_ADD_f64(a, b) VADD(a, b)
+#define OPMIX_ADD_f32(a, b) VSADD(a, b)
+#define OPMIX_DIV_f64(a, b) VDIV(a, b)
+#define OPMIX_DIV_f32(a, b) VSDIV(a, b)
+#define OPMIX_SQRT_f64(a) VSQRT(a)
+#define OPMIX_SQRT_f32(a) VSSQRT(a)
+#define OPMIX_EXP_f64(a) KERNEL(opmix_exp_f64)(a)
+#define OPMIX_EXP_f32(a) KERNEL(opmix_exp_f32)(a)
+
+// No vector exp in the ISA: libm on each lane
+static inline VEC_T KERNEL(opmix_exp_f64)(VEC_T x) {
+    VEC_ALIGN double lanes[VEC_LANES];
+    VSTORE(lanes, x);
+    for (int i = 0; i < VEC_LANES; i++) {
+        lanes[i] = exp(-lanes[i]);
+    }
+    return VLOAD(lanes);
+}
+
+static inline VECS_T KERNEL(opmix_exp_f32)(VECS_T x) {
+    float lanes[VECS_LANES] __attribute__((aligned(sizeof(VECS_T))));
+    VSSTORE(lanes, x);
+    for (int i = 0; i < VECS_LANES; i++) {
+        lanes[i] = expf(-lanes[i]);
+    }
+    return VSLOAD(lanes);
+}
+
+// Per-op step from the constants a, b in verify.h, matching OPMIX_OPS
+#define OPMIX_STEP_fma(t, x) OPMIX_FMADD_##t(x, a, b)
+#define OPMIX_STEP_add(t, x) OPMIX_ADD_##t(OPMIX_ADD_##t(x, a), b)
+#define OPMIX_STEP_mul(t, x) OPMIX_MUL_##t(OPMIX_MUL_##t(x, a), b)
+#define OPMIX_STEP_div(t, x) OPMIX_DIV_##t(a, x)
+#define OPMIX_STEP_sqrt(t, x) OPMIX_SQRT_##t(OPMIX_MUL_##t(x, a))
+#define OPMIX_STEP_exp(t, x) OPMIX_EXP_##t(x)
+#define OPMIX_FUSED_fma VFMADD_FUSED
+#define OPMIX_FUSED_add 1
+#define OPMIX_FUSED_mul 1
+#define OPMIX_FUSED_div 1
+#define OPMIX_FUSED_sqrt 1
+#define OPMIX_FUSED_exp 1
+
+// `chains` independent accumulators stepped in turn from opmix_start(). The
+// constants go through volatiles so the compiler cannot fold exact steps
+// (x + a - a) into a constant. The sum of every lane goes to
+// kernel_checksum, which keeps the chains live and is checked against
+// verify_opmix_reference().
+#define OPMIX_DEFINE(label, chains, op, flops, step, t, element) \
+static double KERNEL(opmix_##t##_##op##_##label)(long long operations) { \
+    volatile double a_value = OPMIX_A_##op, b_value = OPMIX_B_##op; \
+    const OPMIX_VEC_##t a = OPMIX_SET1_##t(a_value); \
+    const OPMIX_VEC_##t b = OPMIX_SET1_##t(b_value); \
+    OPMIX_VEC_##t acc[chains]; \
+    element lanes[OPMIX_LANES_##t] __attribute__((aligned(sizeof(OPMIX_VEC_##t)))); \
+    (void)a; \
+    (void)b; \
+    for (int j = 0; j < (chains); j++) { \
+        acc[j] = OPMIX_SET1_##t(opmix_start(j)); \
+    } \
+    long long iterations = operations / ((chains) * OPMIX_LANES_##t); \
+    double start_time = get_time(); \
+    for (long long i = 0; i < iterations; i++) { \
+        for (int j = 0; j < (chains); j++) { \
+            acc[j] = OPMIX_STEP_##op(t, acc[j]); \
+        } \
+    } \
+    double elapsed = get_time() - start_time; \
+    double sum = 0.0; \
+    for (int j = 0; j < (chains); j++) { \
+        OPMIX_STORE_##t(lanes, acc[j]); \
+        for (int l = 0; l < OPMIX_LANES_##t; l++) sum += lanes[l]; \
+    } \
+    kernel_checksum = sum; \
+    return elapsed; \
+}
+
+#define OPMIX_ENTRY(label, chains, op, flops, step, t, element) \
+    { #t, #op, step, chains, OPMIX_LANES_##t, (long long)(chains) * OPMIX_LANES_##t, flops, \
+      OPMIX_FUSED_##op, KERNEL(opmix_##t##_##op##_##label) },
+
+#define OPMIX_FOR_CHAINS(op, flops, step, t, element, X) OPMIX_CHAINS(X, op, flops, step, t, element)
+#define OPMIX_FOR_OPS(t, element, X) OPMIX_OPS(OPMIX_FOR_CHAINS, t, element, X)
+
+OPMIX_TYPES(OPMIX_FOR_OPS, OPMIX_DEFINE)
+
+static const opmix_kernel_t KERNEL(opmix_kernels)[OPMIX_COUNT] = {
+    OPMIX_TYPES(OPMIX_FOR_OPS, OPMIX_ENTRY)
+};
+
+// Instruction-table kernels, one latency and one throughput kernel per entry
+// of OPMIX_TYPES x INSTR_OPS. Each step is the single instruction named by
+// INSTR_OPS, from the constants in verify.h
+#define INSTR_STEP_fma(t, x) OPMIX_FMADD_##t(x, a, b)
+#define INSTR_STEP_mul(t, x) OPMIX_MUL_##t(x, a)
+#define INSTR_STEP_add(t, x) OPMIX_ADD_##t(x, a)
+#define INSTR_STEP_div(t, x) OPMIX_DIV_##t(a, x)
+#define INSTR_STEP_sqrt(t, x) OPMIX_SQRT_##t(x)
+
+// `chains` independent chains from instr_start(), `instructions / chains`
+// steps each; the sum of every lane goes to kernel_checksum, which keeps
+// the chains live and is checked against verify_instr_reference()
+#define INSTR_KERNEL(label, chains, op, t, element) \
+static double KERNEL(instr_##t##_##op##_##label)(long long instructions) { \
+    volatile double a_value = INSTR_A_##op, b_value = INSTR_B_##op; \
+    const OPMIX_VEC_##t a = OPMIX_SET1_##t(a_value); \
+    const OPMIX_VEC_##t b = OPMIX_SET1_##t(b_value); \
+    OPMIX_VEC_##t acc[chains]; \
+    element lanes[OPMIX_LANES_##t] __attribute__((aligned(sizeof(OPMIX_VEC_##t)))); \
+    (void)a; \
+    (void)b; \
+    for (int j = 0; j < (chains); j++) { \
+        acc[j] = OPMIX_SET1_##t(instr_start(j)); \
+    } \
+    long long iterations = instructions / (chains); \
+    double start_time = get_time(); \
+    for (long long i = 0; i < iterations; i++) { \
+        for (int j = 0; j < (chains); j++) { \
+            acc[j] = INSTR_STEP_##op(t, acc[j]); \
+        } \
+    } \
+    double elapsed = get_time() - start_time; \
+    double sum = 0.0; \
+    for (int j = 0; j < (chains); j++) { \
+        OPMIX_STORE_##t(lanes, acc[j]); \
+        for (int l = 0; l < OPMIX_LANES_##t; l++) sum += lanes[l]; \
+    } \
+    kernel_checksum = sum; \
+    return elapsed; \
+}
+
+#define INSTR_DEFINE(op, x86, arm, step, t, element) \
+    INSTR_KERNEL(latency, 1, op, t, element) \
+    INSTR_KERNEL(throughput, INSTR_THROUGHPUT_CHAINS, op, t, element)
+
+#define INSTR_ENTRY(op, x86, arm, step, t, element) \
+    { #t, #op, INSTR_MNEMONIC(x86, arm, INSTR_SUFFIX_##t), step, VEC_LANES * 64, OPMIX_FUSED_##op, \
+      KERNEL(instr_##t##_##op##_latency), KERNEL(instr_##t##_##op##_throughput) },
+
+#define INSTR_FOR_OPS(t, element, X) INSTR_OPS(X, t, element)
+
+OPMIX_TYPES(INSTR_FOR_OPS, INSTR_DEFINE)
+
+static const instr_kernel_t KERNEL(instr_kernels)[INSTR_COUNT] = {
+    OPMIX_TYPES(INSTR_FOR_OPS, INSTR_ENTRY)
+};
+
+const simd_kernels_t KERNEL(simd_kernels) = {
+    ISA_NAME,
+    VEC_LANES,
+    KERNEL(vectorized_benchmark),
+    KERNEL(multithreaded_vectorized_benchmark),
+    KERNEL(peak_throughput_benchmark),
+    KERNEL(multithreaded_peak_benchmark),
+    { VEC_LANES, CHAIN_FLOPS_PER_STEP * VEC_LANES },
+    { PEAK_ACCUMULATORS, PEAK_ACCUMULATORS * VEC_LANES * 2.0 },
+    KERNEL(stream_copy),
+    KERNEL(stream_scale),
+    KERNEL(stream_add),
+    KERNEL(stream_triad),
+    KERNEL(intensity_kernel),
+    KERNEL(gather_kernel),
+    KERNEL(scatter_kernel),
+    VGATHER_NAME,
+    VSCATTER_NAME,
+    KERNEL(spmv_sell_kernel),
+    DGEMM_MR,
+    KERNEL(dgemm_micro_kernel),
+    KERNEL(opmix_kernels),
+    KERNEL(instr_kernels),
+};
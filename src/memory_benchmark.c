@@ -0,0 +1,695 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <limits.h>
+#include <omp.h>        // OpenMP
+#include <unistd.h>     // for sysconf
+#include <sys/mman.h>   // latency buffers: mmap, MAP_HUGETLB, THP advice
+#include "simd_kernels.h"  // per-ISA STREAM and intensity kernels
+#include "timing.h"        // monotonic clock, warm-up
+#include "affinity.h"      // thread pinning, so first touch and streaming agree
+#include "perf_counters.h" // cache misses and clocks per stream kernel
+#include "stats.h"         // repeated trials
+#include "options.h"       // --ops, --time, --threads, --kernels, --json
+#include "report.h"
+
+// Tests (--kernels): the STREAM kernels over every working set, and the
+// roofline sweep
+#define KERNEL_NAMES "stream,roofline,latency"
+#define FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS ",perf,latency,latency-max-mb,hugepages"
+
+// Timed samples per kernel and working set follow the trial policy
+// (stats.h); the best (shortest) is reported, as in STREAM. Unless --ops or
+// --time set the repeat count, each sample repeats the kernel until at least
+// this many bytes have moved, so cache-resident sets run long enough to time
+#define MIN_BYTES_PER_SAMPLE (256.0 * 1024 * 1024)
+
+// Thread partitions start on this many doubles (one 512-byte block), which
+// keeps every thread's slice vector aligned for the widest ISA
+#define PARTITION_ALIGN 64
+
+// Roofline sweep points: 1, 2, 4, ... 256 FMAs per element (1/8 to 32 FLOP/byte)
+#define ROOFLINE_POINTS 9
+
+// Latency ladder (--latency off skips it): pointer chases over one random
+// cycle through every 64-byte line of 4 KiB ... CHASE_MAX_BYTES buffers
+// (--latency-max-mb overrides; capped at a quarter of physical memory),
+// CHASE_STEPS dependent loads per trial
+#define CHASE_MIN_BYTES 4096.0
+#define CHASE_MAX_BYTES (4.0 * 1024 * 1024 * 1024)
+#define CHASE_STEPS (1LL << 21)
+#define CHASE_CLOCK_SECONDS 0.01
+#define HUGE_PAGE_BYTES (2 * 1024 * 1024)
+
+// Concurrent chains for the memory-level parallelism sweep
+#define CHASE_CHAINS(X) X(1) X(2) X(4) X(8) X(16) X(32)
+
+enum { STREAM_COPY, STREAM_SCALE, STREAM_ADD, STREAM_TRIAD, STREAM_KERNELS };
+
+static const char *stream_names[STREAM_KERNELS] = { "Copy", "Scale", "Add", "Triad" };
+
+// Arrays read + written per element (STREAM convention, no write-allocate)
+static const int stream_arrays_touched[STREAM_KERNELS] = { 2, 2, 3, 3 };
+
+// Contiguous slice [*begin, *end) of `n` elements owned by `thread_id`
+static void thread_range(long long n, int thread_id, int num_threads, long long *begin, long long *end) {
+    long long blocks = (n + PARTITION_ALIGN - 1) / PARTITION_ALIGN;
+    long long blocks_per_thread = (blocks + num_threads - 1) / num_threads;
+    
+    *begin = thread_id * blocks_per_thread * PARTITION_ALIGN;
+    *end = *begin + blocks_per_thread * PARTITION_ALIGN;
+    if (*begin > n) *begin = n;
+    if (*end > n) *end = n;
+}
+
+// Page-aligned array whose pages are first touched by the thread that will
+// later stream through them, so they live on that thread's NUMA node
+static double *alloc_first_touch(long long n, int num_threads, double value) {
+    void *ptr = NULL;
+    long page_size = sysconf(_SC_PAGESIZE);
+    
+    if (posix_memalign(&ptr, page_size, n * sizeof(double)) != 0) {
+        return NULL;
+    }
+    double *array = ptr;
+    
+    omp_set_num_threads(num_threads);
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        
+        for (long long i = begin; i < end; i++) {
+            array[i] = value;
+        }
+    }
+    
+    return array;
+}
+
+// One timed sample: every thread runs `kernel` `repeats` times over its own
+// slice. Slices are disjoint, so no barrier is needed between repeats.
+static double stream_sample(const simd_kernels_t *simd, int kernel, double *a, double *b, double *c,
+                            long long n, int repeats, int num_threads) {
+    const double scalar = 3.0;
+    
+    omp_set_num_threads(num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        long long count = end - begin;
+        
+        for (int r = 0; r < repeats && count > 0; r++) {
+            switch (kernel) {
+            case STREAM_COPY:
+                simd->stream_copy(c + begin, a + begin, count);
+                break;
+            case STREAM_SCALE:
+                simd->stream_scale(b + begin, c + begin, scalar, count);
+                break;
+            case STREAM_ADD:
+                simd->stream_add(c + begin, a + begin, b + begin, count);
+                break;
+            case STREAM_TRIAD:
+                simd->stream_triad(a + begin, b + begin, c + begin, scalar, count);
+                break;
+            }
+        }
+    }
+    
+    double end_time = get_time();
+    return end_time - start_time;
+}
+
+// stream_sample for --time calibration; operations are bytes moved, a
+// multiple of one pass over the arrays
+typedef struct {
+    const simd_kernels_t *simd;
+    int kernel;
+    double *a, *b, *c;
+    long long n;
+    int num_threads;
+    long long pass_bytes;
+} stream_run_t;
+
+static double stream_run(long long bytes, void *context) {
+    const stream_run_t *run = context;
+    long long repeats = bytes / run->pass_bytes;
+    if (repeats > INT_MAX) repeats = INT_MAX;
+    return stream_sample(run->simd, run->kernel, run->a, run->b, run->c, run->n, (int)repeats, run->num_threads);
+}
+
+// Best STREAM bandwidth (GB/s) for each kernel over three arrays of `n` doubles,
+// with the sample statistics, bytes moved per sample and the hardware
+// counters over all of its samples
+static int stream_benchmark(const simd_kernels_t *simd, const bench_options_t *opts, long long n, int num_threads,
+                            double gbps[STREAM_KERNELS], trial_stats_t stats[STREAM_KERNELS],
+                            double sample_bytes[STREAM_KERNELS], perf_sample_t perf[STREAM_KERNELS]) {
+    double *a = alloc_first_touch(n, num_threads, 1.0);
+    double *b = alloc_first_touch(n, num_threads, 2.0);
+    double *c = alloc_first_touch(n, num_threads, 0.0);
+    if (!a || !b || !c) {
+        free(a);
+        free(b);
+        free(c);
+        return -1;
+    }
+    
+    for (int k = 0; k < STREAM_KERNELS; k++) {
+        long long bytes = stream_arrays_touched[k] * (long long)sizeof(double) * n;
+        stream_run_t run = { simd, k, a, b, c, n, num_threads, bytes };
+        warmup_t warmup;
+        trial_set_t trials;
+        
+        for (warmup_start(&warmup); warmup_running(&warmup); ) {
+            stream_sample(simd, k, a, b, c, n, 1, num_threads);
+        }
+        long long fallback = ((long long)(MIN_BYTES_PER_SAMPLE / bytes) + 1) * bytes;
+        long long moved = options_operations(opts, stream_run, &run, bytes, fallback);
+        
+        perf_open(PERF_EVENTS_MEMORY, num_threads);
+        perf_start();
+        for (trials_begin(&trials); trials_continue(&trials); ) {
+            trials_add(&trials, stream_run(moved, &run));
+        }
+        perf_stop(&perf[k]);
+        perf_close();
+        trials_summarize(&trials, &stats[k]);
+        sample_bytes[k] = (double)moved;
+        gbps[k] = (sample_bytes[k] / stats[k].min) / 1e9;
+    }
+    
+    // Prevent optimization
+    if (a[n / 2] + b[n / 2] + c[n / 2] == 0.0) printf("Unexpected result\n");
+    
+    free(a);
+    free(b);
+    free(c);
+    return 0;
+}
+
+// Best GFLOPS of the intensity kernel at `fmas` FMAs per element, with the
+// statistics of its samples
+static double intensity_benchmark(const simd_kernels_t *simd, double *x, long long n, int fmas, int num_threads,
+                                  trial_stats_t *stats) {
+    trial_set_t trials;
+    
+    omp_set_num_threads(num_threads);
+    
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        double start_time = get_time();
+        
+        #pragma omp parallel
+        {
+            affinity_bind_thread(omp_get_thread_num());
+            long long begin, end;
+            thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+            if (end > begin) {
+                simd->intensity(x + begin, end - begin, fmas);
+            }
+        }
+        
+        trials_add(&trials, get_time() - start_time);
+    }
+    trials_summarize(&trials, stats);
+    
+    return (2.0 * fmas * n / stats->min) / 1e9;
+}
+
+// Page backing of a latency buffer (--hugepages, a list; default 4k,thp)
+typedef enum { PAGES_4K, PAGES_THP, PAGES_HUGETLB, PAGE_MODES } page_mode_t;
+
+static const char *page_mode_names[PAGE_MODES] = { "4k", "thp", "hugetlb" };
+
+// One cache line of the chase; `slot` holds the permutation while building
+typedef struct chase_line {
+    struct chase_line *next;
+    long long slot;
+    char pad[64 - sizeof(struct chase_line *) - sizeof(long long)];
+} chase_line_t;
+
+typedef struct {
+    void *map;
+    size_t map_length;
+    chase_line_t *lines;
+    long long count;
+} chase_buffer_t;
+
+static unsigned long long mix64(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Map `bytes` with the given backing and link its lines into one random
+// cycle (Sattolo's shuffle), so every load misses the prefetchers. Pages
+// are first touched here, by the calling thread. Returns -1 if the mapping
+// fails (MAP_HUGETLB without reserved huge pages, for example).
+static int chase_build(chase_buffer_t *buffer, double bytes, page_mode_t mode) {
+    size_t length = (size_t)bytes;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    
+    if (mode == PAGES_HUGETLB) {
+#ifdef MAP_HUGETLB
+        length = (length + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+        flags |= MAP_HUGETLB;
+#else
+        return -1;
+#endif
+    } else if (mode == PAGES_THP) {
+        length += HUGE_PAGE_BYTES;  // room to align the lines to a huge page
+    }
+    
+    buffer->map_length = length;
+    buffer->map = mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (buffer->map == MAP_FAILED) return -1;
+    
+    char *start = buffer->map;
+#ifdef MADV_HUGEPAGE
+    if (mode == PAGES_THP) {
+        start += (HUGE_PAGE_BYTES - (size_t)start % HUGE_PAGE_BYTES) % HUGE_PAGE_BYTES;
+        madvise(start, (size_t)bytes, MADV_HUGEPAGE);
+    } else if (mode == PAGES_4K) {
+        madvise(start, (size_t)bytes, MADV_NOHUGEPAGE);
+    }
+#endif
+    buffer->lines = (chase_line_t *)start;
+    buffer->count = (long long)(bytes / sizeof(chase_line_t));
+    
+    chase_line_t *lines = buffer->lines;
+    for (long long i = 0; i < buffer->count; i++) lines[i].slot = i;
+    for (long long i = buffer->count - 1; i > 0; i--) {
+        long long j = (long long)(mix64(i) % i);
+        long long swap = lines[i].slot;
+        lines[i].slot = lines[j].slot;
+        lines[j].slot = swap;
+    }
+    for (long long i = 0; i < buffer->count; i++) {
+        lines[lines[i].slot].next = &lines[lines[(i + 1) % buffer->count].slot];
+    }
+    return 0;
+}
+
+// Final chain positions, stored so the chases are not optimized away
+static chase_line_t *volatile chase_sink;
+
+static void chase_free(chase_buffer_t *buffer) {
+    munmap(buffer->map, buffer->map_length);
+}
+
+// `chains` dependent loads in flight from the positions in `start`; each
+// trial runs `steps` loads per chain and returns seconds
+#define CHASE_DEFINE(chains) \
+static double chase_x##chains(chase_line_t *const *start, long long steps) { \
+    chase_line_t *p[chains]; \
+    for (int j = 0; j < (chains); j++) p[j] = start[j]; \
+    double start_time = get_time(); \
+    for (long long i = 0; i < steps; i++) { \
+        for (int j = 0; j < (chains); j++) p[j] = p[j]->next; \
+    } \
+    double elapsed = get_time() - start_time; \
+    for (int j = 0; j < (chains); j++) chase_sink = p[j]; \
+    return elapsed; \
+}
+CHASE_CHAINS(CHASE_DEFINE)
+
+typedef double (*chase_fn)(chase_line_t *const *start, long long steps);
+
+#define CHASE_ENTRY(chains) { chains, chase_x##chains },
+static const struct {
+    int chains;
+    chase_fn run;
+} chase_kernels[] = { CHASE_CHAINS(CHASE_ENTRY) };
+#define CHASE_KERNELS (int)(sizeof(chase_kernels) / sizeof(chase_kernels[0]))
+#define CHASE_MAX_CHAINS 32
+
+// Median nanoseconds per load of kernel `k` over repeated trials, started
+// from `start`; `loads` is the number of loads in one trial. Several chains
+// stop short of the next one's start, so none reloads lines another chain
+// just brought in.
+static double chase_latency(const chase_buffer_t *buffer, chase_line_t *const *start, int k,
+                            trial_stats_t *stats, long long *loads) {
+    int chains = chase_kernels[k].chains;
+    long long steps = CHASE_STEPS / chains;
+    if (chains > 1 && steps > buffer->count / chains) steps = buffer->count / chains;
+    trial_set_t trials;
+    
+    chase_kernels[k].run(start, steps / 8);
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, chase_kernels[k].run(start, steps));
+    }
+    trials_summarize(&trials, stats);
+    *loads = steps * chains;
+    return stats->median / ((double)steps * chains) * 1e9;
+}
+
+// Build and chase a buffer from OpenMP thread `thread_id` of a team large
+// enough to include it, so the pages are first touched on that thread's
+// CPU; the chase itself runs on thread 0's CPU. NAN if mapping failed.
+static double placed_latency(double bytes, page_mode_t mode, int thread_id, int k,
+                             trial_stats_t *stats, long long *loads) {
+    chase_buffer_t buffer;
+    int built = -1;
+    
+    omp_set_num_threads(thread_id + 1);
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        if (omp_get_thread_num() == thread_id) built = chase_build(&buffer, bytes, mode);
+    }
+    if (built != 0) return NAN;
+    
+    // Chains start at evenly spaced points of the cycle. Finding them walks
+    // the whole cycle once, which also warms the buffer before the trials.
+    int chains = chase_kernels[k].chains;
+    chase_line_t *start[CHASE_MAX_CHAINS];
+    start[0] = buffer.lines;
+    for (int j = 1; j < chains; j++) {
+        start[j] = start[j - 1];
+        for (long long i = 0; i < buffer.count / chains; i++) start[j] = start[j]->next;
+    }
+    
+    double ns = 0.0;
+    #pragma omp parallel num_threads(1)
+    {
+        affinity_bind_thread(0);
+        ns = chase_latency(&buffer, start, k, stats, loads);
+    }
+    chase_free(&buffer);
+    return ns;
+}
+
+static void print_size(double bytes) {
+    if (bytes >= 1024.0 * 1024 * 1024) printf("   %6.0f GiB", bytes / (1024.0 * 1024 * 1024));
+    else if (bytes >= 1024.0 * 1024) printf("   %6.0f MiB", bytes / (1024.0 * 1024));
+    else printf("   %6.0f KiB", bytes / 1024.0);
+}
+
+static void print_bar(double value, double max_value) {
+    int width = max_value > 0.0 ? (int)(40.0 * value / max_value + 0.5) : 0;
+    printf("|");
+    for (int i = 0; i < width; i++) printf("#");
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    bench_options_t opts;
+    int status = options_parse(argc, argv, KERNEL_NAMES, FLAG_NAMES, &opts);
+    if (status) return status < 0;
+    report_begin("memory", opts.format);
+    
+    int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = opts.threads > 0 ? opts.threads : affinity_default_threads();
+    int run_stream = options_kernel_selected(&opts, "stream");
+    int run_roofline = options_kernel_selected(&opts, "roofline");
+    const char *latency_env = getenv("SISU_LATENCY");
+    int run_latency = options_kernel_selected(&opts, "latency") &&
+                      !(latency_env && strcmp(latency_env, "off") == 0);
+    
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    const simd_kernels_t *simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    if (!simd) {
+        printf("No supported SIMD instruction set found\n");
+        return 1;
+    }
+    
+    cache_info_t caches;
+    detect_cache_sizes(&caches);
+    
+    // Cap the DRAM working set at a quarter of physical memory
+    double phys_bytes = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    double dram_bytes = 4.0 * caches.l3;
+    if (dram_bytes < 256.0 * 1024 * 1024) dram_bytes = 256.0 * 1024 * 1024;
+    if (phys_bytes > 0 && dram_bytes > phys_bytes / 4) dram_bytes = phys_bytes / 4;
+    
+    // Total footprint of the three arrays: half of each cache level, summed
+    // over threads for the private L1/L2, so every level is actually resident
+    struct {
+        const char *name;
+        double footprint;
+    } levels[] = {
+        { "L1", 0.5 * caches.l1d * num_threads },
+        { "L2", 0.5 * caches.l2 * num_threads },
+        { "L3", 0.5 * caches.l3 },
+        { "DRAM", dram_bytes },
+    };
+    int num_levels = sizeof(levels) / sizeof(levels[0]);
+    double gbps[4][STREAM_KERNELS] = { { 0.0 } };
+    trial_stats_t stream_stats[STREAM_KERNELS];
+    double sample_bytes[STREAM_KERNELS];
+    perf_sample_t perf[STREAM_KERNELS];
+    
+    printf("=== Memory Bandwidth Benchmark ===\n");
+    printf("Available cores: %d\n", num_cores);
+    printf("SIMD kernels: %s (%d doubles per vector)\n", simd->name, simd->lanes);
+    printf("Caches: L1d %ld KiB, L2 %ld KiB, L3 %ld KiB\n",
+           caches.l1d / 1024, caches.l2 / 1024, caches.l3 / 1024);
+    affinity_print_map(num_threads);
+    perf_print_status();
+    printf("\n");
+    
+    for (int l = 0; l < num_levels && run_stream; l++) {
+        long long n = (long long)(levels[l].footprint / (3 * sizeof(double)));
+        
+        printf("%d. %s working set (%.0f KiB, %d threads):\n", l + 1, levels[l].name,
+               3.0 * n * sizeof(double) / 1024, num_threads);
+        if (stream_benchmark(simd, &opts, n, num_threads, gbps[l], stream_stats, sample_bytes, perf) != 0) {
+            printf("   Allocation failed, skipped\n\n");
+            continue;
+        }
+        for (int k = 0; k < STREAM_KERNELS; k++) {
+            char name[32];
+            printf("   %-6s %10.2f GB/s (best of %d, CV %.2f%%)\n", stream_names[k], gbps[l][k],
+                   stream_stats[k].count, 100.0 * stream_stats[k].cv);
+            perf_print("          ", &perf[k], 0.0);
+            
+            // Operations are bytes moved; the kernels count no FLOPs
+            snprintf(name, sizeof(name), "%s_%s", stream_names[k], levels[l].name);
+            for (char *p = name; *p; p++) *p = tolower((unsigned char)*p);
+            report_add(name, simd->name, num_threads, sample_bytes[k], 0.0, &stream_stats[k]);
+        }
+        printf("\n");
+    }
+    
+    // Roofline: compute ceiling from the peak FMA kernel, bandwidth ceiling
+    // from the best DRAM stream, then a measured arithmetic-intensity sweep
+    long long peak_operations = 400000000LL;
+    trial_stats_t peak_stats;
+    measure_simd_peak(simd, peak_operations, num_threads, &peak_stats);
+    double peak_flops = kernel_flops(simd->peak_flops, peak_operations);
+    double peak_gflops = (peak_flops / peak_stats.median) / 1e9;
+    double triad_gbps = gbps[num_levels - 1][STREAM_TRIAD];
+    
+    long long sweep_n = (long long)(dram_bytes / sizeof(double));
+    double *x = run_roofline ? alloc_first_touch(sweep_n, num_threads, 1.0) : NULL;
+    if (run_roofline && !x) {
+        printf("Roofline allocation failed, skipped\n");
+        return 1;
+    }
+    
+    // The sweep updates x in place, which avoids the write-allocate traffic
+    // STREAM does not count; use whichever stream sustained more
+    double sweep_gflops[ROOFLINE_POINTS] = { 0.0 };
+    for (int p = 0; p < ROOFLINE_POINTS && run_roofline; p++) {
+        trial_stats_t stats;
+        char name[32];
+        
+        sweep_gflops[p] = intensity_benchmark(simd, x, sweep_n, 1 << p, num_threads, &stats);
+        snprintf(name, sizeof(name), "roofline_%d", 1 << p);
+        report_add(name, simd->name, num_threads, (double)sweep_n, 2.0 * (1 << p) * sweep_n, &stats);
+    }
+    double inplace_gbps = sweep_gflops[0] / (2.0 / (2 * sizeof(double)));
+    double dram_gbps = 0.0;
+    for (int k = 0; k < STREAM_KERNELS; k++) {
+        if (gbps[num_levels - 1][k] > dram_gbps) dram_gbps = gbps[num_levels - 1][k];
+    }
+    if (inplace_gbps > dram_gbps) dram_gbps = inplace_gbps;
+    
+    if (run_roofline) {
+        printf("%d. Roofline (DRAM working set, %d threads):\n", num_levels + 1, num_threads);
+        printf("   Compute ceiling: %.2f GFLOPS (peak FMA kernel, median of %d trials)\n", peak_gflops,
+               peak_stats.count);
+        printf("   Bandwidth ceiling: %.2f GB/s (best DRAM stream, in-place update %.2f GB/s)\n",
+               dram_gbps, inplace_gbps);
+        if (dram_gbps > 0.0) {
+            printf("   Ridge point: %.2f FLOP/byte\n", peak_gflops / dram_gbps);
+        }
+        printf("\n   %-10s %10s %10s %7s\n", "FLOP/byte", "Measured", "Roofline", "Bound");
+        
+        for (int p = 0; p < ROOFLINE_POINTS; p++) {
+            double intensity = 2.0 * (1 << p) / (2 * sizeof(double));
+            double measured = sweep_gflops[p];
+            double roofline = intensity * dram_gbps < peak_gflops ? intensity * dram_gbps : peak_gflops;
+            
+            printf("   %-10.3f %10.2f %10.2f %6.0f%% ", intensity, measured, roofline,
+                   roofline > 0.0 ? 100.0 * measured / roofline : 0.0);
+            print_bar(measured, peak_gflops);
+        }
+        
+        // Prevent optimization
+        if (x[sweep_n / 2] == 0.0) printf("Unexpected result\n");
+        free(x);
+    }
+    
+    // Latency ladder: one chase per size and page backing, then chains in
+    // flight and NUMA placement at the DRAM size
+    double level_ns[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double level_cycles[4] = { 0.0, 0.0, 0.0, 0.0 };
+    
+    if (run_latency) {
+        double max_bytes = CHASE_MAX_BYTES;
+        const char *max_env = getenv("SISU_LATENCY_MAX_MB");
+        if (max_env && atof(max_env) > 0.0) max_bytes = atof(max_env) * 1024 * 1024;
+        if (phys_bytes > 0 && max_bytes > phys_bytes / 4) max_bytes = phys_bytes / 4;
+        if (max_bytes < CHASE_MIN_BYTES) max_bytes = CHASE_MIN_BYTES;
+        
+        int modes[PAGE_MODES];
+        int num_modes = 0;
+        char pages_list[64];
+        const char *pages_env = getenv("SISU_HUGEPAGES");
+        snprintf(pages_list, sizeof(pages_list), "%s", pages_env ? pages_env : "4k,thp");
+        for (char *name = strtok(pages_list, ","); name; name = strtok(NULL, ",")) {
+            for (int m = 0; m < PAGE_MODES; m++) {
+                if (strcmp(name, page_mode_names[m]) == 0 && num_modes < PAGE_MODES) modes[num_modes++] = m;
+            }
+        }
+        if (num_modes == 0) modes[num_modes++] = PAGES_4K;
+        
+        // Latency of each cache level: the ladder size nearest half the level
+        // (the STREAM footprints above), DRAM at the largest size
+        double level_bytes[4] = { 0.5 * caches.l1d, 0.5 * caches.l2, 0.5 * caches.l3, max_bytes };
+        double level_error[4] = { -1.0, -1.0, -1.0, -1.0 };
+        
+        // One clock sample converts every row, taken once the smallest
+        // buffer's chase has warmed the core up
+        trial_stats_t stats;
+        long long loads;
+        warmup_t warmup;
+        for (warmup_start(&warmup); warmup_running(&warmup); ) {
+            placed_latency(CHASE_MIN_BYTES, modes[0], 0, 0, &stats, &loads);
+        }
+        double clock_hz = core_clock_hz(CHASE_CLOCK_SECONDS);
+        
+        printf("\n%d. Load-to-use latency (pointer chase, 1 thread):\n", num_levels + 2);
+        printf("   %10s", "Size");
+        for (int m = 0; m < num_modes; m++) {
+            printf("   %8s %6s", page_mode_names[modes[m]], "cycles");
+        }
+        printf("\n");
+        
+        for (double bytes = CHASE_MIN_BYTES; bytes <= max_bytes; bytes *= 2) {
+            print_size(bytes);
+            for (int m = 0; m < num_modes; m++) {
+                char name[48];
+                double ns = placed_latency(bytes, modes[m], 0, 0, &stats, &loads);
+                if (isnan(ns)) {
+                    printf("   %8s %6s", "n/a", "");
+                    continue;
+                }
+                double cycles = ns * 1e-9 * clock_hz;
+                printf("   %5.1f ns %6.1f", ns, cycles);
+                
+                // Operations are dependent loads
+                snprintf(name, sizeof(name), "latency_%.0fkib_%s", bytes / 1024, page_mode_names[modes[m]]);
+                report_add(name, "scalar", 1, (double)loads, 0.0, &stats);
+                
+                // First listed backing reports the summary
+                if (m != 0) continue;
+                for (int l = 0; l < 4; l++) {
+                    double error = bytes > level_bytes[l] ? bytes / level_bytes[l] : level_bytes[l] / bytes;
+                    if (level_error[l] < 0.0 || error < level_error[l]) {
+                        level_error[l] = error;
+                        level_ns[l] = ns;
+                        level_cycles[l] = cycles;
+                    }
+                }
+            }
+            printf("\n");
+        }
+        
+        // Memory-level parallelism: K independent chains overlap their misses,
+        // so latency(1) / latency(K) is the number of loads in flight
+        double mlp_bytes = max_bytes < dram_bytes ? max_bytes : dram_bytes;
+        printf("\n%d. Memory-level parallelism (%.0f MiB, %s pages, 1 thread):\n", num_levels + 3,
+               mlp_bytes / (1024 * 1024), page_mode_names[modes[0]]);
+        printf("   %-7s %10s %10s\n", "Chains", "ns/access", "In flight");
+        
+        double single_ns = 0.0;
+        for (int k = 0; k < CHASE_KERNELS; k++) {
+            char name[32];
+            double ns = placed_latency(mlp_bytes, modes[0], 0, k, &stats, &loads);
+            if (isnan(ns)) {
+                printf("   Allocation failed, skipped\n");
+                break;
+            }
+            if (k == 0) single_ns = ns;
+            printf("   %-7d %10.2f %10.1f\n", chase_kernels[k].chains, ns, single_ns / ns);
+            snprintf(name, sizeof(name), "mlp_%d", chase_kernels[k].chains);
+            report_add(name, "scalar", 1, (double)loads, 0.0, &stats);
+        }
+        
+        // NUMA: first touch from a thread bound to each node in the plan,
+        // chase from thread 0's CPU
+        const affinity_plan_t *plan = affinity_plan();
+        printf("\n%d. NUMA latency (%.0f MiB, chased from node %d):\n", num_levels + 4,
+               mlp_bytes / (1024 * 1024), plan->slots[0].node);
+        if (plan->nodes < 2) {
+            printf("   Single NUMA node, local only: %.1f ns\n", single_ns);
+        }
+        for (int t = 0; plan->nodes >= 2 && t < plan->count; t++) {
+            int node = plan->slots[t].node;
+            int first = 1;
+            for (int u = 0; u < t; u++) {
+                if (plan->slots[u].node == node) first = 0;
+            }
+            if (!first) continue;
+            
+            char name[32];
+            double ns = placed_latency(mlp_bytes, modes[0], t, 0, &stats, &loads);
+            if (isnan(ns)) {
+                printf("   Node %d: allocation failed, skipped\n", node);
+                continue;
+            }
+            snprintf(name, sizeof(name), "numa_node%d", node);
+            report_add(name, "scalar", 1, (double)loads, 0.0, &stats);
+            printf("   Node %d (%s) %8.1f ns  %5.2fx local\n", node,
+                   node == plan->slots[0].node ? "local " : "remote", ns,
+                   single_ns > 0.0 ? ns / single_ns : 0.0);
+        }
+    }
+    
+    // Summary
+    if (run_stream) {
+        printf("\n=== Bandwidth Summary (Triad) ===\n");
+        for (int l = 0; l < num_levels; l++) {
+            printf("%-6s %10.2f GB/s\n", levels[l].name, gbps[l][STREAM_TRIAD]);
+        }
+        printf("Sustained bandwidth: %.2f GB/s\n", triad_gbps);
+    }
+    printf("Peak compute: %.2f GFLOPS\n", peak_gflops);
+    
+    if (run_latency) {
+        printf("\n=== Latency Summary ===\n");
+        for (int l = 0; l < num_levels; l++) {
+            printf("%-6s %8.1f ns %8.1f cycles\n", levels[l].name, level_ns[l], level_cycles[l]);
+        }
+        printf("DRAM latency: %.1f ns\n", level_ns[num_levels - 1]);
+        printf("DRAM latency at peak: %.0f FLOPs per miss\n",
+               level_ns[num_levels - 1] * peak_gflops);
+    }
+    
+    report_finish();
+    
+    return 0;
+}
@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>        // OpenMP
+#include <unistd.h>     // for sysconf
+#include <mpi.h>
+#include "simd_kernels.h"  // per-ISA vectorized and STREAM kernels
+#include "timing.h"        // monotonic clock, warm-up
+#include "stats.h"         // repeated trials and their statistics
+#include "affinity.h"      // thread pinning
+#include "report.h"        // --json / --csv records
+#include "options.h"       // command-line options
+
+// Test names for --kernels, also used as record names
+#define KERNEL_NAMES "vectorized_mt,peak_mt,triad,pingpong,allreduce"
+#define FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS
+
+// Operations per warm-up call and per trial without --ops / --time
+#define WARMUP_OPERATIONS 4000000LL
+#define DEFAULT_OPERATIONS 100000000LL
+
+// Ranks whose throughput is more than this far from the median rank
+#define OUTLIER_THRESHOLD 0.10
+
+// Triad arrays: 4x the L3 per node, at least 256 MiB, at most a quarter of
+// physical memory, split between the ranks sharing a node
+#define TRIAD_MIN_BYTES (256.0 * 1024 * 1024)
+#define PARTITION_ALIGN 64
+#define TRIAD_PASSES 10
+
+// Ping-pong between rank 0 and every other rank, and allreduce sizes from
+// 8 bytes to 2 MiB; each point is timed TRIALS times over ITERATIONS messages
+#define PINGPONG_LATENCY_BYTES 8
+#define PINGPONG_BANDWIDTH_BYTES ((size_t)4 << 20)
+#define PINGPONG_LATENCY_ITERATIONS 1000
+#define PINGPONG_BANDWIDTH_ITERATIONS 20
+#define ALLREDUCE_MAX_DOUBLES (1 << 18)
+#define ALLREDUCE_ITERATIONS 100
+#define INTERCONNECT_TRIALS 5
+
+#define HOST_LENGTH 64
+
+typedef double (*threaded_kernel_fn)(long long operations, int num_threads);
+
+// This process's place in the job
+typedef struct {
+    int rank;
+    int size;
+    int local_rank;             // rank among the ranks on this node
+    int local_size;             // ranks on this node
+    char host[HOST_LENGTH];
+    char (*hosts)[HOST_LENGTH]; // every rank's host, on rank 0
+} cluster_t;
+
+// One lockstep test as seen from rank 0
+typedef struct {
+    const char *name;
+    const char *unit;           // "GFLOPS" or "GB/s"
+    double work_per_operation;  // FLOPs (or bytes) per operation
+    double flops_per_operation;
+    long long operations;       // per rank and trial
+    int threads;                // per rank
+    trial_stats_t cluster;      // slowest rank per trial
+    trial_stats_t local;        // this rank
+} lockstep_t;
+
+static const simd_kernels_t *simd;
+
+// Triad working set of this rank
+static double *triad_a, *triad_b, *triad_c;
+static long long triad_n;
+
+// Contiguous slice [*begin, *end) of `n` elements owned by `thread_id`
+static void thread_range(long long n, int thread_id, int num_threads, long long *begin, long long *end) {
+    long long blocks = (n + PARTITION_ALIGN - 1) / PARTITION_ALIGN;
+    long long blocks_per_thread = (blocks + num_threads - 1) / num_threads;
+    
+    *begin = thread_id * blocks_per_thread * PARTITION_ALIGN;
+    *end = *begin + blocks_per_thread * PARTITION_ALIGN;
+    if (*begin > n) *begin = n;
+    if (*end > n) *end = n;
+}
+
+static double vectorized_run(long long operations, int num_threads) {
+    return simd->multithreaded_vectorized(operations, num_threads);
+}
+
+static double peak_run(long long operations, int num_threads) {
+    return simd->multithreaded_peak(operations, num_threads);
+}
+
+// `operations` passes of a = b + s*c over this rank's arrays; first touch
+// happened in the same thread split, so every slice is NUMA-local
+static double triad_run(long long operations, int num_threads) {
+    omp_set_num_threads(num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(triad_n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long r = 0; r < operations && end > begin; r++) {
+            simd->stream_triad(triad_a + begin, triad_b + begin, triad_c + begin, 3.0, end - begin);
+        }
+    }
+    
+    return get_time() - start_time;
+}
+
+static int triad_alloc(int num_threads, int local_size) {
+    cache_info_t caches;
+    detect_cache_sizes(&caches);
+    
+    double phys_bytes = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    double bytes = 4.0 * caches.l3;
+    if (bytes < TRIAD_MIN_BYTES) bytes = TRIAD_MIN_BYTES;
+    if (phys_bytes > 0 && bytes > phys_bytes / 4) bytes = phys_bytes / 4;
+    triad_n = (long long)(bytes / local_size / (3 * sizeof(double)));
+    
+    long page_size = sysconf(_SC_PAGESIZE);
+    void *a = NULL, *b = NULL, *c = NULL;
+    if (posix_memalign(&a, page_size, triad_n * sizeof(double)) != 0 ||
+        posix_memalign(&b, page_size, triad_n * sizeof(double)) != 0 ||
+        posix_memalign(&c, page_size, triad_n * sizeof(double)) != 0) {
+        free(a);
+        free(b);
+        return -1;
+    }
+    triad_a = a;
+    triad_b = b;
+    triad_c = c;
+    
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(triad_n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = begin; i < end; i++) {
+            triad_a[i] = 1.0;
+            triad_b[i] = 2.0;
+            triad_c[i] = 0.5;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    threaded_kernel_fn kernel;
+    int threads;
+} calibration_t;
+
+static double calibration_run(long long operations, void *context) {
+    const calibration_t *c = context;
+    return c->kernel(operations, c->threads);
+}
+
+// Run `kernel` on every rank at once, each trial behind an MPI_Barrier.
+// Rank 0 picks the operation count; every rank then sees the same slowest
+// time per trial (MPI_MAX), so the CV stopping rule ends all loops together.
+// A `granularity` of 0 marks a kernel whose operation is a whole pass: it
+// warms up one pass at a time and --time scales rank 0's last pass.
+static void lockstep_trials(const bench_options_t *opts, const cluster_t *cluster, threaded_kernel_fn kernel,
+                            long long granularity, long long fallback, lockstep_t *test) {
+    calibration_t calibration = { kernel, test->threads };
+    long long warmup_operations = granularity == 0 ? 1 : fallback < WARMUP_OPERATIONS ? fallback : WARMUP_OPERATIONS;
+    double pass_time = 0.0;
+    warmup_t warmup;
+    trial_set_t cluster_trials, local_trials;
+    
+    MPI_Barrier(MPI_COMM_WORLD);
+    for (warmup_start(&warmup); warmup_running(&warmup) || pass_time == 0.0; ) {
+        pass_time = kernel(warmup_operations, test->threads);
+    }
+    
+    long long operations = 0;
+    if (cluster->rank == 0) {
+        operations = granularity == 0 ? options_passes(opts, pass_time, fallback)
+                                      : options_operations(opts, calibration_run, &calibration, granularity, fallback);
+    }
+    MPI_Bcast(&operations, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    test->operations = operations;
+    
+    trials_begin(&local_trials);
+    for (trials_begin(&cluster_trials); trials_continue(&cluster_trials); ) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double local = kernel(operations, test->threads);
+        double slowest;
+        MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        trials_add(&local_trials, local);
+        trials_add(&cluster_trials, slowest);
+    }
+    trials_summarize(&cluster_trials, &test->cluster);
+    trials_summarize(&local_trials, &test->local);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_of(const double *values, int count) {
+    double *sorted = malloc(count * sizeof(double));
+    if (!sorted) return values[0];
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    double median = count % 2 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+    free(sorted);
+    return median;
+}
+
+// Gather every rank's trial statistics, then on rank 0 print the cluster
+// aggregate, the slowest node and the outliers, and record each rank
+static void report_lockstep(const cluster_t *cluster, const lockstep_t *test, int index, const char *title) {
+    trial_stats_t *all = cluster->rank == 0 ? malloc(cluster->size * sizeof(trial_stats_t)) : NULL;
+    double *rate = cluster->rank == 0 ? malloc(cluster->size * sizeof(double)) : NULL;
+    
+    MPI_Gather(&test->local, sizeof(trial_stats_t), MPI_BYTE, all, sizeof(trial_stats_t), MPI_BYTE, 0,
+               MPI_COMM_WORLD);
+    if (cluster->rank != 0 || !all || !rate) {
+        free(all);
+        free(rate);
+        return;
+    }
+    
+    double work = test->operations * test->work_per_operation;
+    double aggregate = 0.0;
+    int slowest = 0;
+    for (int r = 0; r < cluster->size; r++) {
+        rate[r] = all[r].median > 0.0 ? work / all[r].median / 1e9 : 0.0;
+        aggregate += rate[r];
+        if (rate[r] < rate[slowest]) slowest = r;
+    }
+    double median = median_of(rate, cluster->size);
+    double lockstep = work * cluster->size / test->cluster.median / 1e9;
+    
+    printf("%d. %s (%d ranks x %d threads):\n", index, title, cluster->size, test->threads);
+    printf("   Operations: %lld per rank per trial\n", test->operations);
+    printf("   Time: %.6f seconds (slowest rank, median of %d trials)\n", test->cluster.median, test->cluster.count);
+    print_trial_stats("   ", &test->cluster);
+    printf("   Aggregate: %.2f %s (sum of rank medians), %.2f %s in lockstep (slowest rank per trial)\n",
+           aggregate, test->unit, lockstep, test->unit);
+    printf("   Slowest node: rank %d (%s) %.2f %s, %.1f%% below the median rank (%.2f %s)\n", slowest,
+           cluster->hosts[slowest], rate[slowest], test->unit, median > 0.0 ? 100.0 * (1.0 - rate[slowest] / median) : 0.0,
+           median, test->unit);
+    
+    printf("   %5s %-24s %10s %10s %8s\n", "Rank", "Host", test->unit, "vs median", "CV");
+    int outliers = 0;
+    for (int r = 0; r < cluster->size; r++) {
+        double deviation = median > 0.0 ? rate[r] / median - 1.0 : 0.0;
+        int outlier = deviation > OUTLIER_THRESHOLD || deviation < -OUTLIER_THRESHOLD;
+        outliers += outlier;
+        printf("   %5d %-24.24s %10.2f %+9.1f%% %7.2f%%%s\n", r, cluster->hosts[r], rate[r], 100.0 * deviation,
+               all[r].cv * 100.0, outlier ? "  outlier" : "");
+        
+        char isa[64];
+        snprintf(isa, sizeof(isa), "%s rank %d %.32s", simd->name, r, cluster->hosts[r]);
+        report_add(test->name, isa, test->threads, test->operations, test->operations * test->flops_per_operation,
+                   &all[r]);
+    }
+    if (outliers == 0) printf("   Outliers: none beyond %.0f%% of the median rank\n", 100.0 * OUTLIER_THRESHOLD);
+    else printf("   Outliers: %d rank(s) beyond %.0f%% of the median rank\n", outliers, 100.0 * OUTLIER_THRESHOLD);
+    printf("\n");
+    
+    char record[48];
+    char isa[64];
+    snprintf(record, sizeof(record), "%s_cluster", test->name);
+    snprintf(isa, sizeof(isa), "%s %d ranks", simd->name, cluster->size);
+    report_add(record, isa, test->threads * cluster->size, (double)test->operations * cluster->size,
+               test->operations * test->flops_per_operation * cluster->size, &test->cluster);
+    free(rate);
+    free(all);
+}
+
+// Rank 0 exchanges messages with every other rank in turn: one-way latency
+// for small messages, then bandwidth for large ones
+static void pingpong_test(const cluster_t *cluster, int index) {
+    char *buffer = malloc(PINGPONG_BANDWIDTH_BYTES);
+    double *latency_us = cluster->rank == 0 ? calloc(cluster->size, sizeof(double)) : NULL;
+    double *bandwidth = cluster->rank == 0 ? calloc(cluster->size, sizeof(double)) : NULL;
+    if (!buffer || (cluster->rank == 0 && (!latency_us || !bandwidth))) {
+        printf("%d. Ping-pong: allocation failed\n\n", index);
+        free(buffer);
+        free(latency_us);
+        free(bandwidth);
+        return;
+    }
+    memset(buffer, 1, PINGPONG_BANDWIDTH_BYTES);
+    
+    for (int peer = 1; peer < cluster->size; peer++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (cluster->rank != 0 && cluster->rank != peer) continue;
+        int other = cluster->rank == 0 ? peer : 0;
+        
+        for (int size_index = 0; size_index < 2; size_index++) {
+            int bytes = size_index == 0 ? PINGPONG_LATENCY_BYTES : (int)PINGPONG_BANDWIDTH_BYTES;
+            int iterations = size_index == 0 ? PINGPONG_LATENCY_ITERATIONS : PINGPONG_BANDWIDTH_ITERATIONS;
+            double samples[INTERCONNECT_TRIALS];
+            
+            // One untimed trial sets up the connection
+            for (int trial = -1; trial < INTERCONNECT_TRIALS; trial++) {
+                double start_time = get_time();
+                for (int i = 0; i < iterations; i++) {
+                    if (cluster->rank == 0) {
+                        MPI_Send(buffer, bytes, MPI_CHAR, other, 0, MPI_COMM_WORLD);
+                        MPI_Recv(buffer, bytes, MPI_CHAR, other, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    } else {
+                        MPI_Recv(buffer, bytes, MPI_CHAR, other, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                        MPI_Send(buffer, bytes, MPI_CHAR, other, 0, MPI_COMM_WORLD);
+                    }
+                }
+                if (trial >= 0) samples[trial] = (get_time() - start_time) / (2.0 * iterations);
+            }
+            if (cluster->rank != 0) continue;
+            
+            trial_stats_t stats;
+            compute_stats(samples, INTERCONNECT_TRIALS, &stats);
+            if (size_index == 0) latency_us[peer] = stats.median * 1e6;
+            else bandwidth[peer] = bytes / stats.median / 1e9;
+            
+            char isa[64];
+            snprintf(isa, sizeof(isa), "mpi rank 0 <-> %d %.32s", peer, cluster->hosts[peer]);
+            report_add(size_index == 0 ? "pingpong_latency" : "pingpong_bandwidth", isa, 1, bytes, 0.0, &stats);
+        }
+    }
+    
+    if (cluster->rank == 0) {
+        printf("%d. Ping-pong from rank 0 (%d-byte latency, %zu KiB bandwidth):\n", index, PINGPONG_LATENCY_BYTES,
+               PINGPONG_BANDWIDTH_BYTES >> 10);
+        printf("   %5s %-24s %12s %12s\n", "Rank", "Host", "Latency (us)", "GB/s");
+        int slowest = 1;
+        for (int peer = 1; peer < cluster->size; peer++) {
+            printf("   %5d %-24.24s %12.2f %12.2f\n", peer, cluster->hosts[peer], latency_us[peer], bandwidth[peer]);
+            if (bandwidth[peer] < bandwidth[slowest]) slowest = peer;
+        }
+        printf("   Slowest link: rank %d (%s), %.2f GB/s, %.2f us\n\n", slowest, cluster->hosts[slowest],
+               bandwidth[slowest], latency_us[slowest]);
+    }
+    free(buffer);
+    free(latency_us);
+    free(bandwidth);
+}
+
+// MPI_Allreduce (sum of doubles) from 8 bytes to 2 MiB. Bus bandwidth uses
+// the 2(n-1)/n bytes per rank a ring allreduce moves.
+static void allreduce_test(const cluster_t *cluster, int index) {
+    double *send = malloc(ALLREDUCE_MAX_DOUBLES * sizeof(double));
+    double *receive = malloc(ALLREDUCE_MAX_DOUBLES * sizeof(double));
+    if (!send || !receive) {
+        printf("%d. Allreduce: allocation failed\n\n", index);
+        free(send);
+        free(receive);
+        return;
+    }
+    for (int i = 0; i < ALLREDUCE_MAX_DOUBLES; i++) send[i] = 1.0;
+    
+    if (cluster->rank == 0) {
+        printf("%d. Allreduce (sum of doubles, %d ranks):\n", index, cluster->size);
+        printf("   %10s %12s %12s\n", "Size", "Time (us)", "Bus GB/s");
+    }
+    for (int count = 1; count <= ALLREDUCE_MAX_DOUBLES; count *= 8) {
+        double samples[INTERCONNECT_TRIALS];
+        for (int trial = -1; trial < INTERCONNECT_TRIALS; trial++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            double start_time = get_time();
+            for (int i = 0; i < ALLREDUCE_ITERATIONS; i++) {
+                MPI_Allreduce(send, receive, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            }
+            double local = (get_time() - start_time) / ALLREDUCE_ITERATIONS;
+            double slowest;
+            MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            if (trial >= 0) samples[trial] = slowest;
+        }
+        if (cluster->rank != 0) continue;
+        
+        trial_stats_t stats;
+        compute_stats(samples, INTERCONNECT_TRIALS, &stats);
+        double bytes = (double)count * sizeof(double);
+        double bus = 2.0 * (cluster->size - 1) / cluster->size * bytes / stats.median / 1e9;
+        char size_text[24];
+        if (bytes >= 1024 * 1024) snprintf(size_text, sizeof(size_text), "%.0f MiB", bytes / (1024 * 1024));
+        else if (bytes >= 1024) snprintf(size_text, sizeof(size_text), "%.0f KiB", bytes / 1024);
+        else snprintf(size_text, sizeof(size_text), "%.0f B", bytes);
+        printf("   %10s %12.2f %12.2f\n", size_text, stats.median * 1e6, bus);
+        
+        char isa[64];
+        snprintf(isa, sizeof(isa), "mpi %d ranks", cluster->size);
+        report_add("allreduce", isa, cluster->size, bytes, 0.0, &stats);
+    }
+    if (receive[0] != cluster->size) printf("   Unexpected allreduce result %.0f\n", receive[0]);
+    if (cluster->rank == 0) printf("\n");
+    free(send);
+    free(receive);
+}
+
+int main(int argc, char **argv) {
+    int provided;
+    cluster_t cluster;
+    
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &cluster.rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &cluster.size);
+    
+    // Only rank 0 talks; the others still parse the same options
+    if (cluster.rank != 0 && !freopen("/dev/null", "w", stdout)) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    
+    bench_options_t opts;
+    int status = options_parse(argc, argv, KERNEL_NAMES, FLAG_NAMES, &opts);
+    if (status) {
+        MPI_Finalize();
+        return status < 0;
+    }
+    if (cluster.rank == 0) report_begin("mpi", opts.format);
+    
+    MPI_Comm node;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, cluster.rank, MPI_INFO_NULL, &node);
+    MPI_Comm_rank(node, &cluster.local_rank);
+    MPI_Comm_size(node, &cluster.local_size);
+    MPI_Comm_free(&node);
+    
+    char processor[MPI_MAX_PROCESSOR_NAME];
+    int length;
+    MPI_Get_processor_name(processor, &length);
+    snprintf(cluster.host, sizeof(cluster.host), "%.63s", processor);
+    cluster.hosts = cluster.rank == 0 ? malloc(cluster.size * sizeof(*cluster.hosts)) : NULL;
+    MPI_Gather(cluster.host, HOST_LENGTH, MPI_CHAR, cluster.hosts, HOST_LENGTH, MPI_CHAR, 0, MPI_COMM_WORLD);
+    
+    // Ranks on one node split its CPUs: an equal share each, bound to
+    // consecutive slots of the plan from the rank's own offset
+    int num_threads = opts.threads;
+    if (num_threads <= 0) {
+        num_threads = affinity_default_threads() / cluster.local_size;
+        if (num_threads < 1) num_threads = 1;
+    }
+    affinity_restrict_range(cluster.local_rank * num_threads, num_threads);
+    
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    int usable = simd != NULL, all_usable;
+    MPI_Allreduce(&usable, &all_usable, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!all_usable) {
+        printf("No supported SIMD instruction set found on every rank\n");
+        MPI_Finalize();
+        return 1;
+    }
+    
+    printf("=== MPI Cluster Benchmark ===\n");
+    printf("Ranks: %d (%d on this node), MPI thread support %s\n", cluster.size, cluster.local_size,
+           provided >= MPI_THREAD_FUNNELED ? "funneled" : "single");
+    printf("Threads per rank: %d, SIMD kernels on rank 0: %s\n", num_threads, simd->name);
+    printf("Timer: monotonic clock (%.0f ns resolution), warm-up %.0f ms, trials start behind MPI_Barrier\n",
+           get_time_resolution() * 1e9, warmup_seconds() * 1000.0);
+    affinity_print_map(num_threads);
+    printf("\n");
+    
+    int index = 1;
+    if (options_kernel_selected(&opts, "vectorized_mt")) {
+        double flops = simd->chain_flops.flops_per_iteration / simd->chain_flops.operations_per_iteration;
+        lockstep_t test = { "vectorized_mt", "GFLOPS", flops, flops, 0, num_threads, { 0 }, { 0 } };
+        lockstep_trials(&opts, &cluster, vectorized_run, simd->lanes, DEFAULT_OPERATIONS, &test);
+        report_lockstep(&cluster, &test, index++, "Multi-threaded Vectorized");
+    }
+    if (options_kernel_selected(&opts, "peak_mt")) {
+        double flops = simd->peak_flops.flops_per_iteration / simd->peak_flops.operations_per_iteration;
+        lockstep_t test = { "peak_mt", "GFLOPS", flops, flops, 0, num_threads, { 0 }, { 0 } };
+        lockstep_trials(&opts, &cluster, peak_run, PEAK_ACCUMULATORS, DEFAULT_OPERATIONS, &test);
+        report_lockstep(&cluster, &test, index++, "Multi-threaded Peak Throughput");
+    }
+    if (options_kernel_selected(&opts, "triad")) {
+        int allocated = triad_alloc(num_threads, cluster.local_size) == 0, all_allocated;
+        MPI_Allreduce(&allocated, &all_allocated, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        if (all_allocated) {
+            // One operation is a full pass over the three arrays; --ops sizes
+            // the FLOP kernels only, --time scales one timed pass
+            bench_options_t passes = opts;
+            passes.operations = 0;
+            lockstep_t test = { "triad", "GB/s", 3.0 * sizeof(double) * triad_n, 2.0 * triad_n, 0, num_threads,
+                                { 0 }, { 0 } };
+            lockstep_trials(&passes, &cluster, triad_run, 0, TRIAD_PASSES, &test);
+            report_lockstep(&cluster, &test, index++, "STREAM Triad");
+        } else {
+            printf("%d. STREAM Triad: allocation failed on a rank, skipped\n\n", index++);
+        }
+        free(triad_a);
+        free(triad_b);
+        free(triad_c);
+    }
+    if (cluster.size > 1 && options_kernel_selected(&opts, "pingpong")) pingpong_test(&cluster, index++);
+    if (cluster.size > 1 && options_kernel_selected(&opts, "allreduce")) allreduce_test(&cluster, index++);
+    if (cluster.size == 1) printf("Interconnect tests skipped (one rank)\n\n");
+    
+    if (cluster.rank == 0) report_finish();
+    free(cluster.hosts);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "options.h"
+
+// Calibration probes grow the operation count until one run takes at least
+// this long (or a quarter of the target), then scale linearly to the target
+#define CALIBRATION_PROBE_SECONDS 0.05
+#define CALIBRATION_START_OPERATIONS 100000LL
+#define CALIBRATION_MAX_OPERATIONS (1LL << 50)
+
+enum { OPT_OPS = 1000, OPT_TIME, OPT_THREADS, OPT_KERNELS, OPT_JSON, OPT_CSV, OPT_LIST, OPT_HELP, OPT_ENV };
+
+// Flags that set an environment knob read elsewhere, with their --help line
+static const struct {
+    const char *flag;
+    const char *variable;
+    const char *usage;
+} env_flags[] = {
+    { "trials", "SISU_TRIALS", "  --trials N         maximum trials per test" },
+    { "min-trials", "SISU_MIN_TRIALS", "  --min-trials N     minimum trials per test" },
+    { "cv-target", "SISU_CV_TARGET", "  --cv-target PCT    stop once CV is at most PCT percent" },
+    { "warmup-ms", "SISU_WARMUP_MS", "  --warmup-ms MS     warm-up before each test" },
+    { "isa", "SISU_ISA", "  --isa NAME         force a SIMD kernel set" },
+    { "affinity", "SISU_AFFINITY", "  --affinity POLICY  compact, scatter, cores or none" },
+    { "smt", "SISU_SMT", "  --smt on|off       use SMT siblings" },
+    { "scaling", "SISU_SCALING", "  --scaling MODE     strong, weak or both thread sweep" },
+    { "tune", "SISU_TUNE", "  --tune on|off      tune and cache the GPU launch geometry" },
+    { "binary-cache", "SISU_BINARY_CACHE", "  --binary-cache on|off  reuse compiled OpenCL programs" },
+    { "perf", "SISU_PERF", "  --perf on|off      hardware counters around timed trials" },
+    { "energy", "SISU_ENERGY", "  --energy on|off    RAPL / NVML energy around timed trials" },
+    { "soak", "SISU_SOAK", "  --soak SECONDS     run one kernel on all threads that long, as a time series" },
+    { "soak-interval", "SISU_SOAK_INTERVAL_MS", "  --soak-interval MS sample interval of --soak" },
+    { "daemon", "SISU_DAEMON",
+      "  --daemon [ADDR:]PORT  stay resident, serve probe results on /metrics, ADDR 127.0.0.1 unless given" },
+    { "daemon-interval", "SISU_DAEMON_INTERVAL", "  --daemon-interval S   seconds between daemon probes" },
+    { "opmix", "SISU_OPMIX", "  --opmix all|LIST   op-mix throughput matrix, e.g. f32 or div,sqrt" },
+    { "instr", "SISU_INSTR", "  --instr all|LIST   instruction latency / throughput table, e.g. f64 or fma,avx2" },
+    { "matrix", "SISU_MATRIX", "  --matrix FILE|stencil|random  SpMV matrix: Matrix Market file or one synthetic" },
+    { "hetero", "SISU_HETERO", "  --hetero on|DEVICE co-run flops_kernel on a GPU with the host peak kernel" },
+    { "latency", "SISU_LATENCY", "  --latency on|off   memory latency ladder" },
+    { "latency-max-mb", "SISU_LATENCY_MAX_MB", "  --latency-max-mb MB  largest latency chase buffer" },
+    { "hugepages", "SISU_HUGEPAGES", "  --hugepages LIST   latency page backings: 4k, thp, hugetlb" },
+};
+#define NUM_ENV_FLAGS (int)(sizeof(env_flags) / sizeof(env_flags[0]))
+
+static void print_usage(FILE *out, const char *program, const char *kernel_names, const char *flag_names) {
+    fprintf(out, "Usage: %s [options]\n", program);
+    fprintf(out, "  --ops N            operations per trial (k/M/G suffixes)\n");
+    fprintf(out, "  --time SECONDS     target time per trial, calibrates the operation count\n");
+    fprintf(out, "  --threads N        threads for multithreaded tests\n");
+    fprintf(out, "  --kernels A,B,...  tests to run: %s\n", kernel_names);
+    fprintf(out, "  --json | --csv     structured records on stdout, text on stderr\n");
+    for (int i = 0; i < NUM_ENV_FLAGS; i++) {
+        if (options_list_contains(flag_names, env_flags[i].flag)) {
+            fprintf(out, "%s (%s)\n", env_flags[i].usage, env_flags[i].variable);
+        }
+    }
+    fprintf(out, "  --list             list the test names\n");
+}
+
+static int parse_count(const char *text, long long *value) {
+    char *end;
+    double number = strtod(text, &end);
+    
+    if (end == text) return -1;
+    if (*end == 'k' || *end == 'K') number *= 1e3, end++;
+    else if (*end == 'm' || *end == 'M') number *= 1e6, end++;
+    else if (*end == 'g' || *end == 'G') number *= 1e9, end++;
+    if (*end != '\0' || number < 1 || number > (double)CALIBRATION_MAX_OPERATIONS) return -1;
+    
+    *value = (long long)number;
+    return 0;
+}
+
+int options_list_contains(const char *list, const char *name) {
+    size_t length = strlen(name);
+    
+    for (const char *p = list; *p; ) {
+        const char *comma = strchr(p, ',');
+        size_t entry = comma ? (size_t)(comma - p) : strlen(p);
+        if (entry == length && strncmp(p, name, length) == 0) return 1;
+        if (!comma) break;
+        p = comma + 1;
+    }
+    return 0;
+}
+
+// Every entry of `selected` must be one of `available`
+static int check_kernels(const char *selected, const char *available) {
+    char entry[64];
+    
+    for (const char *p = selected; *p; ) {
+        const char *comma = strchr(p, ',');
+        size_t length = comma ? (size_t)(comma - p) : strlen(p);
+        if (length == 0 || length >= sizeof(entry)) return -1;
+        memcpy(entry, p, length);
+        entry[length] = '\0';
+        if (!options_list_contains(available, entry)) {
+            fprintf(stderr, "Unknown kernel '%s' (available: %s)\n", entry, available);
+            return -1;
+        }
+        if (!comma) break;
+        p = comma + 1;
+    }
+    return 0;
+}
+
+int options_parse(int argc, char **argv, const char *kernel_names, const char *flag_names,
+                  bench_options_t *opts) {
+    struct option long_options[8 + NUM_ENV_FLAGS + 1] = {
+        { "ops", required_argument, NULL, OPT_OPS },
+        { "time", required_argument, NULL, OPT_TIME },
+        { "threads", required_argument, NULL, OPT_THREADS },
+        { "kernels", required_argument, NULL, OPT_KERNELS },
+        { "json", no_argument, NULL, OPT_JSON },
+        { "csv", no_argument, NULL, OPT_CSV },
+        { "list", no_argument, NULL, OPT_LIST },
+        { "help", no_argument, NULL, OPT_HELP },
+    };
+    // Only the flags this binary reads; getopt rejects the others
+    int num_options = 8;
+    for (int i = 0; i < NUM_ENV_FLAGS; i++) {
+        if (!options_list_contains(flag_names, env_flags[i].flag)) continue;
+        long_options[num_options].name = env_flags[i].flag;
+        long_options[num_options].has_arg = required_argument;
+        long_options[num_options].flag = NULL;
+        long_options[num_options].val = OPT_ENV + i;
+        num_options++;
+    }
+    memset(&long_options[num_options], 0, sizeof(long_options[0]));
+    
+    memset(opts, 0, sizeof(*opts));
+    opts->format = REPORT_TEXT;
+    
+    int option;
+    while ((option = getopt_long(argc, argv, "h", long_options, NULL)) != -1) {
+        char *end;
+        switch (option) {
+        case OPT_OPS:
+            if (parse_count(optarg, &opts->operations) != 0) {
+                fprintf(stderr, "Invalid --ops '%s'\n", optarg);
+                return -1;
+            }
+            break;
+        case OPT_TIME:
+            opts->target_seconds = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || opts->target_seconds <= 0.0) {
+                fprintf(stderr, "Invalid --time '%s'\n", optarg);
+                return -1;
+            }
+            break;
+        case OPT_THREADS:
+            opts->threads = (int)strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || opts->threads < 1) {
+                fprintf(stderr, "Invalid --threads '%s'\n", optarg);
+                return -1;
+            }
+            break;
+        case OPT_KERNELS:
+            if (check_kernels(optarg, kernel_names) != 0) return -1;
+            opts->kernels = optarg;
+            break;
+        case OPT_JSON:
+            opts->format = REPORT_JSON;
+            break;
+        case OPT_CSV:
+            opts->format = REPORT_CSV;
+            break;
+        case OPT_LIST:
+            for (const char *p = kernel_names; *p; p++) putchar(*p == ',' ? '\n' : *p);
+            putchar('\n');
+            return 1;
+        case 'h':
+        case OPT_HELP:
+            print_usage(stdout, argv[0], kernel_names, flag_names);
+            return 1;
+        default:
+            if (option >= OPT_ENV && option < OPT_ENV + NUM_ENV_FLAGS) {
+                setenv(env_flags[option - OPT_ENV].variable, optarg, 1);
+                break;
+            }
+            print_usage(stderr, argv[0], kernel_names, flag_names);
+            return -1;
+        }
+    }
+    
+    if (optind < argc) {
+        fprintf(stderr, "Unexpected argument '%s'\n", argv[optind]);
+        print_usage(stderr, argv[0], kernel_names, flag_names);
+        return -1;
+    }
+    return 0;
+}
+
+int options_kernel_selected(const bench_options_t *opts, const char *kernel) {
+    return !opts->kernels || options_list_contains(opts->kernels, kernel);
+}
+
+static long long round_to(long long operations, long long granularity) {
+    long long rounded = ((operations + granularity / 2) / granularity) * granularity;
+    return rounded < granularity ? granularity : rounded;
+}
+
+long long options_operations(const bench_options_t *opts, timed_run_fn run, void *context,
+                             long long granularity, long long fallback) {
+    if (granularity < 1) granularity = 1;
+    if (opts->target_seconds <= 0.0) {
+        return round_to(opts->operations > 0 ? opts->operations : fallback, granularity);
+    }
+    
+    // Grow until a run is long enough to extrapolate from
+    double probe = opts->target_seconds / 4 < CALIBRATION_PROBE_SECONDS ? opts->target_seconds / 4
+                                                                       : CALIBRATION_PROBE_SECONDS;
+    long long operations = round_to(CALIBRATION_START_OPERATIONS, granularity);
+    double elapsed = run(operations, context);
+    
+    while (elapsed < probe && operations < CALIBRATION_MAX_OPERATIONS / 10) {
+        double factor = elapsed > 0.0 ? 1.5 * probe / elapsed : 10.0;
+        if (factor > 10.0) factor = 10.0;
+        if (factor < 2.0) factor = 2.0;
+        operations = round_to((long long)(operations * factor), granularity);
+        elapsed = run(operations, context);
+    }
+    
+    double scaled = operations * (opts->target_seconds / elapsed);
+    if (scaled > (double)CALIBRATION_MAX_OPERATIONS) scaled = (double)CALIBRATION_MAX_OPERATIONS;
+    return round_to((long long)scaled, granularity);
+}
+
+long long options_passes(const bench_options_t *opts, double pass_seconds, long long fallback) {
+    long long passes = opts->operations > 0 ? opts->operations : fallback;
+    
+    if (opts->target_seconds > 0.0 && pass_seconds > 0.0) {
+        double scaled = opts->target_seconds / pass_seconds + 0.5;
+        passes = scaled < (double)CALIBRATION_MAX_OPERATIONS ? (long long)scaled : CALIBRATION_MAX_OPERATIONS;
+    }
+    return passes > 0 ? passes : 1;
+}
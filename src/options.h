@@ -0,0 +1,61 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "report.h"
+
+// Command-line options shared by the benchmark binaries:
+//
+//     --ops N           operations per trial (k/M/G suffixes accepted)
+//     --time SECONDS    target wall time per trial; the operation count is
+//                       calibrated to hit it (overrides --ops)
+//     --threads N       threads for the multithreaded tests
+//     --kernels A,B     run only these tests (--list shows the names)
+//     --json | --csv    structured records on stdout (see report.h)
+//
+// Flags backed by environment knobs are exported as the SISU_* variable, so
+// the option and the variable behave the same: --trials, --min-trials,
+// --cv-target, --warmup-ms, --isa, --affinity, --smt, --scaling, --tune,
+// --binary-cache, --perf, --energy, --soak, --soak-interval, --daemon,
+// --daemon-interval, --opmix, --instr, --matrix, --hetero, --latency,
+// --latency-max-mb, --hugepages. Each binary registers only the ones it reads;
+// the rest are rejected as bad usage and left out of --help.
+typedef struct {
+    report_format_t format;
+    long long operations;       // 0: the benchmark's default
+    double target_seconds;      // 0: fixed operation count
+    int threads;                // 0: one per CPU in the affinity plan
+    const char *kernels;        // NULL: all
+} bench_options_t;
+
+// Knob flags every binary reads (stats.c, timing.c) and the CPU placement
+// flags of the binaries that pin threads, for building `flag_names`
+#define OPTIONS_TRIAL_FLAGS "trials,min-trials,cv-target,warmup-ms"
+#define OPTIONS_PLACEMENT_FLAGS "isa,affinity,smt"
+
+// Parse argv. `kernel_names` is the comma-separated list of tests this
+// binary offers and `flag_names` the knob flags it reads. Returns 0 to run,
+// 1 after --help/--list, -1 on bad usage (message on stderr).
+int options_parse(int argc, char **argv, const char *kernel_names, const char *flag_names,
+                  bench_options_t *opts);
+
+// Whether `name` is one entry of the comma-separated `list`
+int options_list_contains(const char *list, const char *name);
+
+// Whether --kernels (if given) includes `kernel`
+int options_kernel_selected(const bench_options_t *opts, const char *kernel);
+
+// Times `operations` of some kernel and returns elapsed seconds
+typedef double (*timed_run_fn)(long long operations, void *context);
+
+// Operations per trial: the --time calibration when set, else --ops, else
+// `fallback`; always a positive multiple of `granularity`
+long long options_operations(const bench_options_t *opts, timed_run_fn run, void *context,
+                             long long granularity, long long fallback);
+
+// Whole passes per trial, for kernels whose single pass is already far
+// coarser than the counts options_operations starts from: --time divided by
+// `pass_seconds` (one pass timed after warm-up), else --ops, else
+// `fallback`; at least 1
+long long options_passes(const bench_options_t *opts, double pass_seconds, long long fallback);
+
+#endif
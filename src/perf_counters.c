@@ -0,0 +1,329 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "timing.h"
+#include "perf_counters.h"
+
+#define MAX_CORE_EVENTS 5
+#define MAX_FP_EVENTS 5
+
+// Retired FP event and the FLOPs one count stands for
+typedef struct {
+    uint64_t config;
+    double weight;
+} fp_event_t;
+
+// fp_arith_inst_retired (event 0xC7), umasks of equal weight combined:
+// scalar, 128-bit double, 128-bit single + 256-bit double, 256-bit single +
+// 512-bit double, 512-bit single. FMA instructions count twice.
+static const fp_event_t intel_fp_events[] = {
+    { 0x03c7, 1.0 }, { 0x04c7, 2.0 }, { 0x18c7, 4.0 }, { 0x60c7, 8.0 }, { 0x80c7, 16.0 },
+};
+
+// Zen fp_ret_sse_avx_ops.all (PMCx003) already counts FLOPs
+static const fp_event_t amd_fp_events[] = {
+    { 0xff03, 1.0 },
+};
+
+typedef struct {
+    int core_fd;                // group leader, -1 if not open
+    int core_count;
+    int fp_fd[MAX_FP_EVENTS];
+} thread_counters_t;
+
+static thread_counters_t counters[PERF_MAX_THREADS];
+static int num_counted = 0;
+static perf_event_set_t event_set;
+static double window_start = 0.0;
+
+// Probed once: whether counters work and which FP events apply
+static int probed = 0;
+static int available = 0;
+static const char *unavailable_reason = "";
+static char reason_text[128];
+static const fp_event_t *fp_events = NULL;
+static int num_fp_events = 0;
+static const char *fp_vendor = "";
+static uint32_t raw_type = PERF_TYPE_RAW;
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+    return syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+static int open_event(uint32_t type, uint64_t config, int group_fd, uint64_t read_format) {
+    struct perf_event_attr attr;
+    
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd < 0;   // members follow the leader
+    attr.exclude_kernel = 1;        // allowed at perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = read_format;
+    return (int)perf_event_open(&attr, 0, -1, group_fd, 0);
+}
+
+// CPU vendor and family from /proc/cpuinfo
+static void read_cpu_vendor(char *vendor, size_t size, int *family) {
+    char line[256];
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    
+    vendor[0] = '\0';
+    *family = 0;
+    if (!f) return;
+    while (fgets(line, sizeof(line), f) && (!vendor[0] || !*family)) {
+        char *colon = strchr(line, ':');
+        if (!colon) continue;
+        if (strncmp(line, "vendor_id", 9) == 0) {
+            snprintf(vendor, size, "%s", colon + 2);
+            vendor[strcspn(vendor, "\n")] = '\0';
+        } else if (strncmp(line, "cpu family", 10) == 0) {
+            *family = atoi(colon + 1);
+        }
+    }
+    fclose(f);
+}
+
+// Raw events go to the core PMU; hybrid Intel parts name it cpu_core
+static uint32_t core_pmu_type(void) {
+    const char *paths[] = { "/sys/bus/event_source/devices/cpu/type",
+                            "/sys/bus/event_source/devices/cpu_core/type" };
+    for (int i = 0; i < 2; i++) {
+        FILE *f = fopen(paths[i], "r");
+        unsigned type;
+        if (!f) continue;
+        int ok = fscanf(f, "%u", &type) == 1;
+        fclose(f);
+        if (ok) return type;
+    }
+    return PERF_TYPE_RAW;
+}
+
+static void probe(void) {
+    const char *setting = getenv("SISU_PERF");
+    char vendor[64];
+    int family;
+    
+    probed = 1;
+    if (setting && (strcasecmp(setting, "off") == 0 || strcmp(setting, "0") == 0)) {
+        unavailable_reason = "disabled (SISU_PERF=off)";
+        return;
+    }
+    
+    int fd = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, 0);
+    if (fd < 0) {
+        int paranoid = -9;
+        FILE *f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+        if (f) {
+            if (fscanf(f, "%d", &paranoid) != 1) paranoid = -9;
+            fclose(f);
+        }
+        if (errno == ENOENT || errno == EOPNOTSUPP) {
+            snprintf(reason_text, sizeof(reason_text), "unavailable (no hardware PMU exposed)");
+        } else if (paranoid != -9) {
+            snprintf(reason_text, sizeof(reason_text), "unavailable (%s, perf_event_paranoid=%d)", strerror(errno),
+                     paranoid);
+        } else {
+            snprintf(reason_text, sizeof(reason_text), "unavailable (%s)", strerror(errno));
+        }
+        unavailable_reason = reason_text;
+        return;
+    }
+    close(fd);
+    available = 1;
+    
+    // FP events only where the encoding is known and the PMU accepts it
+    read_cpu_vendor(vendor, sizeof(vendor), &family);
+    raw_type = core_pmu_type();
+    if (strcmp(vendor, "GenuineIntel") == 0 && family == 6) {
+        fp_events = intel_fp_events;
+        num_fp_events = sizeof(intel_fp_events) / sizeof(intel_fp_events[0]);
+        fp_vendor = "fp_arith_inst_retired";
+    } else if (strcmp(vendor, "AuthenticAMD") == 0 && family >= 0x17) {
+        fp_events = amd_fp_events;
+        num_fp_events = sizeof(amd_fp_events) / sizeof(amd_fp_events[0]);
+        fp_vendor = "fp_ret_sse_avx_ops";
+    }
+    if (num_fp_events > 0) {
+        fd = open_event(raw_type, fp_events[0].config, -1, 0);
+        if (fd < 0) num_fp_events = 0;
+        else close(fd);
+    }
+}
+
+static void open_thread(thread_counters_t *c) {
+    static const uint64_t core_configs[MAX_CORE_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_REF_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+    };
+    const uint64_t group_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                  PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const uint64_t single_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    int wanted = event_set == PERF_EVENTS_MEMORY ? 5 : 3;
+    
+    c->core_fd = open_event(PERF_TYPE_HARDWARE, core_configs[0], -1, group_format);
+    c->core_count = c->core_fd >= 0 ? 1 : 0;
+    for (int e = 1; e < wanted && c->core_fd >= 0; e++) {
+        int fd = open_event(PERF_TYPE_HARDWARE, core_configs[e], c->core_fd, group_format);
+        if (fd < 0) break;  // keep the events that fit; order defines the layout
+        c->core_count++;
+    }
+    
+    // Separate (multiplexed) events, so they never stop the group scheduling
+    for (int e = 0; e < MAX_FP_EVENTS; e++) {
+        c->fp_fd[e] = -1;
+        if (event_set == PERF_EVENTS_COMPUTE && e < num_fp_events) {
+            c->fp_fd[e] = open_event(raw_type, fp_events[e].config, -1, single_format);
+        }
+    }
+}
+
+int perf_open(perf_event_set_t set, int num_threads) {
+    if (!probed) probe();
+    perf_close();
+    if (!available) return 0;
+    
+    if (num_threads > PERF_MAX_THREADS) num_threads = PERF_MAX_THREADS;
+    if (num_threads < 1) num_threads = 1;
+    event_set = set;
+
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (t < num_threads) open_thread(&counters[t]);
+    }
+#else
+    num_threads = 1;
+    open_thread(&counters[0]);
+#endif
+
+    num_counted = num_threads;
+    int counted = 0;
+    for (int t = 0; t < num_counted; t++) counted += counters[t].core_fd >= 0;
+    return counted;
+}
+
+void perf_close(void) {
+    for (int t = 0; t < num_counted; t++) {
+        if (counters[t].core_fd >= 0) close(counters[t].core_fd);     // closes the group members too
+        for (int e = 0; e < MAX_FP_EVENTS; e++) {
+            if (counters[t].fp_fd[e] >= 0) close(counters[t].fp_fd[e]);
+        }
+    }
+    num_counted = 0;
+}
+
+void perf_start(void) {
+    for (int t = 0; t < num_counted; t++) {
+        thread_counters_t *c = &counters[t];
+        if (c->core_fd >= 0) {
+            ioctl(c->core_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(c->core_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        for (int e = 0; e < MAX_FP_EVENTS; e++) {
+            if (c->fp_fd[e] < 0) continue;
+            ioctl(c->fp_fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fp_fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    window_start = get_time();
+}
+
+// Counter value extrapolated over the time it was not on the PMU
+static double scaled(uint64_t value, uint64_t enabled, uint64_t running) {
+    if (running == 0) return 0.0;
+    return running < enabled ? (double)value * enabled / running : (double)value;
+}
+
+void perf_stop(perf_sample_t *sample) {
+    double elapsed = get_time() - window_start;
+    
+    memset(sample, 0, sizeof(*sample));
+    sample->seconds = elapsed;
+    sample->has_flops = num_fp_events > 0 && event_set == PERF_EVENTS_COMPUTE;
+    
+    for (int t = 0; t < num_counted; t++) {
+        thread_counters_t *c = &counters[t];
+        if (c->core_fd >= 0) ioctl(c->core_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int e = 0; e < MAX_FP_EVENTS; e++) {
+            if (c->fp_fd[e] >= 0) ioctl(c->fp_fd[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    
+    for (int t = 0; t < num_counted; t++) {
+        thread_counters_t *c = &counters[t];
+        uint64_t group[3 + MAX_CORE_EVENTS];    // nr, time enabled, time running, values
+        
+        if (c->core_fd >= 0 && read(c->core_fd, group, sizeof(group)) >= (ssize_t)(3 * sizeof(uint64_t))) {
+            double values[MAX_CORE_EVENTS] = { 0.0 };
+            int count = (int)group[0] < c->core_count ? (int)group[0] : c->core_count;
+            for (int e = 0; e < count; e++) values[e] = scaled(group[3 + e], group[1], group[2]);
+            if (group[2] > 0) {
+                sample->valid = 1;
+                sample->threads++;
+            }
+            sample->cycles += values[0];
+            sample->instructions += values[1];
+            sample->ref_cycles += values[2];
+            sample->cache_references += values[3];
+            sample->cache_misses += values[4];
+        }
+        
+        for (int e = 0; e < MAX_FP_EVENTS; e++) {
+            uint64_t single[3];     // value, time enabled, time running
+            if (c->fp_fd[e] < 0) {
+                if (e < num_fp_events && event_set == PERF_EVENTS_COMPUTE) sample->has_flops = 0;
+                continue;
+            }
+            if (read(c->fp_fd[e], single, sizeof(single)) == (ssize_t)sizeof(single)) {
+                sample->flops += scaled(single[0], single[1], single[2]) * fp_events[e].weight;
+            }
+        }
+    }
+}
+
+void perf_print_status(void) {
+    if (!probed) probe();
+    if (!available) {
+        printf("Counters: %s\n", unavailable_reason);
+        return;
+    }
+    printf("Counters: perf_event_open cycles, instructions, ref-cycles%s%s\n",
+           num_fp_events > 0 ? ", " : " (no FP events for this CPU)", num_fp_events > 0 ? fp_vendor : "");
+}
+
+void perf_print(const char *indent, const perf_sample_t *sample, double analytic_flops) {
+    if (!sample->valid || sample->cycles <= 0.0) return;
+    
+    double ipc = sample->instructions / sample->cycles;
+    double ghz = sample->seconds > 0.0 ? sample->cycles / (sample->threads * sample->seconds) / 1e9 : 0.0;
+    
+    printf("%sCounters: IPC %.2f, %.2f GHz effective per thread", indent, ipc, ghz);
+    if (sample->ref_cycles > 0.0) printf(" (%.2fx reference clock)", sample->cycles / sample->ref_cycles);
+    printf(", %d thread%s\n", sample->threads, sample->threads == 1 ? "" : "s");
+    
+    if (sample->cache_references > 0.0) {
+        printf("%sCache: %.3g references, %.1f%% missed\n", indent, sample->cache_references,
+               100.0 * sample->cache_misses / sample->cache_references);
+    }
+    if (sample->has_flops && sample->seconds > 0.0) {
+        double mflops = sample->flops / sample->seconds / 1e6;
+        printf("%sCounter FLOPS: %.2f MFLOPS", indent, mflops);
+        if (analytic_flops > 0.0) printf(" (%.2fx the analytic count)", sample->flops / analytic_flops);
+        printf("\n");
+    }
+}
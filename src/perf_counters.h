@@ -0,0 +1,48 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Hardware counters around timed regions via perf_event_open. Each thread
+// gets one counter group (cycles, instructions, ref-cycles, plus cache
+// references/misses for memory kernels) and, on Intel and AMD Zen, the
+// retired floating-point events, which are multiplexed and scaled.
+// SISU_PERF=off disables counting.
+
+#define PERF_MAX_THREADS 256
+
+typedef enum {
+    PERF_EVENTS_COMPUTE,    // core group + FP arithmetic events
+    PERF_EVENTS_MEMORY      // core group + cache references and misses
+} perf_event_set_t;
+
+// Counts summed over threads for one start/stop window
+typedef struct {
+    int valid;              // core group counted on at least one thread
+    int threads;
+    double seconds;         // wall time between perf_start and perf_stop
+    double cycles;
+    double instructions;
+    double ref_cycles;
+    double cache_references;
+    double cache_misses;
+    int has_flops;          // FP events available
+    double flops;           // weighted by lanes, FMA counted twice
+} perf_sample_t;
+
+// Open counters for OpenMP threads 0..num_threads-1 (only the calling thread
+// without OpenMP). Thread i of later parallel regions of the same size is
+// the pthread counted as i, as with libgomp's thread pool. Returns the
+// number of threads counted, 0 if counters are unavailable.
+int perf_open(perf_event_set_t set, int num_threads);
+
+void perf_start(void);
+void perf_stop(perf_sample_t *sample);
+void perf_close(void);
+
+// One header line: which events are counted, or why none are
+void perf_print_status(void);
+
+// IPC, effective GHz and, with FP events, counter-derived MFLOPS against
+// `analytic_flops` (the FLOPs the window should have retired)
+void perf_print(const char *indent, const perf_sample_t *sample, double analytic_flops);
+
+#endif
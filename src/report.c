@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include "report.h"
+
+static report_format_t format = REPORT_TEXT;
+static const char *benchmark_name = "";
+static FILE *records_out = NULL;
+static report_record_t records[MAX_REPORT_RECORDS];
+static int num_records = 0;
+
+void report_begin(const char *benchmark, report_format_t requested) {
+    format = requested;
+    benchmark_name = benchmark;
+    num_records = 0;
+    records_out = stdout;
+    
+    if (format == REPORT_TEXT) return;
+    
+    // Keep the real stdout for records; printf now goes to stderr
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    FILE *out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (out && dup2(STDERR_FILENO, STDOUT_FILENO) >= 0) {
+        records_out = out;
+    } else if (out) {
+        fclose(out);
+    }
+}
+
+void report_add(const char *kernel, const char *isa, int threads, double operations,
+                double flops, const trial_stats_t *stats) {
+    if (num_records >= MAX_REPORT_RECORDS) return;
+    
+    report_record_t *r = &records[num_records++];
+    snprintf(r->kernel, sizeof(r->kernel), "%s", kernel);
+    snprintf(r->isa, sizeof(r->isa), "%s", isa);
+    r->threads = threads;
+    r->operations = operations;
+    r->flops = flops;
+    r->stats = *stats;
+    r->joules = 0.0;
+    r->watts = 0.0;
+    r->verified = -1;
+}
+
+void report_set_energy(double joules_per_trial, double watts) {
+    if (num_records == 0) return;
+    records[num_records - 1].joules = joules_per_trial;
+    records[num_records - 1].watts = watts;
+}
+
+void report_set_checksum(double checksum, double expected, int verified) {
+    if (num_records == 0) return;
+    records[num_records - 1].checksum = checksum;
+    records[num_records - 1].expected = expected;
+    records[num_records - 1].verified = verified;
+}
+
+static void write_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        if ((unsigned char)*s >= 0x20) fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_csv_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+// JSON has no inf or nan: a diverged checksum is written as null
+static void write_json_number(FILE *out, double value) {
+    if (isfinite(value)) fprintf(out, "%.17g", value);
+    else fputs("null", out);
+}
+
+static double record_mflops(const report_record_t *r) {
+    return r->stats.median > 0.0 ? (r->flops / r->stats.median) / 1000000.0 : 0.0;
+}
+
+static void write_json(FILE *out) {
+    fprintf(out, "{\n  \"benchmark\": ");
+    write_json_string(out, benchmark_name);
+    fprintf(out, ",\n  \"records\": [");
+    
+    for (int i = 0; i < num_records; i++) {
+        const report_record_t *r = &records[i];
+        const trial_stats_t *s = &r->stats;
+        
+        fprintf(out, "%s\n    {\"kernel\": ", i ? "," : "");
+        write_json_string(out, r->kernel);
+        fprintf(out, ", \"isa\": ");
+        write_json_string(out, r->isa);
+        fprintf(out, ", \"threads\": %d, \"operations\": %.0f, \"flops\": %.0f,"
+                " \"elapsed\": %.9f, \"mflops\": %.3f, \"trials\": %d,"
+                " \"stats\": {\"min\": %.9f, \"median\": %.9f, \"mean\": %.9f,"
+                " \"stddev\": %.9f, \"p95\": %.9f, \"cv\": %.6f}",
+                r->threads, r->operations, r->flops, s->median, record_mflops(r), s->count,
+                s->min, s->median, s->mean, s->stddev, s->p95, s->cv);
+        if (r->joules > 0.0) {
+            fprintf(out, ", \"energy\": {\"joules\": %.6f, \"watts\": %.3f, \"gflops_per_watt\": %.6f}",
+                    r->joules, r->watts, r->flops / r->joules / 1e9);
+        }
+        if (r->verified >= 0) {
+            fprintf(out, ", \"checksum\": {\"value\": ");
+            write_json_number(out, r->checksum);
+            fprintf(out, ", \"expected\": ");
+            write_json_number(out, r->expected);
+            fprintf(out, ", \"verified\": %s}", r->verified ? "true" : "false");
+        }
+        fputc('}', out);
+    }
+    
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void write_csv(FILE *out) {
+    fprintf(out, "benchmark,kernel,isa,threads,operations,flops,elapsed,mflops,trials,"
+                 "min,median,mean,stddev,p95,cv,joules,watts,checksum,verified\n");
+    
+    for (int i = 0; i < num_records; i++) {
+        const report_record_t *r = &records[i];
+        const trial_stats_t *s = &r->stats;
+        
+        write_csv_string(out, benchmark_name);
+        fputc(',', out);
+        write_csv_string(out, r->kernel);
+        fputc(',', out);
+        write_csv_string(out, r->isa);
+        fprintf(out, ",%d,%.0f,%.0f,%.9f,%.3f,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.6f,",
+                r->threads, r->operations, r->flops, s->median, record_mflops(r), s->count,
+                s->min, s->median, s->mean, s->stddev, s->p95, s->cv);
+        if (r->joules > 0.0) fprintf(out, "%.6f,%.3f", r->joules, r->watts);
+        else fputc(',', out);
+        if (r->verified >= 0 && isfinite(r->checksum)) fprintf(out, ",%.17g,%d", r->checksum, r->verified);
+        else if (r->verified >= 0) fprintf(out, ",,%d", r->verified);
+        else fputs(",,", out);
+        fputc('\n', out);
+    }
+}
+
+void report_finish(void) {
+    if (format == REPORT_JSON) write_json(records_out);
+    else if (format == REPORT_CSV) write_csv(records_out);
+    fflush(records_out);
+}
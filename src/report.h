@@ -0,0 +1,46 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "stats.h"
+
+// Upper bound on records collected per run
+#define MAX_REPORT_RECORDS 256
+
+typedef enum {
+    REPORT_TEXT,    // human-readable printf output only
+    REPORT_JSON,    // one JSON document on stdout
+    REPORT_CSV      // header plus one row per record on stdout
+} report_format_t;
+
+// One measured test
+typedef struct {
+    char kernel[48];
+    char isa[64];
+    int threads;
+    double operations;
+    double flops;
+    trial_stats_t stats;    // over elapsed seconds
+    double joules;          // energy per trial, 0 if not measured
+    double watts;           // average power over the trials
+    int verified;           // checksum: 1 matched, 0 mismatch, -1 not checked
+    double checksum;
+    double expected;
+} report_record_t;
+
+// Start a run. In JSON/CSV mode the human-readable text is moved to stderr,
+// so stdout carries only the structured records written by report_finish.
+void report_begin(const char *benchmark, report_format_t format);
+
+void report_add(const char *kernel, const char *isa, int threads, double operations,
+                double flops, const trial_stats_t *stats);
+
+// Attach the energy measured over the trials of the last added record
+void report_set_energy(double joules_per_trial, double watts);
+
+// Attach the result check of the last added record (verify.h)
+void report_set_checksum(double checksum, double expected, int verified);
+
+// Write the collected records (JSON/CSV mode)
+void report_finish(void);
+
+#endif
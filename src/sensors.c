@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "sensors.h"
+
+#define MAX_TEMPERATURE_INPUTS 64
+
+// hwmon drivers that report the CPU package or its cores
+static const char *cpu_hwmon_names[] = { "coretemp", "k10temp", "zenpower", "cpu_thermal", "apple_temp" };
+
+static int probed = 0;
+static int have_cpufreq = 0;
+static int have_cpuinfo_mhz = 0;
+static char temperature_source[80] = "";
+static char temperature_inputs[MAX_TEMPERATURE_INPUTS][200];
+static int num_temperature_inputs = 0;
+
+static int read_long(const char *path, long *value) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fscanf(f, "%ld", value) == 1;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+static int read_line(const char *path, char *text, size_t size) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fgets(text, (int)size, f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+    text[strcspn(text, "\n")] = '\0';
+    return 0;
+}
+
+static int cpu_listed(int cpu, const int *cpus, int count) {
+    if (!cpus) return 1;
+    for (int i = 0; i < count; i++) {
+        if (cpus[i] == cpu) return 1;
+    }
+    return 0;
+}
+
+static void add_temperature_input(const char *path) {
+    if (num_temperature_inputs >= MAX_TEMPERATURE_INPUTS) return;
+    snprintf(temperature_inputs[num_temperature_inputs++], sizeof(temperature_inputs[0]), "%s", path);
+}
+
+// temp*_input files of the first hwmon device driven by a CPU sensor
+static void probe_hwmon(void) {
+    DIR *dir = opendir("/sys/class/hwmon");
+    if (!dir) return;
+    
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL && num_temperature_inputs == 0; ) {
+        char path[160], name[64];
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "/sys/class/hwmon/%.32s/name", entry->d_name);
+        if (read_line(path, name, sizeof(name)) != 0) continue;
+        
+        int known = 0;
+        for (size_t i = 0; i < sizeof(cpu_hwmon_names) / sizeof(cpu_hwmon_names[0]); i++) {
+            known |= strcmp(name, cpu_hwmon_names[i]) == 0;
+        }
+        if (!known) continue;
+        
+        snprintf(path, sizeof(path), "/sys/class/hwmon/%.32s", entry->d_name);
+        DIR *device = opendir(path);
+        if (!device) continue;
+        for (struct dirent *input; (input = readdir(device)) != NULL; ) {
+            size_t length = strlen(input->d_name);
+            if (strncmp(input->d_name, "temp", 4) != 0 || length < 6 ||
+                strcmp(input->d_name + length - 6, "_input") != 0) continue;
+            char input_path[200];
+            snprintf(input_path, sizeof(input_path), "%s/%.32s", path, input->d_name);
+            add_temperature_input(input_path);
+        }
+        closedir(device);
+        if (num_temperature_inputs > 0) snprintf(temperature_source, sizeof(temperature_source), "hwmon %s", name);
+    }
+    closedir(dir);
+}
+
+// Thermal zones whose type names the CPU package (x86_pkg_temp, cpu-thermal, ...)
+static void probe_thermal_zones(void) {
+    DIR *dir = opendir("/sys/class/thermal");
+    if (!dir) return;
+    
+    for (struct dirent *entry; (entry = readdir(dir)) != NULL; ) {
+        char path[160], type[64];
+        if (strncmp(entry->d_name, "thermal_zone", 12) != 0) continue;
+        snprintf(path, sizeof(path), "/sys/class/thermal/%.32s/type", entry->d_name);
+        if (read_line(path, type, sizeof(type)) != 0) continue;
+        if (!strstr(type, "pkg") && !strstr(type, "cpu") && !strstr(type, "soc")) continue;
+        snprintf(path, sizeof(path), "/sys/class/thermal/%.32s/temp", entry->d_name);
+        add_temperature_input(path);
+    }
+    closedir(dir);
+    if (num_temperature_inputs > 0) snprintf(temperature_source, sizeof(temperature_source), "thermal zones");
+}
+
+// Average of the "cpu MHz" lines of the listed processors
+static int cpuinfo_mhz(const int *cpus, int count, double *mhz) {
+    char line[256];
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    int processor = -1, found = 0;
+    double total = 0.0;
+    
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        char *colon = strchr(line, ':');
+        if (!colon) continue;
+        if (strncmp(line, "processor", 9) == 0) {
+            processor = atoi(colon + 1);
+        } else if (strncmp(line, "cpu MHz", 7) == 0 && cpu_listed(processor, cpus, count)) {
+            total += atof(colon + 1);
+            found++;
+        }
+    }
+    fclose(f);
+    if (found == 0) return -1;
+    *mhz = total / found;
+    return 0;
+}
+
+static void probe(void) {
+    long value;
+    double mhz;
+    
+    probed = 1;
+    have_cpufreq = read_long("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", &value) == 0;
+    if (!have_cpufreq) {
+        have_cpuinfo_mhz = cpuinfo_mhz(NULL, 0, &mhz) == 0;
+    }
+    probe_hwmon();
+    if (num_temperature_inputs == 0) probe_thermal_zones();
+}
+
+int sensors_cpu_mhz(const int *cpus, int count, double *mhz) {
+    if (!probed) probe();
+    if (!have_cpufreq) return have_cpuinfo_mhz ? cpuinfo_mhz(cpus, count, mhz) : -1;
+    
+    int num_cpus = cpus ? count : (int)sysconf(_SC_NPROCESSORS_CONF);
+    int found = 0;
+    double total = 0.0;
+    for (int i = 0; i < num_cpus; i++) {
+        char path[128];
+        long khz;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpus ? cpus[i] : i);
+        if (read_long(path, &khz) != 0) continue;
+        total += khz / 1000.0;
+        found++;
+    }
+    if (found == 0) return -1;
+    *mhz = total / found;
+    return 0;
+}
+
+int sensors_temperature(double *celsius) {
+    if (!probed) probe();
+    
+    int found = 0;
+    double hottest = 0.0;
+    for (int i = 0; i < num_temperature_inputs; i++) {
+        long millidegrees;
+        if (read_long(temperature_inputs[i], &millidegrees) != 0) continue;
+        if (!found || millidegrees / 1000.0 > hottest) hottest = millidegrees / 1000.0;
+        found = 1;
+    }
+    if (!found) return -1;
+    *celsius = hottest;
+    return 0;
+}
+
+void sensors_print_status(void) {
+    if (!probed) probe();
+    printf("Sensors: frequency from %s, temperature from %s\n",
+           have_cpufreq ? "cpufreq" : have_cpuinfo_mhz ? "/proc/cpuinfo (no cpufreq)" : "nowhere (no cpufreq)",
+           num_temperature_inputs > 0 ? temperature_source : "nowhere (no hwmon or thermal zone)");
+}
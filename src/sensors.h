@@ -0,0 +1,19 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+// Clock and temperature readings from sysfs, cheap enough to poll while a
+// benchmark runs. Frequencies come from cpufreq (scaling_cur_freq), or the
+// "cpu MHz" lines of /proc/cpuinfo without it. Temperatures come from the
+// CPU hwmon driver (coretemp, k10temp, zenpower, ...), or the thermal zones.
+
+// Average current frequency in MHz over `cpus` (all online CPUs when NULL).
+// Returns 0 on success, -1 if no frequency source exists.
+int sensors_cpu_mhz(const int *cpus, int count, double *mhz);
+
+// Hottest CPU sensor in degrees Celsius. Returns 0 on success, -1 if none.
+int sensors_temperature(double *celsius);
+
+// One header line naming the frequency and temperature sources
+void sensors_print_status(void);
+
+#endif
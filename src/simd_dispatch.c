@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <string.h>
+#include "simd_kernels.h"
+#include "timing.h"
+
+typedef struct {
+    const simd_kernels_t *kernels;
+    int supported;
+} simd_candidate_t;
+
+#define MAX_CANDIDATES 4
+
+// Short peak runs repeated during measure_simd_peak's warm-up
+#define PEAK_WARMUP_OPERATIONS 1000000LL
+
+// Every kernel set built into this binary, widest first; returns the count
+static int simd_candidates(const cpu_features_t *features, simd_candidate_t *candidates) {
+    int count = 0;
+#ifdef HAVE_AVX512
+    candidates[count++] = (simd_candidate_t){ &simd_kernels_avx512, features->avx512f && features->fma };
+#endif
+#ifdef HAVE_AVX2
+    candidates[count++] = (simd_candidate_t){ &simd_kernels_avx2, features->avx2 && features->fma };
+#endif
+#ifdef HAVE_SSE2
+    candidates[count++] = (simd_candidate_t){ &simd_kernels_sse2, features->sse2 };
+#endif
+#ifdef HAVE_NEON
+    candidates[count++] = (simd_candidate_t){ &simd_kernels_neon, features->neon };
+#endif
+    (void)features;
+    (void)candidates;
+    return count;
+}
+
+int supported_simd_kernels(const cpu_features_t *features, const simd_kernels_t **kernels, int max) {
+    simd_candidate_t candidates[MAX_CANDIDATES];
+    int count = simd_candidates(features, candidates);
+    int supported = 0;
+    
+    for (int i = 0; i < count && supported < max; i++) {
+        if (candidates[i].supported) {
+            kernels[supported++] = candidates[i].kernels;
+        }
+    }
+    return supported;
+}
+
+const simd_kernels_t *select_simd_kernels(const cpu_features_t *features, const char *requested) {
+    simd_candidate_t candidates[MAX_CANDIDATES];
+    int count = simd_candidates(features, candidates);
+    
+    if (requested && *requested) {
+        int found = 0;
+        for (int i = 0; i < count; i++) {
+            if (strcmp(candidates[i].kernels->name, requested) == 0) {
+                if (candidates[i].supported) {
+                    return candidates[i].kernels;
+                }
+                found = 1;
+                break;
+            }
+        }
+        fprintf(stderr, "Requested ISA '%s' is %s, using best available\n",
+                requested, found ? "not supported on this CPU" : "unknown");
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (candidates[i].supported) {
+            return candidates[i].kernels;
+        }
+    }
+    return NULL;
+}
+
+void measure_simd_peak(const simd_kernels_t *simd, long long operations, int num_threads,
+                       trial_stats_t *stats) {
+    warmup_t warmup;
+    trial_set_t trials;
+    
+    for (warmup_start(&warmup); warmup_running(&warmup); ) {
+        simd->multithreaded_peak(PEAK_WARMUP_OPERATIONS, num_threads);
+    }
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, simd->multithreaded_peak(operations, num_threads));
+    }
+    trials_summarize(&trials, stats);
+}
@@ -0,0 +1,197 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "cpu_features.h"
+#include "verify.h"
+#include "stats.h"
+
+// FMA pipeline shape used to size the peak-throughput kernels. The defaults
+// match recent Intel/AMD cores (4-cycle FMA latency, 2 FMA ports); override
+// with -DFMA_LATENCY=N -DFMA_PORTS=N when building for other cores.
+#ifndef FMA_LATENCY
+#define FMA_LATENCY 4
+#endif
+#ifndef FMA_PORTS
+#define FMA_PORTS 2
+#endif
+
+// One independent accumulator per FMA in flight (latency x ports) keeps every
+// port busy each cycle. Clamped to 8..16 so the chains still fit in registers.
+#if FMA_LATENCY * FMA_PORTS < 8
+#define PEAK_ACCUMULATORS 8
+#elif FMA_LATENCY * FMA_PORTS > 16
+#define PEAK_ACCUMULATORS 16
+#else
+#define PEAK_ACCUMULATORS (FMA_LATENCY * FMA_PORTS)
+#endif
+
+// Columns of C per DGEMM micro-tile. Rows (dgemm_mr) are two vectors, so the
+// 2 x DGEMM_NR accumulators plus operands fit in 16 vector registers.
+#define DGEMM_NR 6
+
+// Op-mix matrix (--opmix): one throughput kernel per element type, operation
+// and number of independent chains, generated from these lists by
+// kernels_template.h. Each list takes a callback X and passes any extra
+// arguments through, so the lists nest.
+//
+//   X(type, element)
+#define OPMIX_TYPES(X, ...) \
+    X(f64, double, __VA_ARGS__) \
+    X(f32, float, __VA_ARGS__)
+
+// X(op, FLOPs per element per step, step). Steps keep every chain at a fixed
+// point (or a 2-cycle) of normal numbers, so no value drifts into denormals.
+// `exp` calls libm once per lane and counts each call as one operation.
+#define OPMIX_OPS(X, ...) \
+    X(fma, 2, "x = x*a + b", __VA_ARGS__) \
+    X(add, 2, "x = x + a - a", __VA_ARGS__) \
+    X(mul, 2, "x = x * a * (1/a)", __VA_ARGS__) \
+    X(div, 1, "x = a / x", __VA_ARGS__) \
+    X(sqrt, 2, "x = sqrt(x * a)", __VA_ARGS__) \
+    X(exp, 1, "x = exp(-x)", __VA_ARGS__)
+
+// X(label, chains): one dependent chain (latency-bound), a few, and enough
+// to cover the FMA pipeline (throughput-bound)
+#define OPMIX_CHAINS(X, ...) \
+    X(1, 1, __VA_ARGS__) \
+    X(4, 4, __VA_ARGS__) \
+    X(peak, PEAK_ACCUMULATORS, __VA_ARGS__)
+
+#define OPMIX_COUNT_ONE(...) +1
+#define OPMIX_TYPE_COUNT (0 OPMIX_TYPES(OPMIX_COUNT_ONE, ))
+#define OPMIX_OP_COUNT (0 OPMIX_OPS(OPMIX_COUNT_ONE, ))
+#define OPMIX_CHAIN_COUNT (0 OPMIX_CHAINS(OPMIX_COUNT_ONE, ))
+#define OPMIX_COUNT (OPMIX_TYPE_COUNT * OPMIX_OP_COUNT * OPMIX_CHAIN_COUNT)
+
+// One generated kernel. `run` takes the element-operation count (chain steps
+// x lanes x chains, a multiple of `granularity`) and returns elapsed seconds.
+typedef struct {
+    const char *type;
+    const char *op;
+    const char *step;
+    int chains;
+    int lanes;                  // elements per vector of `type`
+    long long granularity;      // lanes x chains
+    double flops_per_operation; // compile-time FLOPs of one element step
+    int fused;                  // 0 for fma on ISAs without a fused multiply-add
+    double (*run)(long long operations);
+} opmix_kernel_t;
+
+// Instruction tables (--instr): latency and reciprocal throughput of single
+// FP instructions per element type at the ISA's vector width. Each step is
+// exactly one instruction: one dependent chain for latency, and
+// INSTR_THROUGHPUT_CHAINS independent chains (more than latency x ports of
+// any current FMA, add or multiply unit) for throughput.
+//
+//   X(op, x86 mnemonic root, AArch64 mnemonic, step)
+#define INSTR_OPS(X, ...) \
+    X(fma, "fmadd231", "fmla", "x = x*a + b", __VA_ARGS__) \
+    X(mul, "mul", "fmul", "x = x * 1", __VA_ARGS__) \
+    X(add, "add", "fadd", "x = x + 0", __VA_ARGS__) \
+    X(div, "div", "fdiv", "x = a / x", __VA_ARGS__) \
+    X(sqrt, "sqrt", "fsqrt", "x = sqrt(x)", __VA_ARGS__)
+
+#define INSTR_THROUGHPUT_CHAINS 12
+#define INSTR_OP_COUNT (0 INSTR_OPS(OPMIX_COUNT_ONE, ))
+#define INSTR_COUNT (OPMIX_TYPE_COUNT * INSTR_OP_COUNT)
+
+// `latency` runs one chain, `throughput` INSTR_THROUGHPUT_CHAINS; both take
+// the number of instructions to issue and return elapsed seconds. `fused`
+// is 0 for the fma entry of ISAs without a fused multiply-add (SSE2), whose
+// kernels then time a separate multiply and add.
+typedef struct {
+    const char *type;
+    const char *op;
+    const char *mnemonic;
+    const char *step;
+    int bits;                   // vector width
+    int fused;
+    double (*latency)(long long instructions);
+    double (*throughput)(long long instructions);
+} instr_kernel_t;
+
+// Vectorized kernels built once per ISA (kernels_<isa>.c) and picked at
+// startup, so a single binary runs at full vector width on every host.
+//
+// `vectorized` and `multithreaded_vectorized` are latency-bound and take the
+// logical (per-lane) operation count; `peak` and `multithreaded_peak` take the
+// number of vector FMAs to issue. All return elapsed seconds and leave their
+// result in kernel_checksum (verify.h); `chain_flops` / `peak_flops` give
+// the FLOPs an operation count actually performs.
+//
+// The memory kernels are untimed and single-threaded over `n` elements; the
+// caller partitions arrays across threads. Pointers must be vector aligned.
+typedef struct {
+    const char *name;
+    int lanes;  // doubles per vector register
+    double (*vectorized)(long long operations);
+    double (*multithreaded_vectorized)(long long operations, int num_threads);
+    double (*peak)(long long operations);
+    double (*multithreaded_peak)(long long operations, int num_threads);
+    kernel_flops_t chain_flops;
+    kernel_flops_t peak_flops;
+    
+    // STREAM kernels: copy c = a, scale b = s*c, add c = a+b, triad a = b+s*c
+    void (*stream_copy)(double *c, const double *a, long long n);
+    void (*stream_scale)(double *b, const double *c, double scalar, long long n);
+    void (*stream_add)(double *c, const double *a, const double *b, long long n);
+    void (*stream_triad)(double *a, const double *b, const double *c, double scalar, long long n);
+    
+    // In-place x[i] = fma(x[i], ...) repeated `fmas` times: 2*fmas FLOPs per
+    // 16 bytes moved, for arithmetic-intensity (roofline) sweeps
+    void (*intensity)(double *x, long long n, int fmas);
+    
+    // Indexed accesses over 64-bit indices: dst[i] = table[index[i]] and
+    // table[index[i]] = src[i], with the instruction used for each
+    void (*gather)(double *dst, const double *table, const long long *index, long long n);
+    void (*scatter)(double *table, const long long *index, const double *src, long long n);
+    const char *gather_name;
+    const char *scatter_name;
+    
+    // SELL-C-sigma SpMV, C = lanes, over a slice range (see spmv_benchmark.c
+    // for the layout); untimed, caller partitions slices across threads
+    void (*spmv_sell)(long long slice_begin, long long slice_end, const long long *slice_ptr, const long long *col,
+                      const double *val, const long long *row_of, const double *x, double *y);
+    
+    // Register-blocked DGEMM micro-kernel: C[dgemm_mr x DGEMM_NR] += A * B
+    // from packed panels (see kernels_template.h for the packing layout)
+    int dgemm_mr;
+    void (*dgemm_micro)(long long kc, const double *a_packed, const double *b_packed, double *c, long long ldc);
+    
+    // OPMIX_COUNT kernels, ordered by type, then op, then chain count
+    const opmix_kernel_t *opmix;
+    
+    // INSTR_COUNT entries, ordered by type, then op
+    const instr_kernel_t *instr;
+} simd_kernels_t;
+
+#if defined(__x86_64__) || defined(__i386__)
+extern const simd_kernels_t simd_kernels_sse2;
+extern const simd_kernels_t simd_kernels_avx2;
+extern const simd_kernels_t simd_kernels_avx512;
+#elif defined(__aarch64__)
+extern const simd_kernels_t simd_kernels_neon;
+#endif
+
+// Share of `total` work items done by `thread_id`. The remainder goes to the
+// lowest-numbered threads, so every item runs whatever the thread count.
+static inline long long thread_share(long long total, int thread_id, int num_threads) {
+    return total / num_threads + (thread_id < total % num_threads);
+}
+
+// Widest kernel set supported by `features`. If `requested` names a supported
+// ISA it is used instead (for A/B comparisons); otherwise it is ignored.
+// Returns NULL only when no kernel set can run on this CPU.
+const simd_kernels_t *select_simd_kernels(const cpu_features_t *features, const char *requested);
+
+// Every kernel set `features` supports, widest first, up to `max` of them.
+// Returns how many were stored in `kernels`.
+int supported_simd_kernels(const cpu_features_t *features, const simd_kernels_t **kernels, int max);
+
+// Reference peak for other benchmarks: `multithreaded_peak` warmed up, then
+// timed over repeated trials (stats.h policy). Fills `stats` with seconds
+// per call of `operations`.
+void measure_simd_peak(const simd_kernels_t *simd, long long operations, int num_threads,
+                       trial_stats_t *stats);
+
+#endif
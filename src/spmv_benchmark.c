@@ -0,0 +1,904 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>        // OpenMP
+#include <unistd.h>     // for sysconf
+#include <fcntl.h>
+#include <sys/mman.h>   // Matrix Market files are parsed in place
+#include <sys/stat.h>
+#include "simd_kernels.h"  // per-ISA SELL SpMV and gather/scatter kernels
+#include "timing.h"        // monotonic clock, warm-up
+#include "stats.h"         // repeated trials, CV stopping rule
+#include "report.h"        // --json / --csv records
+#include "options.h"       // shared command-line options
+#include "affinity.h"      // thread pinning, so first touch and the kernels agree
+
+#define KERNEL_NAMES "csr,sell,gather,scatter"
+#define FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS ",matrix"
+
+// Synthetic matrices span this many times the L3 in CSR form, at least the
+// minimum and at most an eighth of physical memory (CSR and SELL coexist)
+#define SYNTHETIC_L3_MULTIPLE 4.0
+#define SYNTHETIC_MIN_BYTES (256.0 * 1024 * 1024)
+
+// Random matrix: row lengths uniform in 1 .. 2 * RANDOM_ROW_NNZ - 1
+#define RANDOM_ROW_NNZ 8
+
+// SELL-C-sigma: C is the vector width in doubles, sigma (the window within
+// which rows are sorted by length) this many slices
+#define SELL_SIGMA_SLICES 32
+
+// Without --ops / --time, each SpMV trial moves at least this many bytes
+#define SPMV_MIN_BYTES_PER_TRIAL (256.0 * 1024 * 1024)
+
+// Largest accepted error of a row, relative to its |A| |x|
+#define SPMV_TOLERANCE 1e-12
+
+// Gather / scatter: indices per pass, into a table sized like the synthetic
+// matrices; one pass moves GATHER_BYTES_PER_ELEMENT per index
+#define GATHER_INDICES (1LL << 23)
+#define GATHER_BYTES_PER_ELEMENT 24.0
+#define GATHER_MIN_BYTES_PER_TRIAL (256.0 * 1024 * 1024)
+
+// Thread partitions of index and value streams start on this many elements
+// (one 512-byte block), as in memory_benchmark.c
+#define PARTITION_ALIGN 64
+
+// Compressed sparse rows; row r holds [row_ptr[r], row_ptr[r + 1]) of col/val
+typedef struct {
+    char name[64];
+    long long rows;
+    long long cols;
+    long long nnz;
+    long long *row_ptr;
+    long long *col;
+    double *val;
+} csr_matrix_t;
+
+// SELL-C-sigma: rows sorted by length within windows of sigma rows, then cut
+// into slices of C rows stored column-major and padded to the slice's
+// longest row. Entry j of slice row l is at slice_ptr[s] + j * C + l; row_of
+// maps slice rows back to matrix rows (padding rows to `rows`).
+typedef struct {
+    int c;
+    int sigma;
+    long long slices;
+    long long padded_nnz;
+    long long *slice_ptr;
+    long long *col;
+    double *val;
+    long long *row_of;
+} sell_matrix_t;
+
+typedef enum { SYNTHETIC_STENCIL, SYNTHETIC_RANDOM } synthetic_kind_t;
+
+static const simd_kernels_t *simd;
+
+static unsigned long long mix64(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Contiguous slice [*begin, *end) of `n` elements owned by `thread_id`
+static void thread_range(long long n, int thread_id, int num_threads, long long *begin, long long *end) {
+    long long blocks = (n + PARTITION_ALIGN - 1) / PARTITION_ALIGN;
+    long long blocks_per_thread = (blocks + num_threads - 1) / num_threads;
+    
+    *begin = thread_id * blocks_per_thread * PARTITION_ALIGN;
+    *end = *begin + blocks_per_thread * PARTITION_ALIGN;
+    if (*begin > n) *begin = n;
+    if (*end > n) *end = n;
+}
+
+// Page-aligned and not yet touched: the thread that first writes a page
+// places it on its NUMA node
+static void *alloc_untouched(size_t bytes) {
+    void *ptr = NULL;
+    long page_size = sysconf(_SC_PAGESIZE);
+    
+    if (posix_memalign(&ptr, page_size, bytes ? bytes : 1) != 0) return NULL;
+    return ptr;
+}
+
+// bounds[t] .. bounds[t + 1] is thread t's share of the `count` items whose
+// work starts at offsets[i] (offsets[count] is the total), balanced by work
+static void balanced_bounds(const long long *offsets, long long count, int num_threads, long long *bounds) {
+    bounds[0] = 0;
+    for (int t = 1; t < num_threads; t++) {
+        long long target = offsets[count] / num_threads * t;
+        long long low = bounds[t - 1], high = count;
+        while (low < high) {
+            long long middle = low + (high - low) / 2;
+            if (offsets[middle] < target) low = middle + 1;
+            else high = middle;
+        }
+        bounds[t] = low;
+    }
+    bounds[num_threads] = count;
+}
+
+// Row r of a synthetic matrix: its length, plus its entries when `col` is set.
+// The stencil is the 5-point Laplacian on a side x side grid (regular, x
+// accesses local); the random matrix scatters its columns over all of x.
+static long long synthetic_row(synthetic_kind_t kind, long long side, long long r, long long *col, double *val) {
+    long long length = 0;
+    
+    if (kind == SYNTHETIC_STENCIL) {
+        long long i = r / side, j = r % side;
+        const long long neighbours[5] = { r - side, r - 1, r, r + 1, r + side };
+        const int valid[5] = { i > 0, j > 0, 1, j < side - 1, i < side - 1 };
+        for (int k = 0; k < 5; k++) {
+            if (!valid[k]) continue;
+            if (col) {
+                col[length] = neighbours[k];
+                val[length] = neighbours[k] == r ? 4.0 : -1.0;
+            }
+            length++;
+        }
+        return length;
+    }
+    
+    long long rows = side * side;
+    length = 1 + (long long)(mix64(r) % (2 * RANDOM_ROW_NNZ - 1));
+    for (long long k = 0; col && k < length; k++) {
+        col[k] = (long long)(mix64(r * (2 * RANDOM_ROW_NNZ) + k + 1) % rows);
+        val[k] = 1.0 / (1 + k);
+    }
+    return length;
+}
+
+// Rows so that the CSR arrays (16 bytes per entry, 8 per row) fill `bytes`,
+// rounded to a square grid for the stencil
+static long long synthetic_side(synthetic_kind_t kind, double bytes) {
+    double entries_per_row = kind == SYNTHETIC_STENCIL ? 5.0 : RANDOM_ROW_NNZ;
+    long long side = (long long)sqrt(bytes / (entries_per_row * 16.0 + 8.0));
+    return side < 2 ? 2 : side;
+}
+
+static int build_synthetic(synthetic_kind_t kind, double bytes, int num_threads, csr_matrix_t *m) {
+    long long side = synthetic_side(kind, bytes);
+    
+    snprintf(m->name, sizeof(m->name), "%s", kind == SYNTHETIC_STENCIL ? "stencil" : "random");
+    m->rows = m->cols = side * side;
+    m->row_ptr = alloc_untouched((m->rows + 1) * sizeof(long long));
+    long long *bounds = malloc((num_threads + 1) * sizeof(long long));
+    if (!m->row_ptr || !bounds) {
+        free(bounds);
+        return -1;
+    }
+    
+    omp_set_num_threads(num_threads);
+    
+    // Row lengths where each row's thread first touches them, then offsets
+    m->row_ptr[0] = 0;
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(m->rows, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long r = begin; r < end; r++) {
+            m->row_ptr[r + 1] = synthetic_row(kind, side, r, NULL, NULL);
+        }
+    }
+    for (long long r = 0; r < m->rows; r++) {
+        m->row_ptr[r + 1] += m->row_ptr[r];
+    }
+    m->nnz = m->row_ptr[m->rows];
+    
+    m->col = alloc_untouched(m->nnz * sizeof(long long));
+    m->val = alloc_untouched(m->nnz * sizeof(double));
+    if (!m->col || !m->val) {
+        free(bounds);
+        return -1;
+    }
+    
+    // Entries are written (first touched) by the thread that multiplies them
+    balanced_bounds(m->row_ptr, m->rows, num_threads, bounds);
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        affinity_bind_thread(t);
+        for (long long r = bounds[t]; r < bounds[t + 1]; r++) {
+            synthetic_row(kind, side, r, m->col + m->row_ptr[r], m->val + m->row_ptr[r]);
+        }
+    }
+    
+    free(bounds);
+    return 0;
+}
+
+// Matrix Market text, read straight from the mapping. Numbers are parsed
+// against `end`, since the mapping is not NUL-terminated.
+typedef struct {
+    const char *p;
+    const char *end;
+} text_cursor_t;
+
+static void skip_blanks(text_cursor_t *text) {
+    while (text->p < text->end && (*text->p == ' ' || *text->p == '\t' || *text->p == '\r' || *text->p == '\n')) {
+        text->p++;
+    }
+}
+
+static void skip_line(text_cursor_t *text) {
+    while (text->p < text->end && *text->p != '\n') text->p++;
+    if (text->p < text->end) text->p++;
+}
+
+static int parse_integer(text_cursor_t *text, long long *value) {
+    skip_blanks(text);
+    int negative = text->p < text->end && *text->p == '-';
+    if (negative) text->p++;
+    if (text->p >= text->end || *text->p < '0' || *text->p > '9') return -1;
+    long long result = 0;
+    while (text->p < text->end && *text->p >= '0' && *text->p <= '9') {
+        result = result * 10 + (*text->p++ - '0');
+    }
+    *value = negative ? -result : result;
+    return 0;
+}
+
+static int parse_real(text_cursor_t *text, double *value) {
+    char token[64];
+    size_t length = 0;
+    
+    skip_blanks(text);
+    while (text->p < text->end && length + 1 < sizeof(token) && *text->p != ' ' && *text->p != '\t' &&
+           *text->p != '\r' && *text->p != '\n') {
+        token[length++] = *text->p++;
+    }
+    token[length] = '\0';
+    
+    char *parsed;
+    *value = strtod(token, &parsed);
+    return length > 0 && *parsed == '\0' ? 0 : -1;
+}
+
+// One pass over the entries: counts entries per row into row_ptr[r + 1]
+// when `cursor` is NULL, otherwise stores them at cursor[r]++
+static int matrix_market_pass(text_cursor_t text, long long entries, int pattern, int symmetry,
+                              csr_matrix_t *m, long long *cursor) {
+    for (long long e = 0; e < entries; e++) {
+        long long i, j;
+        double value = 1.0;
+        if (parse_integer(&text, &i) != 0 || parse_integer(&text, &j) != 0) return -1;
+        if (!pattern && parse_real(&text, &value) != 0) return -1;
+        if (i < 1 || i > m->rows || j < 1 || j > m->cols) return -1;
+        i--;
+        j--;
+        
+        // symmetry: 0 general, 1 symmetric, -1 skew-symmetric (lower triangle stored)
+        int mirrored = symmetry != 0 && i != j;
+        if (!cursor) {
+            m->row_ptr[i + 1]++;
+            if (mirrored) m->row_ptr[j + 1]++;
+            continue;
+        }
+        m->col[cursor[i]] = j;
+        m->val[cursor[i]++] = value;
+        if (mirrored) {
+            m->col[cursor[j]] = i;
+            m->val[cursor[j]++] = symmetry * value;
+        }
+    }
+    return 0;
+}
+
+// Load a coordinate Matrix Market file (real, integer or pattern; general,
+// symmetric or skew-symmetric) into CSR without reading it into a buffer:
+// the file is mapped, counted in one pass and scattered into place in a
+// second, so only the CSR arrays take memory.
+static int load_matrix_market(const char *path, int num_threads, csr_matrix_t *m) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Cannot read Matrix Market file %s\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    const char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Cannot map Matrix Market file %s\n", path);
+        return -1;
+    }
+    madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+    
+    text_cursor_t text = { data, data + st.st_size };
+    char banner[5][32] = { { 0 } };
+    const char *line_end = memchr(text.p, '\n', text.end - text.p);
+    char header[256];
+    size_t header_length = (line_end ? line_end : text.end) - text.p;
+    if (header_length >= sizeof(header)) header_length = sizeof(header) - 1;
+    memcpy(header, text.p, header_length);
+    header[header_length] = '\0';
+    for (char *p = header; *p; p++) {
+        if (*p >= 'A' && *p <= 'Z') *p += 'a' - 'A';
+    }
+    
+    int fields = sscanf(header, "%31s %31s %31s %31s %31s", banner[0], banner[1], banner[2], banner[3], banner[4]);
+    int pattern = strcmp(banner[3], "pattern") == 0;
+    int symmetry = strcmp(banner[4], "symmetric") == 0 ? 1 : strcmp(banner[4], "skew-symmetric") == 0 ? -1 : 0;
+    if (fields != 5 || strcmp(banner[0], "%%matrixmarket") != 0 || strcmp(banner[1], "matrix") != 0 ||
+        strcmp(banner[2], "coordinate") != 0 ||
+        !(pattern || strcmp(banner[3], "real") == 0 || strcmp(banner[3], "integer") == 0) ||
+        !(symmetry != 0 || strcmp(banner[4], "general") == 0)) {
+        printf("Unsupported Matrix Market header in %s (need coordinate real|integer|pattern, "
+               "general|symmetric|skew-symmetric)\n", path);
+        munmap((void *)data, st.st_size);
+        return -1;
+    }
+    
+    // Comments, then "rows cols entries"
+    while (text.p < text.end && *text.p == '%') skip_line(&text);
+    long long entries;
+    if (parse_integer(&text, &m->rows) != 0 || parse_integer(&text, &m->cols) != 0 ||
+        parse_integer(&text, &entries) != 0 || m->rows <= 0 || m->cols <= 0 || entries < 0) {
+        printf("Bad Matrix Market size line in %s\n", path);
+        munmap((void *)data, st.st_size);
+        return -1;
+    }
+    
+    const char *slash = strrchr(path, '/');
+    snprintf(m->name, sizeof(m->name), "%s", slash ? slash + 1 : path);
+    m->row_ptr = alloc_untouched((m->rows + 1) * sizeof(long long));
+    long long *bounds = malloc((num_threads + 1) * sizeof(long long));
+    long long *cursor = malloc(m->rows * sizeof(long long));
+    int status = -1;
+    if (!m->row_ptr || !bounds || !cursor) {
+        printf("Matrix %s: allocation failed\n", m->name);
+        goto done;
+    }
+    
+    omp_set_num_threads(num_threads);
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(m->rows + 1, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        memset(m->row_ptr + begin, 0, (end - begin) * sizeof(long long));
+    }
+    if (matrix_market_pass(text, entries, pattern, symmetry, m, NULL) != 0) {
+        printf("Bad Matrix Market entry in %s\n", path);
+        goto done;
+    }
+    for (long long r = 0; r < m->rows; r++) {
+        m->row_ptr[r + 1] += m->row_ptr[r];
+    }
+    m->nnz = m->row_ptr[m->rows];
+    
+    m->col = alloc_untouched(m->nnz * sizeof(long long));
+    m->val = alloc_untouched(m->nnz * sizeof(double));
+    if (!m->col || !m->val) {
+        printf("Matrix %s: allocation failed\n", m->name);
+        goto done;
+    }
+    
+    // Zero each thread's rows first, so their pages live where they are used
+    balanced_bounds(m->row_ptr, m->rows, num_threads, bounds);
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        affinity_bind_thread(t);
+        long long begin = m->row_ptr[bounds[t]], end = m->row_ptr[bounds[t + 1]];
+        memset(m->col + begin, 0, (end - begin) * sizeof(long long));
+        memset(m->val + begin, 0, (end - begin) * sizeof(double));
+    }
+    memcpy(cursor, m->row_ptr, m->rows * sizeof(long long));
+    if (matrix_market_pass(text, entries, pattern, symmetry, m, cursor) == 0) status = 0;
+
+done:
+    free(cursor);
+    free(bounds);
+    munmap((void *)data, st.st_size);
+    return status;
+}
+
+static void free_csr(csr_matrix_t *m) {
+    free(m->row_ptr);
+    free(m->col);
+    free(m->val);
+    memset(m, 0, sizeof(*m));
+}
+
+static double csr_bytes(const csr_matrix_t *m) {
+    return m->nnz * 16.0 + (m->rows + 1) * 8.0;
+}
+
+typedef struct {
+    long long length;
+    long long row;
+} row_length_t;
+
+// Longest first; ties keep matrix order so the sort is deterministic
+static int compare_row_length(const void *a, const void *b) {
+    const row_length_t *x = a, *y = b;
+    if (x->length != y->length) return x->length < y->length ? 1 : -1;
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+static int build_sell(const csr_matrix_t *m, int c, int num_threads, sell_matrix_t *s) {
+    s->c = c;
+    s->sigma = SELL_SIGMA_SLICES * c;
+    s->slices = (m->rows + c - 1) / c;
+    s->slice_ptr = malloc((s->slices + 1) * sizeof(long long));
+    s->row_of = alloc_untouched(s->slices * c * sizeof(long long));
+    row_length_t *order = malloc(s->sigma * sizeof(row_length_t));
+    long long *bounds = malloc((num_threads + 1) * sizeof(long long));
+    if (!s->slice_ptr || !s->row_of || !order || !bounds) {
+        free(order);
+        free(bounds);
+        return -1;
+    }
+    
+    // Sort each sigma window by row length, then pad each slice of C rows
+    s->slice_ptr[0] = 0;
+    for (long long window = 0; window < m->rows; window += s->sigma) {
+        long long count = m->rows - window < s->sigma ? m->rows - window : s->sigma;
+        for (long long i = 0; i < count; i++) {
+            order[i].row = window + i;
+            order[i].length = m->row_ptr[window + i + 1] - m->row_ptr[window + i];
+        }
+        qsort(order, count, sizeof(row_length_t), compare_row_length);
+        for (long long first = 0; first < count; first += c) {
+            long long slice = (window + first) / c;
+            for (int l = 0; l < c; l++) {
+                s->row_of[slice * c + l] = first + l < count ? order[first + l].row : m->rows;
+            }
+            s->slice_ptr[slice + 1] = s->slice_ptr[slice] + c * order[first].length;
+        }
+    }
+    s->padded_nnz = s->slice_ptr[s->slices];
+    free(order);
+    
+    s->col = alloc_untouched(s->padded_nnz * sizeof(long long));
+    s->val = alloc_untouched(s->padded_nnz * sizeof(double));
+    if (!s->col || !s->val) {
+        free(bounds);
+        return -1;
+    }
+    
+    // Slices are filled (first touched) by the thread that multiplies them;
+    // padding gathers x[0] and adds zero
+    balanced_bounds(s->slice_ptr, s->slices, num_threads, bounds);
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        affinity_bind_thread(t);
+        for (long long slice = bounds[t]; slice < bounds[t + 1]; slice++) {
+            long long width = (s->slice_ptr[slice + 1] - s->slice_ptr[slice]) / c;
+            for (int l = 0; l < c; l++) {
+                long long row = s->row_of[slice * c + l];
+                long long begin = row < m->rows ? m->row_ptr[row] : 0;
+                long long length = row < m->rows ? m->row_ptr[row + 1] - begin : 0;
+                for (long long j = 0; j < width; j++) {
+                    long long k = s->slice_ptr[slice] + j * c + l;
+                    s->col[k] = j < length ? m->col[begin + j] : 0;
+                    s->val[k] = j < length ? m->val[begin + j] : 0.0;
+                }
+            }
+        }
+    }
+    
+    free(bounds);
+    return 0;
+}
+
+static void free_sell(sell_matrix_t *s) {
+    free(s->slice_ptr);
+    free(s->col);
+    free(s->val);
+    free(s->row_of);
+    memset(s, 0, sizeof(*s));
+}
+
+static double sell_bytes(const sell_matrix_t *s) {
+    return s->padded_nnz * 16.0 + (s->slices + 1) * 8.0 + s->slices * s->c * 8.0;
+}
+
+// Plain CSR rows [begin, end): a dot product per row, x read through col
+static void csr_spmv(const csr_matrix_t *m, long long begin, long long end, const double *x, double *y) {
+    for (long long r = begin; r < end; r++) {
+        double sum = 0.0;
+        for (long long k = m->row_ptr[r]; k < m->row_ptr[r + 1]; k++) {
+            sum += m->val[k] * x[m->col[k]];
+        }
+        y[r] = sum;
+    }
+}
+
+// `operations` products y = A x per trial, each thread on its own rows
+// (CSR, `csr` set) or slices (SELL); bounds balance the entries per thread
+typedef struct {
+    const csr_matrix_t *csr;
+    const sell_matrix_t *sell;
+    const long long *bounds;
+    const double *x;
+    double *y;
+    int num_threads;
+} spmv_call_t;
+
+static double spmv_run(long long operations, void *context) {
+    const spmv_call_t *call = context;
+    
+    omp_set_num_threads(call->num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        affinity_bind_thread(t);
+        for (long long i = 0; i < operations; i++) {
+            if (call->csr) {
+                csr_spmv(call->csr, call->bounds[t], call->bounds[t + 1], call->x, call->y);
+            } else {
+                const sell_matrix_t *s = call->sell;
+                simd->spmv_sell(call->bounds[t], call->bounds[t + 1], s->slice_ptr, s->col, s->val, s->row_of,
+                                call->x, call->y);
+            }
+        }
+    }
+    
+    return get_time() - start_time;
+}
+
+// Warm up, then time trials until the CV stopping rule is met. One
+// operation is a whole product or gather pass, so --time scales the last
+// warm-up pass. Returns the operations per trial; `stats` is over elapsed
+// seconds.
+static long long measure(const bench_options_t *opts, timed_run_fn run, void *context, long long fallback,
+                         trial_stats_t *stats) {
+    warmup_t warmup;
+    trial_set_t trials;
+    double pass_time = 0.0;
+    
+    for (warmup_start(&warmup); warmup_running(&warmup) || pass_time == 0.0; ) {
+        pass_time = run(1, context);
+    }
+    
+    long long operations = options_passes(opts, pass_time, fallback);
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, run(operations, context));
+    }
+    trials_summarize(&trials, stats);
+    return operations;
+}
+
+// Largest error of any row of y against the serial CSR product, relative
+// to that row's |A| |x| (so cancelling rows do not blow up the ratio)
+static double spmv_error(const csr_matrix_t *m, const double *x, const double *y) {
+    double max_error = 0.0;
+    
+    for (long long r = 0; r < m->rows; r++) {
+        double sum = 0.0, magnitude = 0.0;
+        for (long long k = m->row_ptr[r]; k < m->row_ptr[r + 1]; k++) {
+            sum += m->val[k] * x[m->col[k]];
+            magnitude += fabs(m->val[k] * x[m->col[k]]);
+        }
+        double error = fabs(y[r] - sum) / (magnitude > 0.0 ? magnitude : 1.0);
+        if (error > max_error) max_error = error;
+    }
+    return max_error;
+}
+
+static void print_spmv(const char *label, const char *kernel, const csr_matrix_t *m, double bytes, int num_threads,
+                       long long operations, const trial_stats_t *stats, double error, double *best_gflops) {
+    double flops = 2.0 * m->nnz * operations;
+    double gflops = (flops / stats->median) / 1e9;
+    
+    printf("   %s: %.2f GFLOPS, %.2f GB/s (%lld products per trial, median of %d trials)\n", label, gflops,
+           (bytes * operations / stats->median) / 1e9, operations, stats->count);
+    print_trial_stats("   ", stats);
+    printf("   Max row error: %.2e%s\n", error, error > SPMV_TOLERANCE ? "  FAILED" : "");
+    if (gflops > *best_gflops) *best_gflops = gflops;
+    
+    char record[48];
+    snprintf(record, sizeof(record), "spmv_%.4s_%.32s", kernel, m->name);
+    report_add(record, strcmp(kernel, "csr") == 0 ? "scalar" : simd->name, num_threads, (double)m->nnz * operations,
+               flops, stats);
+}
+
+// CSR and SELL-C-sigma products of one matrix; returns failed checks
+static int spmv_matrix(const bench_options_t *opts, csr_matrix_t *m, const char *source, double seconds,
+                       int num_threads, double *best_gflops) {
+    int failures = 0;
+    double *x = alloc_untouched(m->cols * sizeof(double));
+    double *y = alloc_untouched((m->rows + 1) * sizeof(double));  // + the SELL padding row
+    long long *bounds = malloc((num_threads + 1) * sizeof(long long));
+    sell_matrix_t sell = { 0 };
+    if (!x || !y || !bounds) {
+        printf("   Vector allocation failed, skipped\n\n");
+        failures++;
+        goto done;
+    }
+    
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(m->cols, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = begin; i < end; i++) x[i] = 1.0 + (i % 13) * 0.01;
+        thread_range(m->rows + 1, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = begin; i < end; i++) y[i] = 0.0;
+    }
+    
+    printf("Matrix %s: %lld x %lld, %lld entries (%.1f per row), CSR %.1f MB, %s in %.2f s\n", m->name, m->rows,
+           m->cols, m->nnz, (double)m->nnz / m->rows, csr_bytes(m) / 1e6, source, seconds);
+    
+    // Matrix arrays once plus x and y: the traffic of an out-of-cache product
+    double vectors = (m->rows + m->cols) * 8.0;
+    
+    if (options_kernel_selected(opts, "csr")) {
+        balanced_bounds(m->row_ptr, m->rows, num_threads, bounds);
+        spmv_call_t call = { m, NULL, bounds, x, y, num_threads };
+        double bytes = csr_bytes(m) + vectors;
+        long long fallback = (long long)(SPMV_MIN_BYTES_PER_TRIAL / bytes) + 1;
+        trial_stats_t stats;
+        long long operations = measure(opts, spmv_run, &call, fallback, &stats);
+        double error = spmv_error(m, x, y);
+        if (error > SPMV_TOLERANCE) failures++;
+        print_spmv("CSR", "csr", m, bytes, num_threads, operations, &stats, error, best_gflops);
+    }
+    
+    if (options_kernel_selected(opts, "sell")) {
+        double start_time = get_time();
+        if (build_sell(m, simd->lanes, num_threads, &sell) != 0) {
+            printf("   SELL allocation failed, skipped\n\n");
+            failures++;
+            goto done;
+        }
+        printf("   SELL-%d-%d: %lld slices, %.1f%% of stored entries are matrix entries, built in %.2f s\n", sell.c,
+               sell.sigma, sell.slices, 100.0 * m->nnz / (sell.padded_nnz ? sell.padded_nnz : 1),
+               get_time() - start_time);
+        balanced_bounds(sell.slice_ptr, sell.slices, num_threads, bounds);
+        spmv_call_t call = { NULL, &sell, bounds, x, y, num_threads };
+        double bytes = sell_bytes(&sell) + vectors;
+        long long fallback = (long long)(SPMV_MIN_BYTES_PER_TRIAL / bytes) + 1;
+        trial_stats_t stats;
+        long long operations = measure(opts, spmv_run, &call, fallback, &stats);
+        double error = spmv_error(m, x, y);
+        if (error > SPMV_TOLERANCE) failures++;
+        
+        char label[48];
+        snprintf(label, sizeof(label), "SELL-%d-%d (%s, %s)", sell.c, sell.sigma, simd->name, simd->gather_name);
+        print_spmv(label, "sell", m, bytes, num_threads, operations, &stats, error, best_gflops);
+    }
+    printf("\n");
+
+done:
+    free_sell(&sell);
+    free(bounds);
+    free(x);
+    free(y);
+    return failures;
+}
+
+// Gather / scatter passes: every thread moves its own slice of the index
+// array and of the dense stream; the table is shared
+typedef struct {
+    int scatter;
+    double *table;
+    const long long *index;
+    double *stream;
+    long long n;
+    int num_threads;
+} indexed_call_t;
+
+static double indexed_run(long long operations, void *context) {
+    const indexed_call_t *call = context;
+    
+    omp_set_num_threads(call->num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(call->n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = 0; i < operations; i++) {
+            if (call->scatter) {
+                simd->scatter(call->table, call->index + begin, call->stream + begin, end - begin);
+            } else {
+                simd->gather(call->stream + begin, call->table, call->index + begin, end - begin);
+            }
+        }
+    }
+    
+    return get_time() - start_time;
+}
+
+// Gather and scatter bandwidth for unit to cache-line-skipping strides and
+// uniform random indices. Returns failed checks (gathered sums).
+static int indexed_benchmark(const bench_options_t *opts, double table_bytes, int num_threads) {
+    const struct {
+        const char *name;
+        long long stride;   // in doubles; 0 = random
+    } patterns[] = {
+        { "stride1", 1 }, { "stride2", 2 }, { "stride4", 4 }, { "stride8", 8 },
+        { "stride16", 16 }, { "stride64", 64 }, { "random", 0 },
+    };
+    const int num_patterns = sizeof(patterns) / sizeof(patterns[0]);
+    int run_gather = options_kernel_selected(opts, "gather");
+    int run_scatter = options_kernel_selected(opts, "scatter");
+    if (!run_gather && !run_scatter) return 0;
+    
+    long long table_n = (long long)(table_bytes / sizeof(double));
+    long long n = GATHER_INDICES;
+    double *table = alloc_untouched(table_n * sizeof(double));
+    long long *index = alloc_untouched(n * sizeof(long long));
+    double *stream = alloc_untouched(n * sizeof(double));
+    int failures = 0;
+    if (!table || !index || !stream) {
+        printf("Gather / scatter allocation failed, skipped\n");
+        free(table);
+        free(index);
+        free(stream);
+        return 1;
+    }
+    
+    // Table values are small integers, so gathered sums are exact
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, end;
+        thread_range(table_n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = begin; i < end; i++) table[i] = (double)(i % 1024);
+        thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        for (long long i = begin; i < end; i++) {
+            index[i] = 0;
+            stream[i] = 1.0;
+        }
+    }
+    
+    printf("Gather / Scatter (%s gather %s, scatter %s; %lld indices into a %.1f MB table):\n", simd->name,
+           simd->gather_name, simd->scatter_name, n, table_bytes / 1e6);
+    printf("   %-9s %12s %12s %12s %12s\n", "Pattern", "Gather GB/s", "Gather Me/s", "Scatter GB/s", "Scatter Me/s");
+    
+    for (int p = 0; p < num_patterns; p++) {
+        long long stride = patterns[p].stride;
+        #pragma omp parallel
+        {
+            affinity_bind_thread(omp_get_thread_num());
+            long long begin, end;
+            thread_range(n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+            for (long long i = begin; i < end; i++) {
+                index[i] = stride ? (i * stride) % table_n : (long long)(mix64(i) % table_n);
+            }
+        }
+        printf("   %-9s", patterns[p].name);
+        
+        long long fallback = (long long)(GATHER_MIN_BYTES_PER_TRIAL / (GATHER_BYTES_PER_ELEMENT * n)) + 1;
+        for (int scatter = 0; scatter < 2; scatter++) {
+            if (!(scatter ? run_scatter : run_gather)) {
+                printf(" %12s %12s", "-", "-");
+                continue;
+            }
+            indexed_call_t call = { scatter, table, index, stream, n, num_threads };
+            trial_stats_t stats;
+            long long operations = measure(opts, indexed_run, &call, fallback, &stats);
+            double elements = (double)n * operations;
+            printf(" %12.2f %12.1f", (elements * GATHER_BYTES_PER_ELEMENT / stats.median) / 1e9,
+                   (elements / stats.median) / 1e6);
+            fflush(stdout);
+            
+            if (!scatter) {
+                double sum = 0.0, expected = 0.0;
+                for (long long i = 0; i < n; i++) {
+                    sum += stream[i];
+                    expected += table[index[i]];
+                }
+                if (sum != expected) failures++;
+            }
+            
+            char record[48];
+            snprintf(record, sizeof(record), "%s_%s", scatter ? "scatter" : "gather", patterns[p].name);
+            report_add(record, simd->name, num_threads, elements, 0.0, &stats);
+        }
+        printf("\n");
+        
+        // Scatter wrote 1.0 over the table; restore it for the next gather
+        if (run_scatter) {
+            #pragma omp parallel
+            {
+                long long begin, end;
+                thread_range(table_n, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+                for (long long i = begin; i < end; i++) table[i] = (double)(i % 1024);
+            }
+        }
+    }
+    printf("   GB/s counts %.0f bytes per element (index, table value, dense stream); strides are in doubles\n",
+           GATHER_BYTES_PER_ELEMENT);
+    if (failures) printf("   Gathered values did not match the table for %d pattern(s)\n", failures);
+    printf("\n");
+    
+    free(table);
+    free(index);
+    free(stream);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    bench_options_t opts;
+    int status = options_parse(argc, argv, KERNEL_NAMES, FLAG_NAMES, &opts);
+    if (status) return status < 0;
+    report_begin("spmv", opts.format);
+    
+    int num_threads = opts.threads > 0 ? opts.threads : affinity_default_threads();
+    
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    if (!simd) {
+        printf("No supported SIMD instruction set found\n");
+        return 1;
+    }
+    
+    // Working sets well past the L3, capped at an eighth of physical memory
+    cache_info_t caches;
+    detect_cache_sizes(&caches);
+    double phys_bytes = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    double bytes = SYNTHETIC_L3_MULTIPLE * caches.l3;
+    if (bytes < SYNTHETIC_MIN_BYTES) bytes = SYNTHETIC_MIN_BYTES;
+    if (phys_bytes > 0 && bytes > phys_bytes / 8) bytes = phys_bytes / 8;
+    
+    printf("=== Sparse and Irregular-Access Benchmark ===\n");
+    printf("Available cores: %d\n", num_cores);
+    printf("SIMD kernels: %s (gather: %s, scatter: %s)\n", simd->name, simd->gather_name, simd->scatter_name);
+    printf("Timer: monotonic clock (%.0f ns resolution), warm-up %.0f ms\n", get_time_resolution() * 1e9,
+           warmup_seconds() * 1000.0);
+    affinity_print_map(num_threads);
+    printf("\n");
+    
+    // SISU_MATRIX (--matrix) picks a Matrix Market file, or one synthetic matrix
+    const char *matrix = getenv("SISU_MATRIX");
+    int failures = 0;
+    double best_gflops = 0.0;
+    if (options_kernel_selected(&opts, "csr") || options_kernel_selected(&opts, "sell")) {
+        const struct {
+            const char *name;
+            synthetic_kind_t kind;
+        } synthetic[] = { { "stencil", SYNTHETIC_STENCIL }, { "random", SYNTHETIC_RANDOM } };
+        for (int i = 0; i < 2; i++) {
+            if (matrix && *matrix && strcmp(matrix, synthetic[i].name) != 0) continue;
+            csr_matrix_t m = { 0 };
+            double start_time = get_time();
+            if (build_synthetic(synthetic[i].kind, bytes, num_threads, &m) != 0) {
+                printf("Matrix %s: allocation failed, skipped\n\n", synthetic[i].name);
+                failures++;
+            } else {
+                failures += spmv_matrix(&opts, &m, "generated", get_time() - start_time, num_threads, &best_gflops);
+            }
+            free_csr(&m);
+        }
+        if (matrix && *matrix && strcmp(matrix, "stencil") != 0 && strcmp(matrix, "random") != 0) {
+            csr_matrix_t m = { 0 };
+            double start_time = get_time();
+            if (load_matrix_market(matrix, num_threads, &m) != 0) {
+                failures++;
+            } else {
+                failures += spmv_matrix(&opts, &m, "loaded", get_time() - start_time, num_threads, &best_gflops);
+            }
+            free_csr(&m);
+        }
+    }
+    
+    failures += indexed_benchmark(&opts, bytes, num_threads);
+    
+    printf("=== SpMV Summary ===\n");
+    if (best_gflops > 0.0) printf("Best SpMV: %.2f GFLOPS\n", best_gflops);
+    if (failures) printf("Verification FAILED for %d test(s)\n", failures);
+    
+    report_finish();
+    return failures > 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "stats.h"
+
+#define DEFAULT_MIN_TRIALS 3
+#define DEFAULT_MAX_TRIALS 10
+#define DEFAULT_CV_TARGET_PERCENT 2.0
+
+static long env_long(const char *name, long fallback) {
+    const char *value = getenv(name);
+    return value && *value ? strtol(value, NULL, 10) : fallback;
+}
+
+void trials_begin(trial_set_t *trials) {
+    const char *cv_target = getenv("SISU_CV_TARGET");
+    
+    trials->count = 0;
+    trials->max_trials = env_long("SISU_TRIALS", DEFAULT_MAX_TRIALS);
+    trials->min_trials = env_long("SISU_MIN_TRIALS", DEFAULT_MIN_TRIALS);
+    trials->cv_target = (cv_target && *cv_target ? strtod(cv_target, NULL) : DEFAULT_CV_TARGET_PERCENT) / 100.0;
+    
+    if (trials->max_trials < 1) trials->max_trials = 1;
+    if (trials->max_trials > MAX_TRIALS) trials->max_trials = MAX_TRIALS;
+    if (trials->min_trials < 1) trials->min_trials = 1;
+    if (trials->min_trials > trials->max_trials) trials->min_trials = trials->max_trials;
+}
+
+int trials_continue(const trial_set_t *trials) {
+    if (trials->count < trials->min_trials) return 1;
+    if (trials->count >= trials->max_trials) return 0;
+    
+    trial_stats_t stats;
+    compute_stats(trials->samples, trials->count, &stats);
+    return stats.cv > trials->cv_target;
+}
+
+void trials_add(trial_set_t *trials, double sample) {
+    if (trials->count < MAX_TRIALS) {
+        trials->samples[trials->count++] = sample;
+    }
+}
+
+void trials_summarize(const trial_set_t *trials, trial_stats_t *stats) {
+    compute_stats(trials->samples, trials->count, stats);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linearly interpolated quantile of sorted samples
+static double quantile(const double *sorted, int count, double q) {
+    double position = q * (count - 1);
+    int lower = (int)position;
+    if (lower >= count - 1) return sorted[count - 1];
+    double fraction = position - lower;
+    return sorted[lower] + fraction * (sorted[lower + 1] - sorted[lower]);
+}
+
+void compute_stats(const double *samples, int count, trial_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->count = count;
+    if (count <= 0) return;
+    
+    double sorted[MAX_TRIALS];
+    if (count > MAX_TRIALS) count = MAX_TRIALS;
+    memcpy(sorted, samples, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += sorted[i];
+    stats->mean = sum / count;
+    
+    double squares = 0.0;
+    for (int i = 0; i < count; i++) {
+        double d = sorted[i] - stats->mean;
+        squares += d * d;
+    }
+    stats->stddev = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+    
+    stats->min = sorted[0];
+    stats->max = sorted[count - 1];
+    stats->median = quantile(sorted, count, 0.5);
+    stats->p95 = quantile(sorted, count, 0.95);
+    stats->cv = stats->mean > 0.0 ? stats->stddev / stats->mean : 0.0;
+}
+
+void print_trial_stats(const char *indent, const trial_stats_t *stats) {
+    printf("%sTime stats: n=%d min=%.6f median=%.6f mean=%.6f stddev=%.6f p95=%.6f cv=%.2f%%\n",
+           indent, stats->count, stats->min, stats->median, stats->mean, stats->stddev,
+           stats->p95, stats->cv * 100.0);
+}
@@ -0,0 +1,47 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Upper bound on trials per measurement
+#define MAX_TRIALS 100
+
+// Repeated-trial measurement with a coefficient-of-variation stopping rule:
+// at least `min_trials` samples, then stop once stddev/mean <= `cv_target`
+// or `max_trials` is reached.
+//
+//     trial_set_t trials;
+//     for (trials_begin(&trials); trials_continue(&trials); )
+//         trials_add(&trials, kernel(operations));
+//
+// Policy comes from SISU_MIN_TRIALS (default 3), SISU_TRIALS (max, default
+// 10) and SISU_CV_TARGET (percent, default 2).
+typedef struct {
+    double samples[MAX_TRIALS];
+    int count;
+    int min_trials;
+    int max_trials;
+    double cv_target;
+} trial_set_t;
+
+typedef struct {
+    int count;
+    double min;
+    double max;
+    double median;
+    double mean;
+    double stddev;  // sample standard deviation
+    double p95;     // 95th percentile, linearly interpolated
+    double cv;      // stddev / mean
+} trial_stats_t;
+
+void trials_begin(trial_set_t *trials);
+int trials_continue(const trial_set_t *trials);
+void trials_add(trial_set_t *trials, double sample);
+void trials_summarize(const trial_set_t *trials, trial_stats_t *stats);
+
+// Statistics of any sample array (need not be sorted)
+void compute_stats(const double *samples, int count, trial_stats_t *stats);
+
+// "<indent>Time stats: n=... min=... median=... mean=... stddev=... p95=... cv=...%"
+void print_trial_stats(const char *indent, const trial_stats_t *stats);
+
+#endif
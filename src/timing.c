@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <time.h>
+#include "timing.h"
+
+#define DEFAULT_WARMUP_MS 100
+
+// Calibration window for cycle_counter_hz()
+#define CALIBRATION_SECONDS 0.05
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define TIMING_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define TIMING_CLOCK CLOCK_MONOTONIC
+#endif
+
+double get_time(void) {
+    struct timespec ts;
+    clock_gettime(TIMING_CLOCK, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+double get_time_resolution(void) {
+    struct timespec ts;
+    if (clock_getres(TIMING_CLOCK, &ts) != 0) return 0.0;
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+static int has_rdtscp(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        cached = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && ((edx >> 27) & 1);
+    }
+    return cached;
+}
+
+unsigned long long read_cycles(void) {
+    unsigned int lo, hi, aux;
+    
+    if (has_rdtscp()) {
+        __asm__ volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux) :: "memory");
+    } else {
+        __asm__ volatile("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) :: "memory");
+    }
+    __asm__ volatile("lfence" ::: "memory");
+    
+    return ((unsigned long long)hi << 32) | lo;
+}
+
+const char *cycle_counter_name(void) {
+    return "TSC";
+}
+#elif defined(__aarch64__)
+unsigned long long read_cycles(void) {
+    unsigned long long value;
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(value) :: "memory");
+    return value;
+}
+
+const char *cycle_counter_name(void) {
+    return "CNTVCT";
+}
+#else
+unsigned long long read_cycles(void) {
+    return (unsigned long long)(get_time() * 1e9);
+}
+
+const char *cycle_counter_name(void) {
+    return "ns";
+}
+#endif
+
+double cycle_counter_hz(void) {
+    static double cached = 0.0;
+    
+    if (cached > 0.0) return cached;
+
+#if defined(__aarch64__)
+    // The generic timer publishes its own frequency
+    unsigned long long frequency;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    if (frequency > 0) {
+        cached = (double)frequency;
+        return cached;
+    }
+#elif !(defined(__x86_64__) || defined(__i386__))
+    cached = 1e9;
+    return cached;
+#endif
+
+    double start_time = get_time();
+    unsigned long long start_cycles = read_cycles();
+    double now;
+    do {
+        now = get_time();
+    } while (now - start_time < CALIBRATION_SECONDS);
+    unsigned long long end_cycles = read_cycles();
+    
+    cached = (end_cycles - start_cycles) / (now - start_time);
+    return cached;
+}
+
+// Adds per loop iteration of the core clock chain; the loop counter
+// updates run alongside the chain. The step is a register, not an
+// immediate: some cores fold chains of add-immediate at rename.
+#define CLOCK_CHAIN_ADDS 16
+#define CLOCK_CHAIN_ITERATIONS 100000LL
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CLOCK_CHAIN_ADD(x) __asm__ volatile("add %1, %0" : "+r"(x) : "r"(step))
+#elif defined(__aarch64__)
+#define CLOCK_CHAIN_ADD(x) __asm__ volatile("add %0, %0, %1" : "+r"(x) : "r"(step))
+#endif
+
+double core_clock_hz(double seconds) {
+#ifdef CLOCK_CHAIN_ADD
+    unsigned long value = 0, step = 1;
+    long long adds = 0;
+    double start_time = get_time();
+    double now;
+    do {
+        for (long long i = 0; i < CLOCK_CHAIN_ITERATIONS; i++) {
+            CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value);
+            CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value);
+            CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value);
+            CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value); CLOCK_CHAIN_ADD(value);
+        }
+        adds += CLOCK_CHAIN_ITERATIONS * CLOCK_CHAIN_ADDS;
+        now = get_time();
+    } while (now - start_time < seconds);
+    
+    return adds / (now - start_time);
+#else
+    (void)seconds;
+    return 0.0;
+#endif
+}
+
+double warmup_seconds(void) {
+    static double cached = -1.0;
+    
+    if (cached < 0.0) {
+        const char *value = getenv("SISU_WARMUP_MS");
+        long ms = value ? strtol(value, NULL, 10) : DEFAULT_WARMUP_MS;
+        cached = ms > 0 ? ms / 1000.0 : 0.0;
+    }
+    return cached;
+}
+
+void warmup_start(warmup_t *warmup) {
+    warmup->deadline = get_time() + warmup_seconds();
+}
+
+int warmup_running(const warmup_t *warmup) {
+    return get_time() < warmup->deadline;
+}
@@ -0,0 +1,48 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+// Shared timing: a monotonic wall clock immune to NTP steps, a serialized
+// cycle counter (TSC on x86, CNTVCT on AArch64) and a warm-up phase run
+// before each measurement.
+
+// Seconds from CLOCK_MONOTONIC_RAW (CLOCK_MONOTONIC where unavailable)
+double get_time(void);
+
+// Resolution of get_time() in seconds
+double get_time_resolution(void);
+
+// Serialized cycle counter read: earlier instructions retire before it and
+// later ones do not start until it completes. Counts at a fixed reference
+// rate (cycle_counter_hz()), not the current core clock.
+unsigned long long read_cycles(void);
+
+// Reference cycle counter frequency, calibrated against get_time() on first
+// use and cached
+double cycle_counter_hz(void);
+
+// "TSC", "CNTVCT" or "ns" (no hardware counter, read_cycles() returns ns)
+const char *cycle_counter_name(void);
+
+// Current core clock in Hz, timed over about `seconds` of a dependent chain
+// of integer adds (1 cycle each on every x86 and AArch64 core). Not cached:
+// the clock moves with load and temperature, so measure right after the
+// warm-up of the code it converts. 0 where the chain cannot be built.
+double core_clock_hz(double seconds);
+
+// Warm-up phase: repeat a short run of the kernel about to be measured so
+// caches, page tables and CPU clocks have settled, e.g.
+//
+//     warmup_t warmup;
+//     for (warmup_start(&warmup); warmup_running(&warmup); )
+//         kernel(WARMUP_OPERATIONS);
+//
+// Duration comes from SISU_WARMUP_MS (default 100 ms, 0 disables).
+typedef struct {
+    double deadline;
+} warmup_t;
+
+double warmup_seconds(void);
+void warmup_start(warmup_t *warmup);
+int warmup_running(const warmup_t *warmup);
+
+#endif
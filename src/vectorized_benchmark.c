@@ -1,68 +1,116 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
-#include <immintrin.h>  // AVX2 intrinsics
+#include <string.h>
+#include <math.h>
 #include <omp.h>        // OpenMP
+#include <time.h>       // nanosleep
 #include <unistd.h>     // for sysconf
+#include "simd_kernels.h"  // per-ISA vectorized kernels
+#include "timing.h"        // monotonic clock, cycle counter, warm-up
+#include "stats.h"         // repeated trials and their statistics
+#include "affinity.h"      // thread pinning
+#include "report.h"        // --json / --csv records
+#include "options.h"       // command-line options
+#include "perf_counters.h" // hardware counters around the trials
+#include "sensors.h"       // clock and temperature for soak samples
+#include "energy.h"        // RAPL energy around the trials
+#include "daemon.h"        // resident mode with a /metrics endpoint
+#include "verify.h"        // FLOP accounting and result checksums
 
-double get_time() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec / 1000000.0;
-}
+// Operations per warm-up call: short enough to repeat many times in the
+// warm-up window
+#define WARMUP_OPERATIONS 4000000LL
+
+// Operations per trial without --ops / --time
+#define DEFAULT_OPERATIONS 100000000LL
+
+// Test names for --kernels, also used as record names
+#define KERNEL_NAMES "scalar,vectorized,scalar_mt,vectorized_mt,peak,peak_mt,peak_socket,peak_dynamic,peak_coretype"
+#define FLAG_NAMES OPTIONS_TRIAL_FLAGS "," OPTIONS_PLACEMENT_FLAGS ",scaling,perf,energy," \
+                   "soak,soak-interval,daemon,daemon-interval,opmix,instr"
+
+// Dynamic scheduling splits the peak work into this many chunks per thread,
+// handed out first come, first served
+#define DYNAMIC_CHUNKS_PER_THREAD 64
+
+// Soak mode (--soak / SISU_SOAK seconds): chunks of at most this length per
+// worker, samples every SISU_SOAK_INTERVAL_MS (default 1000, at least 10), and
+// a sample below this share of the burst peak counts as throttled
+#define SOAK_CHUNK_SECONDS 0.002
+#define SOAK_DEFAULT_INTERVAL_MS 1000
+#define SOAK_MIN_INTERVAL_MS 10
+#define SOAK_THROTTLE_THRESHOLD 0.95
+
+// Daemon mode (--daemon / SISU_DAEMON): trials of this length unless --time
+// is given, calibrated by the first probe and fixed afterwards, plus a DRAM
+// triad over 4x the L3 (at least this much) split in vector-aligned blocks
+#define DAEMON_PROBE_SECONDS 0.05
+#define DAEMON_TRIAD_MIN_BYTES (256.0 * 1024 * 1024)
+#define DAEMON_TRIAD_BLOCK 64
+
+// Op-mix mode (--opmix / SISU_OPMIX): trials of this length unless --ops or
+// --time is given
+#define OPMIX_DEFAULT_SECONDS 0.02
+
+// Instruction tables (--instr / SISU_INSTR): trials of this length unless
+// --ops or --time is given, and the window of each core clock measurement
+#define INSTR_DEFAULT_SECONDS 0.02
+#define INSTR_CLOCK_SECONDS 0.01
+
+// Most kernel sets one binary carries (simd_dispatch.c)
+#define MAX_SIMD_KERNELS 4
+
+// Scaling sweeps report the first thread count whose parallel efficiency
+// falls below this
+#define SCALING_EFFICIENCY_THRESHOLD 0.90
+
+typedef double (*kernel_fn)(long long operations);
+typedef double (*threaded_kernel_fn)(long long operations, int num_threads);
+
+// Result of one test: operations per trial, trial statistics over elapsed
+// seconds, reference cycles of a single (average) trial, the hardware
+// counters and energy over all trials, and the last trial's checksum with
+// its check (verified: 1 matched, 0 mismatch, -1 no reference, -2 unchecked)
+typedef struct {
+    long long operations;
+    trial_stats_t stats;
+    double cycles;
+    perf_sample_t perf;
+    energy_sample_t energy;
+    double checksum;
+    double chain_steps;         // latency chain tests only
+    double expected;
+    int verified;
+} measurement_t;
+
+// The kernel under test, for the --time calibration probes
+typedef struct {
+    kernel_fn single;
+    threaded_kernel_fn threaded;
+    int num_threads;
+} kernel_call_t;
 
 // Single-threaded scalar benchmark
 double scalar_benchmark(long long operations) {
     volatile double a = 1.23456789;
     volatile double b = 9.87654321;
-    volatile double result = 0.0;
+    volatile double result = chain_start(a, b);
+    double steps = 0.0;
     
     double start_time = get_time();
     
     for (long long i = 0; i < operations; i++) {
         result = a * b + result;
-        a = result * 0.999999;
-        b = a + 1.000001;
+        a = result * CHAIN_MULTIPLIER;
+        b = a + CHAIN_ADDEND;
+        steps += 1.0;
     }
     
     double end_time = get_time();
     double elapsed = end_time - start_time;
     
-    // Prevent the result from being optimized away
-    if (result == 0.0) printf("Unexpected result\n");
-    
-    return elapsed;
-}
-
-// AVX2 vectorized benchmark (processes 4 doubles at once)
-double vectorized_benchmark(long long operations) {
-    // Align data for SIMD
-    __attribute__((aligned(32))) double a_vals[4] = {1.1, 1.2, 1.3, 1.4};
-    __attribute__((aligned(32))) double b_vals[4] = {2.1, 2.2, 2.3, 2.4};
-    __attribute__((aligned(32))) double results[4] = {0.0, 0.0, 0.0, 0.0};
-    
-    __m256d a_vec = _mm256_load_pd(a_vals);
-    __m256d b_vec = _mm256_load_pd(b_vals);
-    __m256d result_vec = _mm256_load_pd(results);
-    __m256d mult_factor = _mm256_set1_pd(0.999999);
-    __m256d add_factor = _mm256_set1_pd(1.000001);
-    
-    double start_time = get_time();
-    
-    for (long long i = 0; i < operations / 4; i++) {
-        // 4 multiply-add operations in parallel
-        result_vec = _mm256_fmadd_pd(a_vec, b_vec, result_vec);
-        a_vec = _mm256_mul_pd(result_vec, mult_factor);
-        b_vec = _mm256_add_pd(a_vec, add_factor);
-    }
-    
-    double end_time = get_time();
-    double elapsed = end_time - start_time;
-    
-    // Store results to prevent optimization
-    _mm256_store_pd(results, result_vec);
-    if (results[0] == 0.0) printf("Unexpected result\n");
+    kernel_checksum = result;
+    kernel_chain_steps = steps;
     
     return elapsed;
 }
@@ -70,6 +118,7 @@ double vectorized_benchmark(long long operations) {
 // Multi-threaded benchmark
 double multithreaded_benchmark(long long operations, int num_threads) {
     volatile double global_result = 0.0;
+    double global_steps = 0.0;
     
     omp_set_num_threads(num_threads);
     
@@ -77,135 +126,1126 @@ double multithreaded_benchmark(long long operations, int num_threads) {
     
     #pragma omp parallel
     {
+        affinity_bind_thread(omp_get_thread_num());
         double local_a = 1.23456789 + omp_get_thread_num() * 0.1;
         double local_b = 9.87654321 + omp_get_thread_num() * 0.1;
-        double local_result = 0.0;
+        double local_result = chain_start(local_a, local_b);
+        double local_steps = 0.0;
         
-        long long ops_per_thread = operations / num_threads;
+        long long ops_per_thread = thread_share(operations, omp_get_thread_num(), num_threads);
         
         for (long long i = 0; i < ops_per_thread; i++) {
             local_result = local_a * local_b + local_result;
-            local_a = local_result * 0.999999;
-            local_b = local_a + 1.000001;
+            local_a = local_result * CHAIN_MULTIPLIER;
+            local_b = local_a + CHAIN_ADDEND;
+            local_steps += 1.0;
         }
         
         #pragma omp atomic
         global_result += local_result;
+        #pragma omp atomic
+        global_steps += local_steps;
     }
     
     double end_time = get_time();
     double elapsed = end_time - start_time;
     
-    // Prevent optimization
-    if (global_result == 0.0) printf("Unexpected result\n");
+    kernel_checksum = global_result;
+    kernel_chain_steps = global_steps;
     
     return elapsed;
 }
 
-// Multi-threaded vectorized benchmark (best of both worlds)
-double multithreaded_vectorized_benchmark(long long operations, int num_threads) {
-    volatile double global_result = 0.0;
+// Peak kernel for dynamic scheduling, set once the ISA is chosen
+static const simd_kernels_t *dynamic_kernels;
+
+// Multi-threaded peak throughput with the work in small chunks under
+// schedule(dynamic): faster cores take more chunks, so on hybrid CPUs the
+// slowest core no longer sets the finish time
+static void dynamic_chunks(long long operations, int num_threads, long long *chunk, long long *chunks,
+                           long long *remainder) {
+    *chunk = operations / ((long long)num_threads * DYNAMIC_CHUNKS_PER_THREAD);
+    *chunk = *chunk / PEAK_ACCUMULATORS * PEAK_ACCUMULATORS;
+    if (*chunk < PEAK_ACCUMULATORS) *chunk = PEAK_ACCUMULATORS;
+    *chunks = operations / *chunk;
+    *remainder = operations - *chunks * *chunk;
+}
+
+static double dynamic_peak_benchmark(long long operations, int num_threads) {
+    long long chunk, chunks, remainder;
+    double checksum = 0.0;
+    dynamic_chunks(operations, num_threads, &chunk, &chunks, &remainder);
     
     omp_set_num_threads(num_threads);
     
     double start_time = get_time();
     
-    #pragma omp parallel
+    #pragma omp parallel reduction(+:checksum)
     {
-        int thread_id = omp_get_thread_num();
-        
-        // Align data for SIMD
-        __attribute__((aligned(32))) double a_vals[4] = {
-            1.1 + thread_id * 0.1, 1.2 + thread_id * 0.1, 
-            1.3 + thread_id * 0.1, 1.4 + thread_id * 0.1
-        };
-        __attribute__((aligned(32))) double b_vals[4] = {
-            2.1 + thread_id * 0.1, 2.2 + thread_id * 0.1, 
-            2.3 + thread_id * 0.1, 2.4 + thread_id * 0.1
-        };
-        __attribute__((aligned(32))) double results[4] = {0.0, 0.0, 0.0, 0.0};
+        affinity_bind_thread(omp_get_thread_num());
         
-        __m256d a_vec = _mm256_load_pd(a_vals);
-        __m256d b_vec = _mm256_load_pd(b_vals);
-        __m256d result_vec = _mm256_load_pd(results);
-        __m256d mult_factor = _mm256_set1_pd(0.999999);
-        __m256d add_factor = _mm256_set1_pd(1.000001);
+        #pragma omp for schedule(dynamic, 1)
+        for (long long c = 0; c <= chunks; c++) {
+            long long n = c < chunks ? chunk : remainder;
+            if (n > 0) {
+                dynamic_kernels->peak(n);
+                checksum += kernel_checksum;
+            }
+        }
+    }
+    
+    double elapsed = get_time() - start_time;
+    kernel_checksum = checksum;
+    return elapsed;
+}
+
+// Every chunk restarts the peak chains, so the checksum sums per-chunk references
+static double dynamic_peak_reference(const simd_kernels_t *simd, long long operations, int num_threads) {
+    long long chunk, chunks, remainder;
+    dynamic_chunks(operations, num_threads, &chunk, &chunks, &remainder);
+    double reference = chunks * verify_peak_reference(chunk / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS, simd->lanes, 1);
+    if (remainder > 0) {
+        reference += verify_peak_reference(remainder / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS, simd->lanes, 1);
+    }
+    return reference;
+}
+
+static double run_kernel(long long operations, void *context) {
+    const kernel_call_t *call = context;
+    return call->single ? call->single(operations) : call->threaded(operations, call->num_threads);
+}
+
+// Warm up, then time repeated trials until the CV stopping rule is met.
+// Exactly one of `single` / `threaded` is set. An `operations` of 0 takes
+// the per-trial count from the options (--time calibration, --ops or the
+// default), as a multiple of `granularity`. Returns the median time.
+static double measure(const bench_options_t *opts, kernel_fn single, threaded_kernel_fn threaded,
+                      long long operations, long long granularity, int num_threads, measurement_t *m) {
+    kernel_call_t call = { single, threaded, num_threads };
+    warmup_t warmup;
+    trial_set_t trials;
+    
+    for (warmup_start(&warmup); warmup_running(&warmup); ) {
+        run_kernel(WARMUP_OPERATIONS, &call);
+    }
+    
+    if (operations == 0) {
+        operations = options_operations(opts, run_kernel, &call, granularity, DEFAULT_OPERATIONS);
+    }
+    m->operations = operations;
+    
+    perf_open(PERF_EVENTS_COMPUTE, threaded ? num_threads : 1);
+    perf_start();
+    energy_start();
+    unsigned long long cycles = read_cycles();
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, run_kernel(operations, &call));
+    }
+    cycles = read_cycles() - cycles;
+    energy_stop(&m->energy);
+    perf_stop(&m->perf);
+    perf_close();
+    
+    trials_summarize(&trials, &m->stats);
+    m->cycles = (double)cycles / trials.count;
+    m->checksum = kernel_checksum;
+    m->chain_steps = kernel_chain_steps;
+    m->expected = NAN;
+    m->verified = -2;
+    return m->stats.median;
+}
+
+// Check the last trial's checksum against `expected`; a mismatch is printed
+// at once, since some tests print no other per-test lines
+static void check_measurement(measurement_t *m, double expected) {
+    m->expected = expected;
+    m->verified = verify_checksum(m->checksum, expected);
+    if (m->verified == 0) verify_print("   ", m->checksum, expected, 0);
+}
+
+// check_measurement for the latency chains, which also checks the steps
+// they counted against the FLOPs charged for them
+static void check_chain(measurement_t *m, double flops, int lanes, int num_threads) {
+    check_measurement(m, verify_chain_reference(m->operations / lanes, lanes, num_threads));
+    if (!verify_chain_steps("   ", m->chain_steps, flops)) m->verified = 0;
+}
+
+static void print_measurement(const measurement_t *m, double flops) {
+    printf("   Operations: %lld per trial\n", m->operations);
+    printf("   Time: %.6f seconds (median of %d trials)\n", m->stats.median, m->stats.count);
+    print_trial_stats("   ", &m->stats);
+    printf("   Reference cycles: %.0f per trial (%.2f FLOPs/cycle)\n", m->cycles, flops / m->cycles);
+    printf("   Fastest trial: %.2f MFLOPS\n", (flops / m->stats.min) / 1000000.0);
+    perf_print("   ", &m->perf, flops * m->stats.count);
+    energy_print("   ", &m->energy, flops * m->stats.count);
+    if (m->verified == 1 || m->verified == -1) verify_print("   ", m->checksum, m->expected, m->verified);
+}
+
+// report_add plus the energy of the measurement's trials
+static void add_record(const char *kernel, const char *isa, int threads, const measurement_t *m, double flops) {
+    report_add(kernel, isa, threads, m->operations, flops, &m->stats);
+    if (m->energy.valid) {
+        report_set_energy(m->energy.total / m->stats.count, m->energy.total / m->energy.seconds);
+    }
+    if (m->verified >= 0) report_set_checksum(m->checksum, m->expected, m->verified);
+}
+
+// Run the multithreaded peak kernel at 1..max_threads threads. Strong scaling
+// keeps the total work fixed; weak scaling keeps the work per thread fixed.
+// Speedup is throughput relative to one thread, efficiency is speedup / threads.
+static void scaling_sweep(const bench_options_t *opts, const simd_kernels_t *simd, int max_threads, int weak) {
+    measurement_t m;
+    long long operations = 0;  // chosen by the one-thread run, then fixed
+    double base_gflops = 0.0;
+    double best_gflops = 0.0;
+    int best_threads = 1;
+    int knee_threads = 0;
+    
+    printf("%s Scaling (%s FMA, %d accumulators, %s work):\n", weak ? "Weak" : "Strong", simd->name,
+           PEAK_ACCUMULATORS, weak ? "fixed per-thread" : "fixed total");
+    int energy = energy_domains() > 0;
+    printf("   %7s %12s %10s %12s %8s %10s %7s", "Threads", "Time (s)", "GFLOPS", "GFLOPS/thr", "Speedup",
+           "Efficiency", "CV");
+    if (energy) printf(" %8s %9s", "Watts", "GFLOPS/W");
+    printf("\n");
+    
+    for (int threads = 1; threads <= max_threads; threads++) {
+        long long total = weak ? operations * threads : operations;
+        double time = measure(opts, NULL, simd->multithreaded_peak, total, PEAK_ACCUMULATORS, threads, &m);
+        if (threads == 1) operations = total = m.operations;
+        check_measurement(&m, verify_peak_reference(total / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS, simd->lanes, threads));
+        double gflops = (kernel_flops(simd->peak_flops, total) / time) / 1e9;
+        if (threads == 1) base_gflops = gflops;
+        double speedup = gflops / base_gflops;
+        double efficiency = speedup / threads;
         
-        long long ops_per_thread = (operations / num_threads) / 4; // Divide by 4 for vectorization
+        if (gflops > best_gflops) {
+            best_gflops = gflops;
+            best_threads = threads;
+        }
+        if (!knee_threads && efficiency < SCALING_EFFICIENCY_THRESHOLD) knee_threads = threads;
         
-        for (long long i = 0; i < ops_per_thread; i++) {
-            result_vec = _mm256_fmadd_pd(a_vec, b_vec, result_vec);
-            a_vec = _mm256_mul_pd(result_vec, mult_factor);
-            b_vec = _mm256_add_pd(a_vec, add_factor);
+        printf("   %7d %12.6f %10.2f %12.2f %7.2fx %9.1f%% %6.2f%%", threads, time, gflops,
+               gflops / threads, speedup, 100.0 * efficiency, m.stats.cv * 100.0);
+        if (energy && m.energy.valid) {
+            printf(" %8.2f %9.3f", m.energy.total / m.energy.seconds,
+                   energy_gflops_per_watt(&m.energy, gflops * 1e9 * m.energy.seconds));
+        } else if (energy) {
+            printf(" %8s %9s", "-", "-");
         }
+        printf("\n");
+        add_record(weak ? "peak_weak" : "peak_strong", simd->name, threads, &m, kernel_flops(simd->peak_flops, total));
+    }
+    
+    printf("   Best throughput: %.2f GFLOPS at %d threads\n", best_gflops, best_threads);
+    if (knee_threads) {
+        printf("   Efficiency drops below %.0f%% at %d threads\n", 100.0 * SCALING_EFFICIENCY_THRESHOLD, knee_threads);
+    } else {
+        printf("   Efficiency stays above %.0f%% up to %d threads\n", 100.0 * SCALING_EFFICIENCY_THRESHOLD, max_threads);
+    }
+    printf("\n");
+}
+
+// Workers publish completed chunks here; one cache line each, so the
+// sampler's reads never contend with another worker's writes
+typedef struct {
+    long long chunks;
+    char pad[64 - sizeof(long long)];
+} soak_counter_t;
+
+typedef struct {
+    double seconds;     // since the start of the soak
+    double gflops;      // over the interval ending here
+    double mhz;         // 0: unknown
+    double celsius;
+    int has_celsius;
+    double watts;       // 0: no RAPL reading
+} soak_sample_t;
+
+static void sleep_until(double deadline) {
+    double remaining = deadline - get_time();
+    if (remaining <= 0.0) return;
+    struct timespec ts = { (time_t)remaining, (long)((remaining - (time_t)remaining) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+static void print_soak_value(double value, int known, const char *format) {
+    if (known) printf(format, value);
+    else printf(" %8s", "-");
+}
+
+// Run one kernel on every thread for `seconds`, sampling the summed chunk
+// counters, clock and temperature every `interval_ms` while the workers keep
+// running, then report where throughput fell below the burst peak
+static int soak_run(const bench_options_t *opts, const simd_kernels_t *simd, int num_threads, double seconds,
+                    int interval_ms) {
+    struct {
+        const char *name;
+        const char *mt_name;
+        kernel_fn run;
+        kernel_flops_t flops;
+    } kernels[] = {
+        { "peak", "peak_mt", simd->peak, simd->peak_flops },
+        { "vectorized", "vectorized_mt", simd->vectorized, simd->chain_flops },
+        { "scalar", "scalar_mt", scalar_benchmark, SCALAR_CHAIN_FLOPS },
+    };
+    int k = 0;
+    while (k < 2 && !options_kernel_selected(opts, kernels[k].name) &&
+           !options_kernel_selected(opts, kernels[k].mt_name)) k++;
+    
+    // Chunks short against the interval, so one in flight per worker barely
+    // skews a sample
+    double interval = interval_ms / 1000.0;
+    double chunk_seconds = interval / 100 < SOAK_CHUNK_SECONDS ? interval / 100 : SOAK_CHUNK_SECONDS;
+    long long granularity = kernels[k].flops.operations_per_iteration;
+    long long chunk = granularity * 1000;
+    double elapsed = kernels[k].run(chunk);
+    while (elapsed < chunk_seconds / 4 && chunk < (1LL << 40)) {
+        chunk *= 4;
+        elapsed = kernels[k].run(chunk);
+    }
+    chunk = (long long)(chunk * (chunk_seconds / elapsed)) / granularity * granularity;
+    if (chunk < granularity) chunk = granularity;
+    double chunk_flops = kernel_flops(kernels[k].flops, chunk);
+    
+    // Clock readings cover the CPUs the workers are bound to
+    const affinity_plan_t *placement = affinity_plan();
+    int *cpus = NULL;
+    if (placement->policy != AFFINITY_NONE && placement->count > 0) {
+        cpus = malloc(num_threads * sizeof(int));
+        for (int t = 0; cpus && t < num_threads; t++) cpus[t] = placement->slots[t % placement->count].cpu;
+    }
+    
+    int max_samples = (int)(seconds / interval) + 2;
+    soak_sample_t *samples = calloc(max_samples, sizeof(*samples));
+    soak_counter_t *counters = aligned_alloc(64, num_threads * sizeof(*counters));
+    if (!samples || !counters) {
+        printf("Soak: allocation failed\n");
+        free(cpus);
+        free(samples);
+        free(counters);
+        return 1;
+    }
+    memset(counters, 0, num_threads * sizeof(*counters));
+    
+    printf("Soak (%s, %s, %d threads, %.0f s, sampled every %d ms, %lld operations per chunk):\n",
+           kernels[k].mt_name, simd->name, num_threads, seconds, interval_ms, chunk);
+    int energy = energy_domains() > 0;
+    printf("   %8s %10s %8s %8s %8s", "Time (s)", "GFLOPS", "vs peak", "MHz", "Temp (C)");
+    if (energy) printf(" %8s %9s", "Watts", "GFLOPS/W");
+    printf("\n");
+    fflush(stdout);
+    
+    int num_samples = 0;
+    int workers = num_threads;
+    volatile int stop = 0;
+    
+    // One extra thread samples; it stays unbound and mostly sleeps
+    omp_set_num_threads(num_threads + 1);
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int team = omp_get_num_threads();
         
-        _mm256_store_pd(results, result_vec);
-        double thread_result = results[0] + results[1] + results[2] + results[3];
+        if (tid < team - 1) {
+            affinity_bind_thread(tid);
+            while (!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+                kernels[k].run(chunk);
+                __atomic_store_n(&counters[tid].chunks, counters[tid].chunks + 1, __ATOMIC_RELAXED);
+            }
+        } else {
+            workers = team - 1;
+            double start = get_time();
+            double last_time = start;
+            double burst = 0.0;
+            long long last_chunks = 0;
+            
+            energy_start();
+            while (workers > 0 && num_samples < max_samples) {
+                sleep_until(start + (num_samples + 1) * interval);
+                double now = get_time();
+                long long chunks = 0;
+                for (int t = 0; t < workers; t++) chunks += __atomic_load_n(&counters[t].chunks, __ATOMIC_RELAXED);
+                
+                soak_sample_t *s = &samples[num_samples++];
+                s->seconds = now - start;
+                s->gflops = (chunks - last_chunks) * chunk_flops / (now - last_time) / 1e9;
+                if (sensors_cpu_mhz(cpus, cpus ? workers : 0, &s->mhz) != 0) s->mhz = 0.0;
+                s->has_celsius = sensors_temperature(&s->celsius) == 0;
+                if (energy) {
+                    energy_sample_t e;
+                    energy_stop(&e);
+                    energy_start();
+                    s->watts = e.valid ? e.total / e.seconds : 0.0;
+                }
+                if (s->gflops > burst) burst = s->gflops;
+                last_chunks = chunks;
+                last_time = now;
+                
+                printf("   %8.2f %10.2f %7.1f%%", s->seconds, s->gflops, burst > 0.0 ? 100.0 * s->gflops / burst : 0.0);
+                print_soak_value(s->mhz, s->mhz > 0.0, " %8.0f");
+                print_soak_value(s->celsius, s->has_celsius, " %8.1f");
+                if (energy) {
+                    print_soak_value(s->watts, s->watts > 0.0, " %8.2f");
+                    print_soak_value(s->gflops / s->watts, s->watts > 0.0, " %9.3f");
+                }
+                printf("\n");
+                fflush(stdout);
+                
+                if (s->seconds >= seconds - 1e-6) break;
+            }
+            __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+        }
+    }
+    
+    if (workers < 1 || num_samples == 0) {
+        printf("   No samples (OpenMP ran %d worker threads)\n\n", workers);
+        free(cpus);
+        free(samples);
+        free(counters);
+        return 1;
+    }
+    
+    // Burst peak and when throughput first fell clearly below it
+    int peak_index = 0;
+    for (int i = 1; i < num_samples; i++) {
+        if (samples[i].gflops > samples[peak_index].gflops) peak_index = i;
+    }
+    double burst = samples[peak_index].gflops;
+    int throttle_index = -1;
+    for (int i = peak_index + 1; i < num_samples && throttle_index < 0; i++) {
+        if (samples[i].gflops < SOAK_THROTTLE_THRESHOLD * burst) throttle_index = i;
+    }
+    
+    // Sustained rate: the final quarter of the run (at most MAX_TRIALS samples)
+    int window = num_samples / 4 > 0 ? num_samples / 4 : 1;
+    if (window > MAX_TRIALS) window = MAX_TRIALS;
+    double window_gflops[MAX_TRIALS];
+    double window_seconds[MAX_TRIALS];
+    double window_watts = 0.0;
+    int watts_samples = 0;
+    for (int i = 0; i < window; i++) {
+        const soak_sample_t *s = &samples[num_samples - window + i];
+        window_gflops[i] = s->gflops;
+        if (s->watts > 0.0) {
+            window_watts += s->watts;
+            watts_samples++;
+        }
+    }
+    if (watts_samples > 0) window_watts /= watts_samples;
+    trial_stats_t sustained;
+    compute_stats(window_gflops, window, &sustained);
+    
+    // Record the sustained window as trials of one interval's average work
+    double interval_flops = sustained.mean * 1e9 * interval;
+    for (int i = 0; i < window; i++) {
+        window_seconds[i] = window_gflops[i] > 0.0 ? interval_flops / (window_gflops[i] * 1e9) : interval;
+    }
+    trial_stats_t window_stats;
+    compute_stats(window_seconds, window, &window_stats);
+    char record[48];
+    snprintf(record, sizeof(record), "soak_%s", kernels[k].mt_name);
+    report_add(record, simd->name, workers, interval_flops / chunk_flops * chunk, interval_flops, &window_stats);
+    if (window_watts > 0.0) report_set_energy(window_watts * interval, window_watts);
+    
+    double min_mhz = 0.0, max_celsius = 0.0;
+    int has_celsius = 0;
+    for (int i = 0; i < num_samples; i++) {
+        if (samples[i].mhz > 0.0 && (min_mhz == 0.0 || samples[i].mhz < min_mhz)) min_mhz = samples[i].mhz;
+        if (samples[i].has_celsius && (!has_celsius || samples[i].celsius > max_celsius)) max_celsius = samples[i].celsius;
+        has_celsius |= samples[i].has_celsius;
+    }
+    
+    printf("   Burst peak: %.2f GFLOPS at %.1f s\n", burst, samples[peak_index].seconds);
+    printf("   Sustained: %.2f GFLOPS (median of the last %d samples), %.1f%% below burst peak\n", sustained.median,
+           window, burst > 0.0 ? 100.0 * (1.0 - sustained.median / burst) : 0.0);
+    if (window_watts > 0.0) {
+        printf("   Sustained power: %.2f W, %.3f GFLOPS/W\n", window_watts, sustained.median / window_watts);
+    }
+    if (throttle_index >= 0) {
+        printf("   Throttling: below %.0f%% of burst peak from %.1f s (%.2f GFLOPS)\n", 100.0 * SOAK_THROTTLE_THRESHOLD,
+               samples[throttle_index].seconds, samples[throttle_index].gflops);
+    } else {
+        printf("   Throttling: none, stayed within %.0f%% of burst peak\n", 100.0 * (1.0 - SOAK_THROTTLE_THRESHOLD));
+    }
+    if (samples[0].mhz > 0.0) {
+        printf("   Clock: %.0f MHz at start, %.0f MHz at end, %.0f MHz lowest\n", samples[0].mhz,
+               samples[num_samples - 1].mhz, min_mhz);
+    }
+    if (has_celsius) {
+        printf("   Temperature: %.1f C at start, %.1f C at end, %.1f C hottest\n", samples[0].celsius,
+               samples[num_samples - 1].celsius, max_celsius);
+    }
+    printf("\n");
+    
+    free(cpus);
+    free(samples);
+    free(counters);
+    return 0;
+}
+
+// One daemon probe kernel; `opts` holds its operation count once calibrated
+typedef struct {
+    const char *name;
+    kernel_fn single;
+    threaded_kernel_fn threaded;
+    kernel_flops_t flops;
+    bench_options_t opts;
+} daemon_kernel_t;
+
+typedef struct {
+    const simd_kernels_t *simd;
+    int num_threads;
+    daemon_kernel_t kernels[4];
+    int num_kernels;
+    bench_options_t triad_opts;
+} daemon_probe_t;
+
+// Triad arrays, allocated and first touched once, so every probe streams
+// the same resident pages
+static struct {
+    const simd_kernels_t *simd;
+    double *a, *b, *c;
+    long long n;
+} daemon_triad;
+
+// Slice of the triad arrays owned by `thread_id`, in whole blocks
+static void triad_slice(int thread_id, int num_threads, long long *begin, long long *count) {
+    long long blocks = daemon_triad.n / DAEMON_TRIAD_BLOCK;
+    long long remainder = blocks % num_threads;
+    long long before = thread_id * (blocks / num_threads) + (thread_id < remainder ? thread_id : remainder);
+    *begin = before * DAEMON_TRIAD_BLOCK;
+    *count = thread_share(blocks, thread_id, num_threads) * DAEMON_TRIAD_BLOCK;
+}
+
+// `operations` passes of a = b + 3c over the triad arrays
+static double triad_benchmark(long long operations, int num_threads) {
+    omp_set_num_threads(num_threads);
+    
+    double start_time = get_time();
+    
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, count;
+        triad_slice(omp_get_thread_num(), omp_get_num_threads(), &begin, &count);
+        for (long long pass = 0; pass < operations && count > 0; pass++) {
+            daemon_triad.simd->stream_triad(daemon_triad.a + begin, daemon_triad.b + begin, daemon_triad.c + begin,
+                                            3.0, count);
+        }
+    }
+    
+    return get_time() - start_time;
+}
+
+static int triad_alloc(const simd_kernels_t *simd, int num_threads) {
+    cache_info_t caches;
+    detect_cache_sizes(&caches);
+    
+    double phys_bytes = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    double bytes = 4.0 * caches.l3;
+    if (bytes < DAEMON_TRIAD_MIN_BYTES) bytes = DAEMON_TRIAD_MIN_BYTES;
+    if (phys_bytes > 0 && bytes > phys_bytes / 4) bytes = phys_bytes / 4;
+    daemon_triad.simd = simd;
+    daemon_triad.n = (long long)(bytes / (3 * sizeof(double))) / DAEMON_TRIAD_BLOCK * DAEMON_TRIAD_BLOCK;
+    
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t size = daemon_triad.n * sizeof(double);
+    void *a = NULL, *b = NULL, *c = NULL;
+    if (posix_memalign(&a, page_size, size) != 0 || posix_memalign(&b, page_size, size) != 0 ||
+        posix_memalign(&c, page_size, size) != 0) {
+        free(a);
+        free(b);
+        return -1;
+    }
+    daemon_triad.a = a;
+    daemon_triad.b = b;
+    daemon_triad.c = c;
+    
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel
+    {
+        affinity_bind_thread(omp_get_thread_num());
+        long long begin, count;
+        triad_slice(omp_get_thread_num(), omp_get_num_threads(), &begin, &count);
+        for (long long i = begin; i < begin + count; i++) {
+            daemon_triad.a[i] = 1.0;
+            daemon_triad.b[i] = 2.0;
+            daemon_triad.c[i] = 0.5;
+        }
+    }
+    return 0;
+}
+
+// The triad takes whole passes of a DRAM-sized working set, far coarser than
+// the operation counts options_operations starts from: warm up with single
+// passes and size the trials from the last one
+static void triad_measure(bench_options_t *opts, int num_threads, measurement_t *m) {
+    warmup_t warmup;
+    trial_set_t trials;
+    double pass_time = 0.0;
+    
+    for (warmup_start(&warmup); warmup_running(&warmup) || pass_time == 0.0; ) {
+        pass_time = triad_benchmark(1, num_threads);
+    }
+    if (opts->operations == 0) {
+        long long passes = (long long)(opts->target_seconds / pass_time + 0.5);
+        opts->operations = passes > 0 ? passes : 1;
+    }
+    m->operations = opts->operations;
+    
+    energy_start();
+    for (trials_begin(&trials); trials_continue(&trials); ) {
+        trials_add(&trials, triad_benchmark(m->operations, num_threads));
+    }
+    energy_stop(&m->energy);
+    trials_summarize(&trials, &m->stats);
+}
+
+static int daemon_probe(void *context) {
+    daemon_probe_t *probe = context;
+    const char *isa = probe->simd->name;
+    measurement_t m;
+    
+    for (int i = 0; i < probe->num_kernels; i++) {
+        daemon_kernel_t *k = &probe->kernels[i];
+        int threads = k->threaded ? probe->num_threads : 1;
+        double time = measure(&k->opts, k->single, k->threaded, 0, k->flops.operations_per_iteration, threads, &m);
+        k->opts.operations = m.operations;
+        k->opts.target_seconds = 0.0;
         
-        #pragma omp atomic
-        global_result += thread_result;
+        double flops = kernel_flops(k->flops, m.operations);
+        daemon_publish(k->name, isa, threads, "gflops", flops / time / 1e9, &m.stats);
+        if (m.energy.valid) {
+            daemon_publish_gauge(k->name, isa, threads, "gflops_per_watt",
+                                 energy_gflops_per_watt(&m.energy, flops * m.stats.count));
+        }
     }
     
-    double end_time = get_time();
-    double elapsed = end_time - start_time;
+    if (daemon_triad.n > 0) {
+        triad_measure(&probe->triad_opts, probe->num_threads, &m);
+        double bytes = 3.0 * sizeof(double) * daemon_triad.n * m.operations;
+        daemon_publish("triad", isa, probe->num_threads, "gbps", bytes / m.stats.median / 1e9, &m.stats);
+    }
+    return 0;
+}
+
+// Resident mode: the selected throughput kernels and the DRAM triad, probed
+// until SIGINT / SIGTERM
+static int daemon_mode(const bench_options_t *opts, const simd_kernels_t *simd, int num_threads) {
+    static daemon_probe_t probe;
+    const struct {
+        const char *name;
+        kernel_fn single;
+        threaded_kernel_fn threaded;
+        kernel_flops_t flops;
+    } candidates[] = {
+        { "vectorized", simd->vectorized, NULL, simd->chain_flops },
+        { "vectorized_mt", NULL, simd->multithreaded_vectorized, simd->chain_flops },
+        { "peak", simd->peak, NULL, simd->peak_flops },
+        { "peak_mt", NULL, simd->multithreaded_peak, simd->peak_flops },
+    };
     
-    // Prevent optimization
-    if (global_result == 0.0) printf("Unexpected result\n");
+    probe.simd = simd;
+    probe.num_threads = num_threads;
+    probe.num_kernels = 0;
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (!options_kernel_selected(opts, candidates[i].name)) continue;
+        daemon_kernel_t *k = &probe.kernels[probe.num_kernels++];
+        k->name = candidates[i].name;
+        k->single = candidates[i].single;
+        k->threaded = candidates[i].threaded;
+        k->flops = candidates[i].flops;
+        k->opts = *opts;
+        if (k->opts.target_seconds <= 0.0 && k->opts.operations == 0) k->opts.target_seconds = DAEMON_PROBE_SECONDS;
+    }
     
-    return elapsed;
+    // --ops counts FLOP operations; the triad sizes its passes on the first probe
+    probe.triad_opts = *opts;
+    probe.triad_opts.operations = 0;
+    if (probe.triad_opts.target_seconds <= 0.0) probe.triad_opts.target_seconds = DAEMON_PROBE_SECONDS;
+    if (triad_alloc(simd, num_threads) != 0) {
+        printf("Daemon: triad allocation failed, bandwidth probe skipped\n");
+        daemon_triad.n = 0;
+    }
+    
+    int status = daemon_run("vectorized", daemon_probe, &probe);
+    free(daemon_triad.a);
+    free(daemon_triad.b);
+    free(daemon_triad.c);
+    return status != 0;
+}
+
+// Op-mix mode (--opmix / SISU_OPMIX): every generated kernel of the chosen
+// ISA on one thread, as a table of GFLOPS per op and type (rows) against the
+// number of independent chains (columns). `filter` is "all" or a list of
+// types and ops, e.g. "f32" or "div,sqrt"; types and ops intersect.
+static int opmix_run(const bench_options_t *opts, const simd_kernels_t *simd, const char *filter) {
+    int all = strcmp(filter, "all") == 0;
+    int types = 0, ops = 0, unknown = 0;
+    
+    // Which of the two axes the filter names, and that it names nothing else
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", filter);
+    for (char *save, *entry = strtok_r(copy, ",", &save); entry && !all; entry = strtok_r(NULL, ",", &save)) {
+        int known = 0;
+        for (int k = 0; k < OPMIX_COUNT; k++) {
+            if (strcmp(entry, simd->opmix[k].type) == 0) known = types = 1;
+            if (strcmp(entry, simd->opmix[k].op) == 0) known = ops = 1;
+        }
+        if (!known) unknown = 1;
+    }
+    if (unknown || (!all && !types && !ops)) {
+        printf("Unknown SISU_OPMIX '%s' (all, or a list of f64, f32, fma, add, mul, div, sqrt, exp)\n", filter);
+        return 1;
+    }
+    
+    // Calibrated per kernel: the ops differ by two orders of magnitude
+    bench_options_t kernel_opts = *opts;
+    if (kernel_opts.target_seconds <= 0.0 && kernel_opts.operations == 0) {
+        kernel_opts.target_seconds = OPMIX_DEFAULT_SECONDS;
+    }
+    
+    printf("Op-mix Matrix (%s, 1 thread, GFLOPS by independent chains):\n", simd->name);
+    printf("   %-5s %-5s %-20s", "Op", "Type", "Step");
+    for (int c = 0; c < OPMIX_CHAIN_COUNT; c++) {
+        printf(" %6d chain%s", simd->opmix[c].chains, simd->opmix[c].chains == 1 ? " " : "s");
+    }
+    printf(" %9s\n", "FLOPs/cyc");
+    
+    measurement_t m;
+    for (int k = 0; k < OPMIX_COUNT; k += OPMIX_CHAIN_COUNT) {
+        const opmix_kernel_t *row = &simd->opmix[k];
+        if (!all && ((types && !options_list_contains(filter, row->type)) || (ops && !options_list_contains(filter, row->op)))) {
+            continue;
+        }
+        printf("   %-5s %-5s %-20s", row->op, row->type, row->step);
+        fflush(stdout);
+        double flops_per_cycle = 0.0;
+        measurement_t cells[OPMIX_CHAIN_COUNT];
+        for (int c = 0; c < OPMIX_CHAIN_COUNT; c++) {
+            const opmix_kernel_t *kernel = &row[c];
+            double time = measure(&kernel_opts, kernel->run, NULL, 0, kernel->granularity, 1, &m);
+            double flops = m.operations * kernel->flops_per_operation;
+            m.expected = verify_opmix_reference(kernel->type, kernel->op, kernel->fused,
+                                                m.operations / kernel->granularity, kernel->chains, kernel->lanes);
+            m.verified = verify_checksum(m.checksum, m.expected);
+            cells[c] = m;
+            printf(" %12.2f", (flops / time) / 1e9);
+            fflush(stdout);
+            if (flops / m.cycles > flops_per_cycle) flops_per_cycle = flops / m.cycles;
+            
+            char name[48];
+            snprintf(name, sizeof(name), "opmix_%s_%s_x%d", kernel->op, kernel->type, kernel->chains);
+            add_record(name, simd->name, 1, &m, flops);
+        }
+        printf(" %9.2f\n", flops_per_cycle);
+        for (int c = 0; c < OPMIX_CHAIN_COUNT; c++) {
+            if (cells[c].verified == 0) verify_print("      ", cells[c].checksum, cells[c].expected, 0);
+        }
+    }
+    printf("   FLOPs/cyc: best column, in reference cycles; exp counts one operation per libm call\n");
+    printf("   Checksums: every kernel's final lanes are checked against a scalar replay of its chains\n\n");
+    return verify_failures() > 0;
+}
+
+// Instruction-table mode (--instr / SISU_INSTR): latency and reciprocal
+// throughput, in core cycles, of every instruction of INSTR_OPS per element
+// type at the width of each supported ISA, as a uops.info-style table.
+// `filter` is "all" or a list of types, ops and ISA names; the named axes
+// intersect. Core cycles come from the PMU cycle counter when available and
+// otherwise from the cycle timer scaled by core_clock_hz(), measured next to
+// every kernel so frequency changes between rows do not skew them.
+static int instr_run(const bench_options_t *opts, const cpu_features_t *features, const char *filter) {
+    const simd_kernels_t *isas[MAX_SIMD_KERNELS];
+    int num_isas = supported_simd_kernels(features, isas, MAX_SIMD_KERNELS);
+    int all = strcmp(filter, "all") == 0;
+    int types = 0, ops = 0, widths = 0, unknown = 0;
+    
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", filter);
+    for (char *save, *entry = strtok_r(copy, ",", &save); entry && !all; entry = strtok_r(NULL, ",", &save)) {
+        int known = 0;
+        for (int k = 0; k < INSTR_COUNT; k++) {
+            if (strcmp(entry, isas[0]->instr[k].type) == 0) known = types = 1;
+            if (strcmp(entry, isas[0]->instr[k].op) == 0) known = ops = 1;
+        }
+        for (int i = 0; i < num_isas; i++) {
+            if (strcmp(entry, isas[i]->name) == 0) known = widths = 1;
+        }
+        if (!known) unknown = 1;
+    }
+    if (unknown || (!all && !types && !ops && !widths)) {
+        printf("Unknown SISU_INSTR '%s' (all, or a list of f64, f32, fma, mul, add, div, sqrt", filter);
+        for (int i = 0; i < num_isas; i++) printf(", %s", isas[i]->name);
+        printf(")\n");
+        return 1;
+    }
+    
+    bench_options_t kernel_opts = *opts;
+    if (kernel_opts.target_seconds <= 0.0 && kernel_opts.operations == 0) {
+        kernel_opts.target_seconds = INSTR_DEFAULT_SECONDS;
+    }
+    
+    printf("Instruction Table (1 thread, core cycles; latency: 1 chain, throughput: %d independent chains):\n",
+           INSTR_THROUGHPUT_CHAINS);
+    printf("   %-14s %-5s %-6s %5s %-12s %8s %8s %8s %8s  %s\n", "Instruction", "Type", "ISA", "Width", "Step",
+           "Latency", "Recip TP", "Per cyc", "Chains", "Clock");
+    
+    measurement_t m;
+    for (int i = 0; i < num_isas; i++) {
+        const simd_kernels_t *isa = isas[i];
+        if (!all && widths && !options_list_contains(filter, isa->name)) continue;
+        for (int k = 0; k < INSTR_COUNT; k++) {
+            const instr_kernel_t *kernel = &isa->instr[k];
+            if (!kernel->fused) continue;
+            if (!all && ((types && !options_list_contains(filter, kernel->type)) ||
+                         (ops && !options_list_contains(filter, kernel->op)))) {
+                continue;
+            }
+            printf("   %-14s %-5s %-6s %5d %-12s", kernel->mnemonic, kernel->type, isa->name, kernel->bits,
+                   kernel->step);
+            fflush(stdout);
+            
+            // Cycles per instruction for each kernel; `source` names the clock
+            int elements = kernel->bits / (strcmp(kernel->type, "f32") == 0 ? 32 : 64);
+            double flops_per_instruction = elements * (strcmp(kernel->op, "fma") == 0 ? 2.0 : 1.0);
+            double cycles[2];
+            measurement_t cells[2];
+            const char *source = "PMU";
+            for (int v = 0; v < 2; v++) {
+                kernel_fn run = v == 0 ? kernel->latency : kernel->throughput;
+                long long chains = v == 0 ? 1 : INSTR_THROUGHPUT_CHAINS;
+                measure(&kernel_opts, run, NULL, 0, chains, 1, &m);
+                double core_cycles = m.perf.valid && m.perf.cycles > 0.0 ? m.perf.cycles / m.stats.count : 0.0;
+                if (core_cycles <= 0.0) {
+                    double core_hz = core_clock_hz(INSTR_CLOCK_SECONDS);
+                    if (core_hz > 0.0) {
+                        core_cycles = m.cycles * core_hz / cycle_counter_hz();
+                        source = "int add";
+                    } else {
+                        core_cycles = m.cycles;
+                        source = cycle_counter_name();
+                    }
+                }
+                cycles[v] = core_cycles / m.operations;
+                m.expected = verify_instr_reference(kernel->type, kernel->op, m.operations / chains, (int)chains,
+                                                    elements);
+                m.verified = verify_checksum(m.checksum, m.expected);
+                cells[v] = m;
+                
+                char name[48];
+                snprintf(name, sizeof(name), "instr_%s_%s_%s", kernel->op, kernel->type,
+                         v == 0 ? "latency" : "throughput");
+                add_record(name, isa->name, 1, &m, m.operations * flops_per_instruction);
+            }
+            // Per cyc: instructions retired per cycle; Chains: latency x
+            // throughput, the independent chains needed to saturate the unit
+            printf(" %8.2f %8.2f %8.2f %8.1f  %s\n", cycles[0], cycles[1], 1.0 / cycles[1], cycles[0] / cycles[1],
+                   source);
+            for (int v = 0; v < 2; v++) {
+                if (cells[v].verified == 0) verify_print("      ", cells[v].checksum, cells[v].expected, 0);
+            }
+        }
+    }
+    printf("   Cycles are core clock cycles per instruction. div and sqrt timings depend on the operands on some\n");
+    printf("   cores; these run near 1.0. SSE2 has no fused multiply-add, so it has no fma rows.\n");
+    printf("   Records: instr_<op>_<type>_latency|throughput, one operation per instruction, with the\n");
+    printf("   checksum of the chains' final lanes against a scalar replay.\n\n");
+    return verify_failures() > 0;
 }
 
-int main() {
-    const long long operations = 400000000LL; // 400 million operations
+// One summary row, for the tests that ran
+static void print_summary_line(const char *label, double mflops, int show_gflops) {
+    if (mflops <= 0.0) return;
+    printf("%-28s %8.2f MFLOPS", label, mflops);
+    if (show_gflops) printf(" (%.2f GFLOPS)", mflops / 1000.0);
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
     int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
     
+    bench_options_t opts;
+    int status = options_parse(argc, argv, KERNEL_NAMES, FLAG_NAMES, &opts);
+    if (status) return status < 0;
+    report_begin("vectorized", opts.format);
+    
+    // After option parsing: --affinity / --smt feed the placement plan
+    int num_threads = opts.threads > 0 ? opts.threads : affinity_default_threads();
+    
+    // Pick the widest kernel set this CPU supports; SISU_ISA forces one
+    cpu_features_t features;
+    detect_cpu_features(&features);
+    const simd_kernels_t *simd = select_simd_kernels(&features, getenv("SISU_ISA"));
+    if (!simd) {
+        printf("No supported SIMD instruction set found\n");
+        return 1;
+    }
+    dynamic_kernels = simd;
+    
     printf("=== Advanced FLOPS Benchmark ===\n");
     printf("CPU: 13th Gen Intel Core i5-1335U\n");
     printf("Available cores: %d\n", num_cores);
-    printf("Operations per test: %lld\n\n", operations);
+    printf("SIMD kernels: %s (%d doubles per vector)\n", simd->name, simd->lanes);
+    if (opts.target_seconds > 0.0) {
+        printf("Target time per trial: %.3f seconds (operations calibrated per test)\n", opts.target_seconds);
+    } else {
+        printf("Operations per trial: %lld\n", opts.operations > 0 ? opts.operations : DEFAULT_OPERATIONS);
+    }
+    printf("Timer: monotonic clock (%.0f ns resolution), %s at %.3f GHz, warm-up %.0f ms\n",
+           get_time_resolution() * 1e9, cycle_counter_name(), cycle_counter_hz() / 1e9,
+           warmup_seconds() * 1000.0);
+    affinity_print_map(num_threads);
+    perf_print_status();
+    energy_print_status();
+    printf("\n");
+    
+    // Daemon mode replaces the standard tests: --daemon / SISU_DAEMON
+    if (daemon_requested()) return daemon_mode(&opts, simd, num_threads);
+    
+    // Soak mode replaces the standard tests: --soak / SISU_SOAK
+    const char *soak = getenv("SISU_SOAK");
+    if (soak && *soak) {
+        double soak_seconds = atof(soak);
+        const char *interval = getenv("SISU_SOAK_INTERVAL_MS");
+        int interval_ms = interval && *interval ? atoi(interval) : SOAK_DEFAULT_INTERVAL_MS;
+        if (soak_seconds <= 0.0) {
+            printf("Invalid SISU_SOAK '%s' (seconds)\n", soak);
+            return 1;
+        }
+        if (interval_ms < SOAK_MIN_INTERVAL_MS) interval_ms = SOAK_MIN_INTERVAL_MS;
+        sensors_print_status();
+        printf("\n");
+        status = soak_run(&opts, simd, num_threads, soak_seconds, interval_ms);
+        report_finish();
+        return status;
+    }
+    
+    // Instruction-table mode replaces the standard tests: --instr / SISU_INSTR
+    const char *instr = getenv("SISU_INSTR");
+    if (instr && *instr) {
+        status = instr_run(&opts, &features, instr);
+        report_finish();
+        return status;
+    }
+    
+    // Op-mix mode replaces the standard tests: --opmix / SISU_OPMIX
+    const char *opmix = getenv("SISU_OPMIX");
+    if (opmix && *opmix) {
+        status = opmix_run(&opts, simd, opmix);
+        report_finish();
+        return status;
+    }
+    
+    // Scaling mode replaces the standard tests: --scaling / SISU_SCALING
+    const char *scaling = getenv("SISU_SCALING");
+    if (scaling && *scaling) {
+        int strong = strcmp(scaling, "strong") == 0 || strcmp(scaling, "both") == 0;
+        int weak = strcmp(scaling, "weak") == 0 || strcmp(scaling, "both") == 0;
+        if (!strong && !weak) {
+            printf("Unknown SISU_SCALING '%s' (strong, weak, both)\n", scaling);
+            return 1;
+        }
+        if (strong) scaling_sweep(&opts, simd, num_threads, 0);
+        if (weak) scaling_sweep(&opts, simd, num_threads, 1);
+        report_finish();
+        return 0;
+    }
+    
+    // Tests not selected with --kernels keep 0 MFLOPS. Ratios compare
+    // throughput, since calibrated tests run different operation counts.
+    measurement_t m;
+    double scalar_mflops = 0.0, vec_mflops = 0.0, mt_mflops = 0.0, mtv_mflops = 0.0;
+    double peak_mflops = 0.0, mtp_mflops = 0.0;
     
     // 1. Single-threaded scalar benchmark
-    printf("1. Single-threaded Scalar Benchmark:\n");
-    double scalar_time = scalar_benchmark(operations);
-    double scalar_flops = operations * 4.0;
-    double scalar_mflops = (scalar_flops / scalar_time) / 1000000.0;
-    printf("   Time: %.6f seconds\n", scalar_time);
-    printf("   MFLOPS: %.2f\n\n", scalar_mflops);
+    if (options_kernel_selected(&opts, "scalar")) {
+        printf("1. Single-threaded Scalar Benchmark:\n");
+        double scalar_time = measure(&opts, scalar_benchmark, NULL, 0, 1, 1, &m);
+        double scalar_flops = kernel_flops(SCALAR_CHAIN_FLOPS, m.operations);
+        check_chain(&m, scalar_flops, 1, 1);
+        scalar_mflops = (scalar_flops / scalar_time) / 1000000.0;
+        print_measurement(&m, scalar_flops);
+        add_record("scalar", "scalar", 1, &m, scalar_flops);
+        printf("   MFLOPS: %.2f\n\n", scalar_mflops);
+    }
     
     // 2. Single-threaded vectorized benchmark
-    printf("2. Single-threaded Vectorized (AVX2) Benchmark:\n");
-    double vec_time = vectorized_benchmark(operations);
-    double vec_flops = operations * 4.0; // Same number of logical operations, but vectorized
-    double vec_mflops = (vec_flops / vec_time) / 1000000.0;
-    printf("   Time: %.6f seconds\n", vec_time);
-    printf("   MFLOPS: %.2f\n", vec_mflops);
-    printf("   Speedup vs scalar: %.2fx\n\n", scalar_time / vec_time);
+    if (options_kernel_selected(&opts, "vectorized")) {
+        printf("2. Single-threaded Vectorized (%s) Benchmark:\n", simd->name);
+        double vec_time = measure(&opts, simd->vectorized, NULL, 0, simd->lanes, 1, &m);
+        double vec_flops = kernel_flops(simd->chain_flops, m.operations);
+        check_chain(&m, vec_flops, simd->lanes, 1);
+        vec_mflops = (vec_flops / vec_time) / 1000000.0;
+        print_measurement(&m, vec_flops);
+        add_record("vectorized", simd->name, 1, &m, vec_flops);
+        printf("   MFLOPS: %.2f\n", vec_mflops);
+        if (scalar_mflops > 0.0) printf("   Speedup vs scalar: %.2fx\n", vec_mflops / scalar_mflops);
+        printf("\n");
+    }
     
     // 3. Multi-threaded scalar benchmark
-    printf("3. Multi-threaded Scalar Benchmark (%d threads):\n", num_cores);
-    double mt_time = multithreaded_benchmark(operations, num_cores);
-    double mt_flops = operations * 4.0;
-    double mt_mflops = (mt_flops / mt_time) / 1000000.0;
-    printf("   Time: %.6f seconds\n", mt_time);
-    printf("   MFLOPS: %.2f\n", mt_mflops);
-    printf("   Speedup vs scalar: %.2fx\n\n", scalar_time / mt_time);
+    if (options_kernel_selected(&opts, "scalar_mt")) {
+        printf("3. Multi-threaded Scalar Benchmark (%d threads):\n", num_threads);
+        double mt_time = measure(&opts, NULL, multithreaded_benchmark, 0, 1, num_threads, &m);
+        double mt_flops = kernel_flops(SCALAR_CHAIN_FLOPS, m.operations);
+        check_chain(&m, mt_flops, 1, num_threads);
+        mt_mflops = (mt_flops / mt_time) / 1000000.0;
+        print_measurement(&m, mt_flops);
+        add_record("scalar_mt", "scalar", num_threads, &m, mt_flops);
+        printf("   MFLOPS: %.2f\n", mt_mflops);
+        if (scalar_mflops > 0.0) printf("   Speedup vs scalar: %.2fx\n", mt_mflops / scalar_mflops);
+        printf("\n");
+    }
     
     // 4. Multi-threaded vectorized benchmark (maximum performance)
-    printf("4. Multi-threaded Vectorized Benchmark (%d threads + AVX2):\n", num_cores);
-    double mtv_time = multithreaded_vectorized_benchmark(operations, num_cores);
-    double mtv_flops = operations * 4.0;
-    double mtv_mflops = (mtv_flops / mtv_time) / 1000000.0;
-    printf("   Time: %.6f seconds\n", mtv_time);
-    printf("   MFLOPS: %.2f\n", mtv_mflops);
-    printf("   Speedup vs scalar: %.2fx\n\n", scalar_time / mtv_time);
+    if (options_kernel_selected(&opts, "vectorized_mt")) {
+        printf("4. Multi-threaded Vectorized Benchmark (%d threads + %s):\n", num_threads, simd->name);
+        double mtv_time = measure(&opts, NULL, simd->multithreaded_vectorized, 0, simd->lanes, num_threads, &m);
+        double mtv_flops = kernel_flops(simd->chain_flops, m.operations);
+        check_chain(&m, mtv_flops, simd->lanes, num_threads);
+        mtv_mflops = (mtv_flops / mtv_time) / 1000000.0;
+        print_measurement(&m, mtv_flops);
+        add_record("vectorized_mt", simd->name, num_threads, &m, mtv_flops);
+        printf("   MFLOPS: %.2f\n", mtv_mflops);
+        if (scalar_mflops > 0.0) printf("   Speedup vs scalar: %.2fx\n", mtv_mflops / scalar_mflops);
+        printf("\n");
+    }
+    
+    // 5. Single-threaded peak throughput (independent FMA chains)
+    if (options_kernel_selected(&opts, "peak")) {
+        printf("5. Single-threaded Peak Throughput (%s FMA, %d accumulators):\n", simd->name, PEAK_ACCUMULATORS);
+        double peak_time = measure(&opts, simd->peak, NULL, 0, PEAK_ACCUMULATORS, 1, &m);
+        double peak_flops = kernel_flops(simd->peak_flops, m.operations);
+        check_measurement(&m, verify_peak_reference(m.operations / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS, simd->lanes, 1));
+        peak_mflops = (peak_flops / peak_time) / 1000000.0;
+        print_measurement(&m, peak_flops);
+        add_record("peak", simd->name, 1, &m, peak_flops);
+        printf("   MFLOPS: %.2f\n", peak_mflops);
+        if (vec_mflops > 0.0) printf("   Throughput vs latency-bound: %.2fx\n", peak_mflops / vec_mflops);
+        printf("\n");
+    }
+    
+    // 6. Multi-threaded peak throughput
+    if (options_kernel_selected(&opts, "peak_mt")) {
+        printf("6. Multi-threaded Peak Throughput (%d threads, %d accumulators):\n", num_threads, PEAK_ACCUMULATORS);
+        double mtp_time = measure(&opts, NULL, simd->multithreaded_peak, 0, PEAK_ACCUMULATORS, num_threads, &m);
+        double mtp_flops = kernel_flops(simd->peak_flops, m.operations);
+        check_measurement(&m, verify_peak_reference(m.operations / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS, simd->lanes,
+                                                    num_threads));
+        mtp_mflops = (mtp_flops / mtp_time) / 1000000.0;
+        print_measurement(&m, mtp_flops);
+        add_record("peak_mt", simd->name, num_threads, &m, mtp_flops);
+        printf("   MFLOPS: %.2f\n", mtp_mflops);
+        if (mtv_mflops > 0.0) printf("   Throughput vs latency-bound: %.2fx\n", mtp_mflops / mtv_mflops);
+        printf("\n");
+    }
+    
+    // 7. Per-socket peak throughput, one socket at a time (multi-socket only)
+    const affinity_plan_t *placement = affinity_plan();
+    if (placement->sockets > 1 && placement->policy != AFFINITY_NONE && options_kernel_selected(&opts, "peak_socket")) {
+        printf("7. Per-socket Peak Throughput (%d accumulators):\n", PEAK_ACCUMULATORS);
+        for (int socket = 0, seen = 0; seen < placement->sockets && socket < AFFINITY_MAX_CPUS; socket++) {
+            int socket_threads = affinity_restrict_socket(socket);
+            if (socket_threads == 0) continue;
+            seen++;
+            
+            double socket_time = measure(&opts, NULL, simd->multithreaded_peak, 0, PEAK_ACCUMULATORS, socket_threads, &m);
+            double socket_flops = kernel_flops(simd->peak_flops, m.operations);
+            check_measurement(&m, verify_peak_reference(m.operations / PEAK_ACCUMULATORS, PEAK_ACCUMULATORS,
+                                                        simd->lanes, socket_threads));
+            printf("   Socket %d (%d threads): %.2f GFLOPS, cv %.2f%% over %d trials\n", socket, socket_threads,
+                   (socket_flops / socket_time) / 1e9, m.stats.cv * 100.0, m.stats.count);
+            
+            char kernel[48];
+            snprintf(kernel, sizeof(kernel), "peak_socket%d", socket);
+            add_record(kernel, simd->name, socket_threads, &m, socket_flops);
+        }
+        affinity_restrict_socket(-1);
+        printf("\n");
+    }
+    
+    // 8. Multi-threaded peak throughput, dynamically scheduled
+    double dyn_mflops = 0.0;
+    if (options_kernel_selected(&opts, "peak_dynamic")) {
+        printf("8. Multi-threaded Peak Throughput, dynamic scheduling (%d threads, %d chunks per thread):\n",
+               num_threads, DYNAMIC_CHUNKS_PER_THREAD);
+        double dyn_time = measure(&opts, NULL, dynamic_peak_benchmark, 0, PEAK_ACCUMULATORS, num_threads, &m);
+        double dyn_flops = kernel_flops(simd->peak_flops, m.operations);
+        check_measurement(&m, dynamic_peak_reference(simd, m.operations, num_threads));
+        dyn_mflops = (dyn_flops / dyn_time) / 1000000.0;
+        print_measurement(&m, dyn_flops);
+        add_record("peak_dynamic", simd->name, num_threads, &m, dyn_flops);
+        printf("   MFLOPS: %.2f\n", dyn_mflops);
+        if (mtp_mflops > 0.0) printf("   Dynamic vs static split: %.2fx\n", dyn_mflops / mtp_mflops);
+        printf("\n");
+    }
+    
+    // 9. Peak throughput per core type (hybrid CPUs only): P-cores, E-cores,
+    // then all of them with the static and the dynamic split
+    if (placement->hybrid && placement->policy != AFFINITY_NONE && options_kernel_selected(&opts, "peak_coretype")) {
+        static const struct {
+            affinity_core_type_t type;
+            const char *label;
+            const char *record;
+            int dynamic;
+        } runs[] = {
+            { AFFINITY_CORE_PERFORMANCE, "P-cores", "peak_pcore", 0 },
+            { AFFINITY_CORE_EFFICIENCY, "E-cores", "peak_ecore", 0 },
+            { AFFINITY_CORE_ANY, "Mixed, static", "peak_mixed", 0 },
+            { AFFINITY_CORE_ANY, "Mixed, dynamic", "peak_mixed_dynamic", 1 },
+        };
+        double gflops[4] = { 0.0 };
+        
+        printf("9. Peak Throughput per Core Type (%s, %d accumulators):\n", placement->core_type_source,
+               PEAK_ACCUMULATORS);
+        for (int r = 0; r < 4; r++) {
+            int type_threads = affinity_restrict_core_type(runs[r].type);
+            if (type_threads == 0) continue;
+            
+            threaded_kernel_fn kernel = runs[r].dynamic ? dynamic_peak_benchmark : simd->multithreaded_peak;
+            double type_time = measure(&opts, NULL, kernel, 0, PEAK_ACCUMULATORS, type_threads, &m);
+            double type_flops = kernel_flops(simd->peak_flops, m.operations);
+            check_measurement(&m, runs[r].dynamic ? dynamic_peak_reference(simd, m.operations, type_threads)
+                                                  : verify_peak_reference(m.operations / PEAK_ACCUMULATORS,
+                                                                          PEAK_ACCUMULATORS, simd->lanes, type_threads));
+            gflops[r] = (type_flops / type_time) / 1e9;
+            printf("   %-15s %3d threads: %9.2f GFLOPS (%.2f per thread), cv %.2f%% over %d trials\n",
+                   runs[r].label, type_threads, gflops[r], gflops[r] / type_threads, m.stats.cv * 100.0,
+                   m.stats.count);
+            add_record(runs[r].record, simd->name, type_threads, &m, type_flops);
+        }
+        affinity_restrict_core_type(AFFINITY_CORE_ANY);
+        
+        // Perfect balance would add the two core types' throughput
+        double balanced = gflops[0] + gflops[1];
+        if (balanced > 0.0) {
+            printf("   P + E balanced estimate: %.2f GFLOPS; static split reaches %.1f%%, dynamic %.1f%%\n",
+                   balanced, 100.0 * gflops[2] / balanced, 100.0 * gflops[3] / balanced);
+        }
+        printf("\n");
+    }
     
     // Summary
     printf("=== Performance Summary ===\n");
-    printf("Single-threaded scalar:      %8.2f MFLOPS\n", scalar_mflops);
-    printf("Single-threaded vectorized:  %8.2f MFLOPS\n", vec_mflops);
-    printf("Multi-threaded scalar:       %8.2f MFLOPS\n", mt_mflops);
-    printf("Multi-threaded vectorized:   %8.2f MFLOPS (%.2f GFLOPS)\n", 
-           mtv_mflops, mtv_mflops / 1000.0);
+    if (scalar_mflops > 0.0 || vec_mflops > 0.0 || mt_mflops > 0.0 || mtv_mflops > 0.0) {
+        printf("Latency-bound (one dependent chain per thread):\n");
+        print_summary_line("Single-threaded scalar:", scalar_mflops, 0);
+        print_summary_line("Single-threaded vectorized:", vec_mflops, 0);
+        print_summary_line("Multi-threaded scalar:", mt_mflops, 0);
+        print_summary_line("Multi-threaded vectorized:", mtv_mflops, 1);
+    }
+    if (peak_mflops > 0.0 || mtp_mflops > 0.0 || dyn_mflops > 0.0) {
+        printf("Peak throughput (%d independent FMA chains per thread):\n", PEAK_ACCUMULATORS);
+        print_summary_line("Single-threaded peak:", peak_mflops, 0);
+        print_summary_line("Multi-threaded peak:", mtp_mflops, 1);
+        print_summary_line("Multi-threaded dynamic:", dyn_mflops, 1);
+    }
+    if (verify_failures() > 0) {
+        printf("Checksums: %d test(s) MISMATCHED their reference; their results are not valid\n", verify_failures());
+    }
     
-    return 0;
+    report_finish();
+    return verify_failures() > 0;
 }
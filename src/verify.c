@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "verify.h"
+
+__thread double kernel_checksum;
+__thread double kernel_chain_steps;
+
+static int failures = 0;
+
+// Same split as thread_share() in simd_kernels.h
+static long long share(long long total, int thread_id, int num_threads) {
+    return total / num_threads + (thread_id < total % num_threads);
+}
+
+double verify_chain_reference(long long steps, int lanes, int num_threads) {
+    if (share(steps, num_threads - 1, num_threads) < CHAIN_SETTLE_STEPS) return NAN;
+    return (double)lanes * num_threads * CHAIN_FIXED_POINT;
+}
+
+double verify_peak_reference(long long iterations, int accumulators, int lanes, int num_threads) {
+    const double limit = PEAK_ADDEND / (1.0 - PEAK_MULTIPLIER);
+    double sum = 0.0;
+    
+    // x_n = limit + (x_0 - limit) * m^n
+    for (int t = 0; t < num_threads; t++) {
+        double decay = pow(PEAK_MULTIPLIER, (double)share(iterations, t, num_threads));
+        for (int j = 0; j < accumulators; j++) {
+            sum += lanes * (limit + (peak_start(j, t) - limit) * decay);
+        }
+    }
+    return sum;
+}
+
+typedef enum { STEP_FMA, STEP_MUL_ADD, STEP_ADD, STEP_MUL, STEP_DIV, STEP_SQRT, STEP_EXP } step_t;
+
+// One chain of an op-mix or instruction kernel in scalar `type`, `steps`
+// steps from `x`. Replays until the chain repeats (a fixed point or a
+// 2-cycle, so the parity of the remaining steps picks the value); fma
+// chains still moving after VERIFY_REPLAY_STEPS converge as
+// x_n = limit + (x_k - limit) * a^(n - k).
+#define REPLAY_DEFINE(type, fma_fn, sqrt_fn, exp_fn) \
+static double replay_##type(step_t step, double start, double a_value, double b_value, long long steps) { \
+    const type a = (type)a_value, b = (type)b_value; \
+    type x = (type)start, previous = x, before = x; \
+    volatile type product; \
+    long long i = 0; \
+    for (; i < steps && i < VERIFY_REPLAY_STEPS; i++) { \
+        switch (step) { \
+        case STEP_FMA: x = fma_fn(x, a, b); break; \
+        case STEP_MUL_ADD: product = x * a; x = product + b; break; \
+        case STEP_ADD: x = (x + a) + b; break; \
+        case STEP_MUL: x = (x * a) * b; break; \
+        case STEP_DIV: x = a / x; break; \
+        case STEP_SQRT: x = sqrt_fn(x * a); break; \
+        case STEP_EXP: x = exp_fn(-x); break; \
+        } \
+        if (i > 0 && x == before) { \
+            return (steps - i - 1) % 2 ? (double)previous : (double)x; \
+        } \
+        before = previous; \
+        previous = x; \
+    } \
+    if (i == steps) return x; \
+    if (step != STEP_FMA && step != STEP_MUL_ADD) return NAN; \
+    double limit = (double)b / (1.0 - (double)a); \
+    return limit + ((double)x - limit) * pow((double)a, (double)(steps - i)); \
+}
+
+REPLAY_DEFINE(double, fma, sqrt, exp)
+REPLAY_DEFINE(float, fmaf, sqrtf, expf)
+
+typedef struct {
+    const char *op;
+    step_t step;
+    double a, b;
+} step_constants_t;
+
+static const step_constants_t opmix_constants[] = {
+    { "fma", STEP_FMA, OPMIX_A_fma, OPMIX_B_fma },
+    { "add", STEP_ADD, OPMIX_A_add, OPMIX_B_add },
+    { "mul", STEP_MUL, OPMIX_A_mul, OPMIX_B_mul },
+    { "div", STEP_DIV, OPMIX_A_div, OPMIX_B_div },
+    { "sqrt", STEP_SQRT, OPMIX_A_sqrt, OPMIX_B_sqrt },
+    { "exp", STEP_EXP, OPMIX_A_exp, OPMIX_B_exp },
+};
+
+static const step_constants_t instr_constants[] = {
+    { "fma", STEP_FMA, INSTR_A_fma, INSTR_B_fma },
+    { "mul", STEP_MUL, INSTR_A_mul, INSTR_B_mul },
+    { "add", STEP_ADD, INSTR_A_add, INSTR_B_add },
+    { "div", STEP_DIV, INSTR_A_div, INSTR_B_div },
+    { "sqrt", STEP_SQRT, INSTR_A_sqrt, INSTR_B_sqrt },
+};
+
+// Sum over `chains` chains from start(j) of `lanes` identical lanes each;
+// an unfused fma is a rounded multiply, then an add
+static double replay_reference(const step_constants_t *constants, int count, double (*start)(int),
+                               const char *type, const char *op, int fused, long long steps, int chains,
+                               int lanes) {
+    int single = strcmp(type, "f32") == 0;
+    double sum = 0.0;
+    
+    for (int k = 0; k < count; k++) {
+        if (strcmp(constants[k].op, op) != 0) continue;
+        step_t step = constants[k].step == STEP_FMA && !fused ? STEP_MUL_ADD : constants[k].step;
+        for (int j = 0; j < chains; j++) {
+            double x = single ? replay_float(step, start(j), constants[k].a, constants[k].b, steps)
+                              : replay_double(step, start(j), constants[k].a, constants[k].b, steps);
+            sum += lanes * x;
+        }
+        return sum;
+    }
+    return NAN;
+}
+
+double verify_opmix_reference(const char *type, const char *op, int fused, long long steps, int chains,
+                              int lanes) {
+    return replay_reference(opmix_constants, (int)(sizeof(opmix_constants) / sizeof(opmix_constants[0])),
+                            opmix_start, type, op, fused, steps, chains, lanes);
+}
+
+double verify_instr_reference(const char *type, const char *op, long long steps, int chains, int lanes) {
+    return replay_reference(instr_constants, (int)(sizeof(instr_constants) / sizeof(instr_constants[0])),
+                            instr_start, type, op, 1, steps, chains, lanes);
+}
+
+int verify_checksum(double checksum, double expected) {
+    if (isnan(expected)) return -1;
+    if (fabs(checksum - expected) <= VERIFY_TOLERANCE * fabs(expected)) return 1;
+    failures++;
+    return 0;
+}
+
+void verify_print(const char *indent, double checksum, double expected, int verified) {
+    if (verified < 0) {
+        printf("%sChecksum: %.10g (too few steps to check)\n", indent, checksum);
+    } else if (verified) {
+        printf("%sChecksum: %.10g (verified)\n", indent, checksum);
+    } else {
+        printf("%sChecksum: %.10g MISMATCH, expected %.10g: result not trustworthy\n", indent, checksum, expected);
+    }
+}
+
+int verify_chain_steps(const char *indent, double steps, double flops) {
+    if (steps * CHAIN_FLOPS_PER_STEP == flops) return 1;
+    failures++;
+    printf("%sChain steps: %.0f MISMATCH, expected %.0f from the FLOP count: result not trustworthy\n", indent,
+           steps, flops / CHAIN_FLOPS_PER_STEP);
+    return 0;
+}
+
+int verify_failures(void) {
+    return failures;
+}
@@ -0,0 +1,149 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+// FLOP accounting and result checks shared by the FLOP kernels.
+//
+// Every kernel leaves the sum of its final accumulators (over all lanes and
+// threads) in `kernel_checksum` on the calling thread. The recurrences below
+// are chosen so that sum has a closed form, and a kernel that was optimized
+// away, ran too few iterations or computed something else no longer matches.
+
+// Relative tolerance of a checksum: FMA and separate multiply + add round
+// differently, and both recurrences damp the difference
+#define VERIFY_TOLERANCE 1e-7
+
+// Latency chain, one FMA + mul + add per step and chain:
+//     r = a * b + r;  a = r * CHAIN_MULTIPLIER;  b = a + CHAIN_ADDEND
+// Starting from r = chain_start(a, b), the first step lands at r = -0.5 and
+// the chain converges quadratically to CHAIN_FIXED_POINT, staying finite.
+#define CHAIN_MULTIPLIER 0.999999
+#define CHAIN_ADDEND 1.000001
+#define CHAIN_FLOPS_PER_STEP 4.0
+#define CHAIN_FIXED_POINT (-CHAIN_ADDEND / CHAIN_MULTIPLIER)
+
+// Steps after which every chain sits at its fixed point
+#define CHAIN_SETTLE_STEPS 64
+
+// Since the chains settle, their checksum cannot tell how many steps ran.
+// Each chain kernel also keeps a counter lane (c = c + 1 per step, off the
+// dependent chain and not counted as FLOPs) and leaves its sum over lanes
+// and threads in `kernel_chain_steps`, for verify_chain_steps.
+
+static inline double chain_start(double a, double b) {
+    return -(a * b) - 0.5;
+}
+
+// Peak kernels, one FMA per step and accumulator:
+//     x = x * PEAK_MULTIPLIER + PEAK_ADDEND
+// from x = peak_start(accumulator, thread), converging linearly (over about
+// a million steps) to PEAK_ADDEND / (1 - PEAK_MULTIPLIER)
+#define PEAK_MULTIPLIER 0.999999
+#define PEAK_ADDEND 1.000001
+
+static inline double peak_start(int accumulator, int thread_id) {
+    return 1.0 + accumulator * 0.1 + thread_id * 0.01;
+}
+
+// Op-mix kernels (OPMIX_OPS in simd_kernels.h), per op:
+//     fma: x = x*a + b    add: x = x + a + b    mul: x = x * a * b
+//     div: x = a / x      sqrt: x = sqrt(x * a) exp: x = exp(-x)
+// Every chain settles on normal numbers: fma at 1, add and mul at about
+// their start, div in a 2-cycle between its start and 1.000001 / start,
+// sqrt at 1.2345 and exp at 0.567.
+#define OPMIX_A_fma 0.999999
+#define OPMIX_B_fma 0.000001
+#define OPMIX_A_add 0.125
+#define OPMIX_B_add -0.125
+#define OPMIX_A_mul 1.2345
+#define OPMIX_B_mul (1.0 / 1.2345)
+#define OPMIX_A_div 1.000001
+#define OPMIX_B_div 0.0
+#define OPMIX_A_sqrt 1.2345
+#define OPMIX_B_sqrt 0.0
+#define OPMIX_A_exp 0.0
+#define OPMIX_B_exp 0.0
+
+// Starting values lie in [1, 1.875), where adding and subtracting 0.125 is
+// exact
+static inline double opmix_start(int chain) {
+    return 1.1 + chain * 0.01;
+}
+
+// Instruction-table kernels (INSTR_OPS), the same steps as the op mix with
+// one instruction each: the unused constant of mul, add and sqrt is the
+// identity
+#define INSTR_A_fma 0.999999
+#define INSTR_B_fma 0.000001
+#define INSTR_A_mul 1.0
+#define INSTR_B_mul 1.0
+#define INSTR_A_add 0.0
+#define INSTR_B_add 0.0
+#define INSTR_A_div 1.000001
+#define INSTR_B_div 0.0
+#define INSTR_A_sqrt 1.0
+#define INSTR_B_sqrt 0.0
+
+static inline double instr_start(int chain) {
+    return 1.0 + chain * 0.01;
+}
+
+// Op-mix and instruction chains are replayed in scalar code of the kernel's
+// element type, with the same rounding, until they repeat; fma chains still
+// moving after this many steps (f64 takes about 2e7) are extrapolated in
+// closed form
+#define VERIFY_REPLAY_STEPS (1LL << 22)
+
+// The sum of the final accumulators of the last kernel call on this thread
+extern __thread double kernel_checksum;
+
+// Chain steps counted by the last latency chain kernel on this thread
+extern __thread double kernel_chain_steps;
+
+// FLOPs of a kernel call from the iterations it actually runs: the kernels
+// divide the operation count by `operations_per_iteration` and drop the rest
+typedef struct {
+    long long operations_per_iteration;
+    double flops_per_iteration;
+} kernel_flops_t;
+
+static inline double kernel_flops(kernel_flops_t kernel, long long operations) {
+    return (double)(operations / kernel.operations_per_iteration) * kernel.flops_per_iteration;
+}
+
+// One scalar chain step per operation
+#define SCALAR_CHAIN_FLOPS ((kernel_flops_t){ 1, CHAIN_FLOPS_PER_STEP })
+
+// Expected checksum of `lanes` latency chains per thread after `steps`
+// chain steps split over `num_threads` threads (thread_share), or NAN when
+// some thread runs too few steps to settle
+double verify_chain_reference(long long steps, int lanes, int num_threads);
+
+// Expected checksum of the peak kernels: `iterations` split over
+// `num_threads` threads, each running `accumulators` chains of `lanes` lanes
+double verify_peak_reference(long long iterations, int accumulators, int lanes, int num_threads);
+
+// Expected checksum of an op-mix kernel (`type` f64 or f32, `op` from
+// OPMIX_OPS; `fused` 0 where fma is a separate multiply and add) after
+// `steps` steps of `chains` chains of `lanes` lanes, on one thread
+double verify_opmix_reference(const char *type, const char *op, int fused, long long steps, int chains,
+                              int lanes);
+
+// The same for an instruction-table kernel (`op` from INSTR_OPS)
+double verify_instr_reference(const char *type, const char *op, long long steps, int chains, int lanes);
+
+// Compare a checksum with its reference: 1 if it matches, 0 if not (counted
+// by verify_failures), -1 if there is no reference (NAN)
+int verify_checksum(double checksum, double expected);
+
+// "<indent>Checksum: ..." line for a verify_checksum result
+void verify_print(const char *indent, double checksum, double expected, int verified);
+
+// Compare the steps a chain kernel counted with the `flops` charged for it
+// (kernel_flops): 1 if they match, 0 if not (printed under `indent` and
+// counted by verify_failures)
+int verify_chain_steps(const char *indent, double steps, double flops);
+
+// Mismatches seen so far; benchmarks exit non-zero when this is not 0
+int verify_failures(void);
+
+#endif